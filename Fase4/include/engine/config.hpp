@@ -3,9 +3,11 @@
 #include "engine/render/camera.hpp"
 #include "engine/render/layout/world/camera.hpp"
 #include "engine/render/layout/world/world.hpp"
+#include "engine/render/vertex_format.hpp"
 
 #include <GL/freeglut.h>
 #include <array>
+#include <brief_int.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 #include <string_view>
@@ -48,6 +50,10 @@ extern constinit float const LINE_WIDTH_STEP;
 
 extern constinit GLenum const DEFAULT_POLYGON_MODE;
 
+extern constinit bool const ENABLE_CORE_PROFILE;
+
+extern constinit brief_int::usize const ORBIT_NUM_POINTS;
+
 enum KeyboardKeybinds : unsigned char {
     KEY_MOVE_FORWARD  = 'w',
     KEY_MOVE_LEFT     = 'a',
@@ -69,10 +75,47 @@ enum KeyboardKeybinds : unsigned char {
     KEY_THICKER_LINES = '+',
     KEY_FOCUS_NEXT_MODEL = '\t',
     KEY_EXIT_FOCUS_MODE = 27, // ESC key.
+    KEY_TOGGLE_OCCLUSION_CULLING = 'o',
 };
 
 extern constinit unsigned int const RENDER_TICK_MILLIS;
 
+extern constinit bool const ENABLE_OCCLUSION_CULLING;
+extern constinit brief_int::u32 const OCCLUSION_BUFFER_WIDTH;
+extern constinit brief_int::u32 const OCCLUSION_BUFFER_HEIGHT;
+extern constinit brief_int::usize const OCCLUSION_MAX_OCCLUDERS;
+extern constinit brief_int::usize const OCCLUSION_MAX_OCCLUDER_TRIANGLES;
+
+extern constinit brief_int::usize const GPU_MEMORY_BUDGET; // in bytes.
+extern constinit brief_int::usize const STREAM_RING_REGION_SIZE; // in bytes.
+
+extern constinit brief_int::usize const TEXTURE_LOADER_THREADS;
+extern constinit brief_int::usize const TEXTURE_UPLOAD_BUDGET; // in bytes.
+extern constinit char const* const TEXTURE_CACHE_DIR;
+extern constinit bool const ENABLE_TEXTURE_COMPRESSION;
+extern constinit brief_int::usize const TEXTURE_MEMORY_BUDGET; // in bytes.
+extern constinit brief_int::u32 const TEXTURE_STREAMING_TAIL_SIZE; // texels.
+
+extern constinit brief_int::u32 const LIGHT_CLUSTERS_X;
+extern constinit brief_int::u32 const LIGHT_CLUSTERS_Y;
+extern constinit brief_int::u32 const LIGHT_CLUSTERS_Z;
+extern constinit float const DEFAULT_LIGHT_RANGE;
+extern constinit float const AMBIENT_LIGHT;
+
+extern constinit bool const ENABLE_STATIC_BATCHING;
+extern constinit brief_int::u32 const STATIC_BATCH_MIN_MODELS;
+extern constinit brief_int::usize const STATIC_BATCH_MAX_VERTICES;
+
+extern constinit PositionFormat const VERTEX_POSITION_FORMAT;
+extern constinit NormalFormat const VERTEX_NORMAL_FORMAT;
+extern constinit TexcoordFormat const VERTEX_TEXCOORD_FORMAT;
+extern constinit float const VERTEX_MAX_POSITION_ERROR;
+extern constinit float const VERTEX_MAX_NORMAL_ERROR;
+extern constinit float const VERTEX_MAX_TEXCOORD_ERROR;
+
+extern constinit float const NORMAL_WELD_TOLERANCE;
+extern constinit float const NORMAL_CREASE_ANGLE; // in degrees.
+
 // WARNING: not constinit, do not rely on initialization order!
 extern World const DEFAULT_WORLD;
 
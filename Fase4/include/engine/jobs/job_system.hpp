@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <brief_int.hpp>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine::jobs {
+
+using Job = std::function<void()>;
+
+// Jobs connected by dependencies, submitted together with JobSystem::run.
+class TaskGraph {
+  private:
+    friend class JobSystem;
+
+    struct Task {
+        Job job;
+        std::vector<brief_int::u32> successors;
+        brief_int::u32 num_dependencies;
+        std::atomic<brief_int::u32> remaining_dependencies;
+    };
+
+    std::deque<Task> tasks;
+
+  public:
+    using TaskId = brief_int::u32;
+
+    auto add(Job job) -> TaskId;
+
+    // `after` only starts once `before` has finished.
+    auto precede(TaskId before, TaskId after) -> void;
+};
+
+// Pool of worker threads, each owning a queue of jobs that idle workers steal
+// from. Threads waiting on jobs run pending jobs instead of blocking.
+class JobSystem {
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::pair<Job, std::atomic<brief_int::usize>*>> jobs;
+    };
+
+    // Queue 0 is shared by every thread that isn't a worker.
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::jthread> workers;
+
+    std::atomic<brief_int::usize> num_queued = 0;
+    std::mutex sleep_mutex;
+    std::condition_variable_any wake_up;
+
+    auto friend get() -> JobSystem&;
+
+    explicit JobSystem(brief_int::usize num_threads);
+
+    auto push(Job job, std::atomic<brief_int::usize>* counter) -> void;
+
+    auto try_run_one() noexcept -> bool;
+
+    auto worker_loop(std::stop_token stop, brief_int::usize queue) noexcept
+        -> void;
+
+    // Runs pending jobs until `counter` drops to zero.
+    auto wait(std::atomic<brief_int::usize> const& counter) noexcept -> void;
+
+  public:
+    ~JobSystem();
+
+    // Number of threads that run jobs, counting the one calling into this.
+    [[nodiscard]]
+    auto num_threads() const noexcept -> brief_int::usize;
+
+    // Runs every task of the graph, respecting dependencies.
+    auto run(TaskGraph& graph) -> void;
+
+    // Calls `func(chunk_begin, chunk_end)` over chunks of [begin, end) of at
+    // least `grain` elements, in parallel.
+    template <std::invocable<brief_int::usize, brief_int::usize> F>
+    auto parallel_for(
+        brief_int::usize begin,
+        brief_int::usize end,
+        brief_int::usize grain,
+        F&& func
+    ) -> void;
+};
+
+// WARNING: must be called before the first call to get() to have any effect.
+// Zero means the hardware concurrency.
+auto set_num_threads(brief_int::usize num_threads) noexcept -> void;
+
+auto get() -> JobSystem&;
+
+template <std::invocable<brief_int::usize, brief_int::usize> F>
+auto JobSystem::parallel_for(
+    brief_int::usize const begin,
+    brief_int::usize const end,
+    brief_int::usize const grain,
+    F&& func
+) -> void {
+    using brief_int::usize;
+
+    if (begin >= end) {
+        return;
+    }
+
+    // A few chunks per thread so that stealing can even out the load.
+    auto const len = end - begin;
+    auto const chunk = std::max({
+        grain,
+        usize{1},
+        len / (this->num_threads() * 4),
+    });
+    if (chunk >= len) {
+        func(begin, end);
+        return;
+    }
+
+    auto pending = std::atomic<usize>{0};
+    for (auto chunk_begin = begin + chunk; chunk_begin < end; chunk_begin += chunk) {
+        auto const chunk_end = std::min(chunk_begin + chunk, end);
+        pending.fetch_add(1, std::memory_order_relaxed);
+        this->push([&func, chunk_begin, chunk_end] {
+            func(chunk_begin, chunk_end);
+        }, &pending);
+    }
+
+    // The calling thread takes the first chunk itself.
+    func(begin, std::min(begin + chunk, end));
+    this->wait(pending);
+}
+
+} // namespace engine::jobs
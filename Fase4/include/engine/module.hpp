@@ -1,5 +1,6 @@
 #pragma once
 
 #include "engine/config.hpp"
+#include "engine/jobs/job_system.hpp"
 #include "engine/parse/module.hpp"
 #include "engine/render/module.hpp"
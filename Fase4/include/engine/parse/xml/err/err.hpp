@@ -30,6 +30,14 @@ enum class ParseErr {
     AMBIGUOUS_MODEL_EXT,
     NO_MODEL_FILE,
     OBJ_LOADER_ERR,
+
+    NO_TEXTURE_FILENAME,
+
+    UNKNOWN_INSTANCES_DISTRIBUTION,
+    NO_INSTANCES_FILE,
+    MALFORMED_INSTANCES_FILE,
+
+    UNKNOWN_LIGHT_TYPE,
 };
 
 } // namespace engine::parse::xml
@@ -68,6 +68,22 @@ struct fmt::formatter<engine::parse::xml::ParseErr> {
                     return "model points to nonexistent file";
                 case OBJ_LOADER_ERR:
                     return "object loader failed";
+
+                case NO_TEXTURE_FILENAME:
+                    return "no texture filename attribute";
+
+                case UNKNOWN_INSTANCES_DISTRIBUTION:
+                    return "instances distribution must be either ring, "
+                        "sphere or box";
+                case NO_INSTANCES_FILE:
+                    return "instances point to nonexistent file";
+                case MALFORMED_INSTANCES_FILE:
+                    return "instances file size is not a multiple of a 4x4 "
+                        "float matrix";
+
+                case UNKNOWN_LIGHT_TYPE:
+                    return "light type must be either point, spotlight or "
+                        "directional";
                 default:
                     intrinsics::unreachable();
             }
@@ -1,14 +1,15 @@
 #pragma once
 
 #include "engine/parse/xml/err/err.hpp"
-#include "engine/render/layout/world/group/group.hpp"
+#include "engine/render/layout/world/world.hpp"
 
 #include <rapidxml.hpp>
 #include <result.hpp>
 
 namespace engine::parse::xml {
 
+// Parses the group rooted at `node` along with all of its descendants.
 auto parse_group(rapidxml::xml_node<> const* node) noexcept
-    -> cpp::result<render::Group, ParseErr>;
+    -> cpp::result<render::World, ParseErr>;
 
 } // namespace engine::parse::xml
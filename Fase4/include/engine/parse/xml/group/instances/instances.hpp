@@ -0,0 +1,31 @@
+#pragma once
+
+#include "engine/parse/xml/err/err.hpp"
+#include "engine/parse/xml/group/model/model.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <rapidxml.hpp>
+#include <result.hpp>
+#include <vector>
+
+namespace engine::parse::xml {
+
+// Many copies of a mesh, each placed within their group by its own matrix.
+struct Instances {
+    brief_int::u32 mesh;
+    brief_int::u32 texture; // NO_TEXTURE when untextured.
+    std::vector<glm::mat4> matrices;
+};
+
+// Either generated:
+//   <instances model="rock.3d" count="1000" distribution="ring|sphere|box"
+//       seed="0" radius="1" inner="0" height="0"
+//       min_scale="1" max_scale="1"/>
+// Or read from a file of raw 4x4 column-major float matrices:
+//   <instances model="rock.3d" file="belt.bin"/>
+// Either can take a texture="rock.jpg" attribute.
+auto parse_instances(rapidxml::xml_node<> const* node, AssetCache& cache)
+    noexcept -> cpp::result<Instances, ParseErr>;
+
+} // namespace engine::parse::xml
@@ -2,13 +2,37 @@
 
 #include "engine/parse/xml/err/err.hpp"
 #include "engine/render/layout/world/group/model.hpp"
+#include "engine/render/layout/world/mesh.hpp"
 
+#include <brief_int.hpp>
 #include <rapidxml.hpp>
 #include <result.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace engine::parse::xml {
 
-auto parse_model(rapidxml::xml_node<> const* node) noexcept
+// Meshes loaded and textures referenced so far, so that each file is
+// loaded only once.
+struct AssetCache {
+    std::vector<render::Mesh> meshes;
+    std::unordered_map<std::string, brief_int::u32> by_filename;
+    std::vector<std::string> textures;
+    std::unordered_map<std::string, brief_int::u32> texture_by_filename;
+};
+
+// Index of the mesh in `filename`, loading it if needed.
+auto load_mesh(std::string_view filename, AssetCache& cache) noexcept
+    -> cpp::result<brief_int::u32, ParseErr>;
+
+// Index of the texture in `filename`.
+// Images are only read once the world is handed to the renderer.
+auto add_texture(std::string_view filename, AssetCache& cache) noexcept
+    -> cpp::result<brief_int::u32, ParseErr>;
+
+auto parse_model(rapidxml::xml_node<> const* node, AssetCache& cache) noexcept
     -> cpp::result<render::Model, ParseErr>;
 
 } // namespace engine::parse::xml
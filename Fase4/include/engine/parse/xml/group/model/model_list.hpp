@@ -10,7 +10,7 @@
 
 namespace engine::parse::xml {
 
-auto parse_model_list(rapidxml::xml_node<> const* node) noexcept
-    -> cpp::result<std::vector<render::Model>, ParseErr>;
+auto parse_model_list(rapidxml::xml_node<> const* node, AssetCache& cache)
+    noexcept -> cpp::result<std::vector<render::Model>, ParseErr>;
 
 } // namespace engine::parse::xml
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "engine/parse/xml/err/err.hpp"
+#include "engine/render/layout/world/light.hpp"
+
+#include <rapidxml.hpp>
+#include <result.hpp>
+#include <vector>
+
+namespace engine::parse::xml {
+
+// <lights>
+//     <light type="point" posx="0" posy="10" posz="0"/>
+//     <light type="spotlight" posx="0" posy="10" posz="0"
+//         dirx="0" diry="-1" dirz="0" cutoff="45"/>
+//     <light type="directional" dirx="1" diry="1" dirz="1"/>
+// </lights>
+// Any of them can take a color, r="1" g="1" b="1" by default, and point and
+// spot lights a range="..." past which they have no effect.
+auto parse_lights(rapidxml::xml_node<> const* node) noexcept
+    -> cpp::result<std::vector<render::Light>, ParseErr>;
+
+} // namespace engine::parse::xml
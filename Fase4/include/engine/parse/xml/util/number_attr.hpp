@@ -36,4 +36,21 @@ auto constexpr parse_number_attr(
     }
 }
 
+// Same as above, but an absent attribute is `default_value` instead.
+template <::util::number N>
+auto constexpr parse_number_attr_or(
+    rapidxml::xml_node<> const* const node,
+    std::string_view const attr_name,
+    N const default_value
+) noexcept
+    -> cpp::result<N, ParseErr>
+{
+    if (node->first_attribute(attr_name.data(), attr_name.length())
+        == nullptr
+    ) {
+        return default_value;
+    }
+    return parse_number_attr<N>(node, attr_name);
+}
+
 } // engine::parse::xml
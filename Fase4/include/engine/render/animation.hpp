@@ -0,0 +1,69 @@
+#pragma once
+
+#include "engine/render/catmull_rom.hpp"
+#include "engine/render/layout/world/group/transform/rotate.hpp"
+#include "engine/render/layout/world/group/transform/translate.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+// Every time based transform of a scene, kept in structure-of-arrays form so
+// that all of them are evaluated in one batch per frame, before drawing.
+struct Animations {
+    // Time based rotations.
+    std::vector<float> rotation_freqs; // turns per millisecond.
+    std::vector<float> rotation_axis_x; // normalized.
+    std::vector<float> rotation_axis_y;
+    std::vector<float> rotation_axis_z;
+    std::vector<glm::mat4> rotation_matrices;
+
+    // Curve translates.
+    std::vector<CatmullRomSegment> curve_segments;
+    std::vector<brief_int::u32> curve_segments_begin;
+    std::vector<brief_int::u32> curve_num_segments;
+    std::vector<float> curve_freqs; // loops per millisecond.
+    std::vector<brief_int::u8> curve_align;
+    std::vector<float> curve_up_x; // orientation frame of aligned curves.
+    std::vector<float> curve_up_y;
+    std::vector<float> curve_up_z;
+    std::vector<glm::mat4> curve_matrices;
+
+    // Per-frame scratch space, sized like the arrays above.
+    std::vector<float> rotation_sin;
+    std::vector<float> rotation_cos;
+    std::vector<brief_int::u32> curve_segment;
+    std::vector<float> curve_t;
+};
+
+// Both return the index of the new animation's matrix.
+auto add_rotation(Animations& animations, Rotate const& rotate)
+    -> brief_int::u32;
+
+auto add_curve(Animations& animations, DynamicTranslate const& translate)
+    -> brief_int::u32;
+
+[[nodiscard]]
+auto curve_segments(Animations const& animations, brief_int::u32 curve)
+    noexcept -> std::span<CatmullRomSegment const>;
+
+// Evaluate the animations in [begin, end) of their kind at `time_ms`.
+// Disjoint ranges may be evaluated concurrently.
+auto animate_rotations(
+    Animations& animations,
+    float time_ms,
+    brief_int::usize begin,
+    brief_int::usize end
+) noexcept -> void;
+
+auto animate_curves(
+    Animations& animations,
+    float time_ms,
+    brief_int::usize begin,
+    brief_int::usize end
+) noexcept -> void;
+
+} // namespace engine::render
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "engine/render/catmull_rom.hpp"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+
+namespace engine::render {
+
+struct Sphere {
+    glm::vec3 center;
+    float radius; // negative when empty.
+};
+
+inline constexpr auto EMPTY_SPHERE = Sphere {
+    .center = {0.f, 0.f, 0.f},
+    .radius = -1.f,
+};
+
+[[nodiscard]]
+auto bounding_sphere(std::span<glm::vec3 const> points) noexcept -> Sphere;
+
+// Bounds every point of a closed curve.
+[[nodiscard]]
+auto bounding_sphere(std::span<CatmullRomSegment const> curve) noexcept
+    -> Sphere;
+
+[[nodiscard]]
+auto merge(Sphere const& lhs, Sphere const& rhs) noexcept -> Sphere;
+
+// Conservative under non-uniform scales.
+[[nodiscard]]
+auto transform(Sphere const& sphere, glm::mat4 const& matrix) noexcept
+    -> Sphere;
+
+} // namespace engine::render
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "engine/render/bounds.hpp"
+
+#include <brief_int.hpp>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+struct BvhNode {
+    glm::vec3 min;
+    brief_int::u32 first; // first item of a leaf, left child otherwise.
+    glm::vec3 max;
+    brief_int::u32 count; // items of a leaf, 0 otherwise.
+};
+
+// Bounding volume hierarchy over a set of spheres, referred to by index.
+// Every query takes the same spheres the hierarchy was built or refitted
+// with.
+struct Bvh {
+    std::vector<BvhNode> nodes; // root first, right child after the left.
+    std::vector<brief_int::u32> items; // sphere indices, grouped by leaf.
+    float built_area; // sum of the nodes' areas right after building.
+};
+
+auto build_bvh(Bvh& bvh, std::span<Sphere const> spheres) noexcept -> void;
+
+// Updates the nodes' bounds for moved spheres without changing the
+// hierarchy. Rebuilds it instead once the nodes have grown too loose, or if
+// the number of spheres changed.
+auto refit_bvh(Bvh& bvh, std::span<Sphere const> spheres) noexcept -> void;
+
+struct RayHit {
+    brief_int::u32 item;
+    float distance; // along the ray, in units of its direction.
+};
+
+// Closest sphere hit by the ray.
+[[nodiscard]]
+auto raycast(
+    Bvh const& bvh,
+    std::span<Sphere const> spheres,
+    glm::vec3 const& origin,
+    glm::vec3 const& direction
+) noexcept -> std::optional<RayHit>;
+
+// The `k` spheres closest to `point`, closest first.
+auto k_nearest(
+    Bvh const& bvh,
+    std::span<Sphere const> spheres,
+    glm::vec3 const& point,
+    brief_int::usize k,
+    std::vector<brief_int::u32>& nearest
+) noexcept -> void;
+
+} // namespace engine::render
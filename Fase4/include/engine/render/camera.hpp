@@ -1,5 +1,7 @@
 #pragma once
 
+#include <glm/vec3.hpp>
+
 namespace engine::render {
 
 enum class CameraMode {
@@ -7,6 +9,18 @@ enum class CameraMode {
     FOLLOW_MODE,
 };
 
+// Advances the camera by one tick.
 auto update_camera() noexcept -> void;
 
+// Follows the first model hit by the ray, if any.
+auto focus_model_at(glm::vec3 const& origin, glm::vec3 const& direction)
+    noexcept -> void;
+
+// Follows the model at the center of the screen, or the one nearest to where
+// the camera is looking. Already following one, moves on to the next model.
+auto focus_next_model() noexcept -> void;
+
+// Keeps the followed model, as of the last scene update, in focus.
+auto track_focused_model() noexcept -> void;
+
 } // namespace engine::render
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <brief_int.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+// Coefficients {a, b, c, d} of a curve segment's a*t^3 + b*t^2 + c*t + d.
+using CatmullRomSegment = std::array<glm::vec3, 4>;
+
+struct CurvePoint {
+    glm::vec3 pos;
+    glm::vec3 deriv;
+};
+
+// Appends the segments of the closed curve through `points` to `segments`.
+// WARNING: requires at least 4 control points.
+auto compile_catmull_rom(
+    std::span<glm::vec3 const> points,
+    std::vector<CatmullRomSegment>& segments
+) -> void;
+
+// Point at local parameter `t`, in [0, 1], of a single segment.
+[[nodiscard]]
+auto eval_catmull_rom_segment(CatmullRomSegment const& segment, float t)
+    noexcept -> CurvePoint;
+
+// Point at global parameter `gt`, where each unit of `gt` is a full loop.
+[[nodiscard]]
+auto eval_catmull_rom(std::span<CatmullRomSegment const> curve, float gt)
+    noexcept -> CurvePoint;
+
+// `num_points` evenly spaced points along the curve, for drawing it.
+[[nodiscard]]
+auto catmull_rom_polyline(
+    std::span<CatmullRomSegment const> curve,
+    brief_int::usize num_points
+) -> std::vector<glm::vec3>;
+
+} // namespace engine::render
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "engine/render/bounds.hpp"
+#include "engine/render/layout/world/world.hpp"
+#include "engine/render/scene.hpp"
+
+#include <array>
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace engine::render {
+
+struct Frustum {
+    // Normalized {normal, distance}, with the normal pointing inwards.
+    std::array<glm::vec4, 6> planes;
+};
+
+[[nodiscard]]
+auto make_frustum(glm::mat4 const& view_proj) noexcept -> Frustum;
+
+enum class Visibility {
+    OUTSIDE,
+    PARTIAL,
+    INSIDE,
+};
+
+[[nodiscard]]
+auto classify(Frustum const& frustum, Sphere const& sphere) noexcept
+    -> Visibility;
+
+struct CullStats {
+    brief_int::u32 groups_visible;
+    brief_int::u32 groups_culled;
+    brief_int::u32 models_drawn;
+    brief_int::u32 models_culled;
+};
+
+// Collects the scene's draws that may be inside `frustum`.
+// Whole subtrees are skipped or accepted as soon as their bounds allow it,
+// only groups partially inside have their models tested one by one.
+auto cull_scene(
+    Scene const& scene,
+    World const& world,
+    Frustum const& frustum,
+    std::vector<Draw>& draws,
+    CullStats& stats
+) noexcept -> void;
+
+} // namespace engine::render
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "engine/render/culling.hpp"
+#include "engine/render/instancing.hpp"
+#include "engine/render/layout/world/camera.hpp"
+#include "engine/render/light_clusters.hpp"
+#include "engine/render/occlusion.hpp"
+#include "engine/render/render_queue.hpp"
+#include "engine/render/scene.hpp"
+
+#include <GL/freeglut.h>
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+namespace engine::render {
+
+// Everything the render thread needs to draw a frame, produced by the
+// simulation thread and never modified once published.
+struct Frame {
+    Camera camera;
+
+    bool enable_axis;
+    bool enable_lookat_indicator;
+    GLenum polygon_mode;
+    float line_width;
+
+    std::vector<glm::mat4> orbit_matrices; // indexed like Scene's.
+    // Only the ones that survived culling, sorted by state then front to
+    // back.
+    std::vector<Draw> draws;
+    // The same draws, grouped by state.
+    std::vector<glm::mat4> instance_matrices;
+    std::vector<brief_int::u32> instance_layers; // into the batch's array.
+    std::vector<InstanceBatch> batches;
+    std::vector<brief_int::u32> batch_texture_arrays; // indexed like batches.
+    // Of each texture array's biggest draw, for streaming its levels.
+    std::vector<float> texture_array_sizes;
+    LightClusters light_clusters; // core profile only.
+    CullStats cull_stats;
+    OcclusionStats occlusion_stats;
+    RenderQueueStats render_queue_stats;
+    LightClusterStats light_cluster_stats;
+};
+
+} // namespace engine::render
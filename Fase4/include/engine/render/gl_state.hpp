@@ -0,0 +1,56 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <brief_int.hpp>
+
+namespace engine::render {
+
+// Calls made through the state cache since the last reset.
+struct GlCallStats {
+    brief_int::u32 calls; // that reached GL.
+    brief_int::u32 skipped; // redundant, never made.
+    brief_int::u32 binds; // buffers, vertex arrays, programs and textures.
+    brief_int::u32 draws;
+};
+
+// Bindings and the fixed state the renderer changes are cached, and setting
+// them to what they already are does nothing.
+// Render thread only. Whatever the cache tracks must only be changed through
+// it, or it will skip calls it shouldn't.
+
+// Array, indirect and pixel unpack buffers are cached, other targets are
+// always bound.
+auto bind_buffer(GLenum target, GLuint buffer) noexcept -> void;
+auto bind_vertex_array(GLuint vertex_array) noexcept -> void;
+auto use_program(GLuint program) noexcept -> void;
+// 2D textures and 2D texture arrays are cached, other targets are always
+// bound.
+auto bind_texture(GLuint unit, GLenum target, GLuint texture) noexcept
+    -> void;
+auto set_polygon_mode(GLenum face, GLenum mode) noexcept -> void;
+auto set_line_width(float width) noexcept -> void;
+
+// To be called before deleting a buffer or texture, whose name may come back
+// for another object.
+auto forget_buffer(GLuint buffer) noexcept -> void;
+auto forget_texture(GLuint texture) noexcept -> void;
+
+auto draw_arrays(GLenum mode, GLint first, GLsizei count) noexcept -> void;
+auto draw_arrays_instanced(
+    GLenum mode,
+    GLint first,
+    GLsizei count,
+    GLsizei instance_count
+) noexcept -> void;
+auto multi_draw_arrays_indirect(
+    GLenum mode,
+    brief_int::usize offset,
+    GLsizei draw_count
+) noexcept -> void;
+
+[[nodiscard]]
+auto gl_call_stats() noexcept -> GlCallStats const&;
+auto reset_gl_call_stats() noexcept -> void;
+
+} // namespace engine::render
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <array>
+#include <brief_int.hpp>
+#include <functional>
+#include <limits>
+
+namespace engine::render {
+
+enum class GpuCategory : brief_int::u8 {
+    GEOMETRY,
+    ORBITS,
+    STREAMING, // rewritten every frame.
+    TEXTURES,
+};
+inline constexpr auto NUM_GPU_CATEGORIES = brief_int::usize{4};
+
+// Fills a freshly generated buffer or texture, on creation and again after
+// being evicted.
+using GpuUpload = std::function<void(GLuint)>;
+
+// In bytes.
+struct GpuMemoryStats {
+    std::array<brief_int::usize, NUM_GPU_CATEGORIES> current;
+    std::array<brief_int::usize, NUM_GPU_CATEGORIES> peak;
+};
+
+// Reference counted handle to a buffer or texture.
+// The GL object is deleted once its last handle is gone.
+// Render thread only, like every other GL call.
+class GpuHandle {
+  private:
+    auto friend create_gpu_resource(
+        GpuCategory category,
+        bool is_texture,
+        brief_int::usize size,
+        GpuUpload upload
+    ) noexcept -> GpuHandle;
+
+    brief_int::u32 static constexpr NO_SLOT
+        = std::numeric_limits<brief_int::u32>::max();
+    brief_int::u32 slot = NO_SLOT;
+
+    explicit GpuHandle(brief_int::u32 slot) noexcept;
+
+  public:
+    GpuHandle() noexcept = default;
+    GpuHandle(GpuHandle const& other) noexcept;
+    GpuHandle(GpuHandle&& other) noexcept;
+    auto operator=(GpuHandle const& other) noexcept -> GpuHandle&;
+    auto operator=(GpuHandle&& other) noexcept -> GpuHandle&;
+    ~GpuHandle();
+
+    // The GL name, uploaded again first if it was evicted.
+    // Marks the resource as used this frame.
+    [[nodiscard]]
+    auto get() const noexcept -> GLuint;
+
+    // For resources whose contents are replaced after creation.
+    auto set_size(brief_int::usize size) const noexcept -> void;
+
+    [[nodiscard]]
+    explicit operator bool() const noexcept;
+};
+
+// Resources with an upload function may be evicted when over budget.
+// Those without one are assumed to be refilled by their user, and are kept.
+[[nodiscard]]
+auto create_gpu_resource(
+    GpuCategory category,
+    bool is_texture,
+    brief_int::usize size,
+    GpuUpload upload
+) noexcept -> GpuHandle;
+
+[[nodiscard]]
+auto create_gpu_buffer(
+    GpuCategory category,
+    brief_int::usize size,
+    GpuUpload upload = {}
+) noexcept -> GpuHandle;
+
+[[nodiscard]]
+auto create_gpu_texture(
+    GpuCategory category,
+    brief_int::usize size,
+    GpuUpload upload = {}
+) noexcept -> GpuHandle;
+
+// Starts a new frame, evicting the least recently used resources while over
+// `config::GPU_MEMORY_BUDGET`.
+auto begin_gpu_frame() noexcept -> void;
+
+[[nodiscard]]
+auto gpu_memory_stats() noexcept -> GpuMemoryStats const&;
+
+auto log_gpu_memory_stats() noexcept -> void;
+
+// Forgets every GL object without deleting it, for once the context is gone.
+auto abandon_gpu_resources() noexcept -> void;
+
+} // namespace engine::render
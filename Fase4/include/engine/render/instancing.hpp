@@ -0,0 +1,41 @@
+#pragma once
+
+#include "engine/render/layout/world/world.hpp"
+#include "engine/render/scene.hpp"
+#include "engine/render/texture_loader.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+// Instances sharing a mesh, drawn with a single call.
+// Laid out like OpenGL's DrawArraysIndirectCommand, so a frame's batches can
+// be uploaded as is and submitted with one multi-draw.
+struct InstanceBatch {
+    brief_int::u32 count; // vertices, from `first`.
+    brief_int::u32 instance_count;
+    brief_int::u32 first; // first vertex in the mesh arena.
+    brief_int::u32 base_instance; // index into the instance matrices.
+};
+
+// Groups `draws`, sorted by `sort_draws`, into consecutive per-instance
+// matrices and texture layers, and one batch per run of draws sharing the
+// same state, mesh and texture array.
+// Matrices include the mesh's dequantization.
+// `batch_texture_arrays` gets each batch's texture array, or NO_TEXTURE.
+auto batch_instances(
+    World const& world,
+    Scene const& scene,
+    std::span<TextureSlot const> texture_slots,
+    std::span<Draw const> draws,
+    std::span<brief_int::u64 const> keys,
+    std::vector<glm::mat4>& instance_matrices,
+    std::vector<brief_int::u32>& instance_layers,
+    std::vector<InstanceBatch>& batches,
+    std::vector<brief_int::u32>& batch_texture_arrays
+) noexcept -> void;
+
+} // namespace engine::render
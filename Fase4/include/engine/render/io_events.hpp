@@ -1,9 +1,28 @@
 #pragma once
 
+#include <glm/vec2.hpp>
+
 namespace engine::render {
 
+struct KeyEvent {
+    unsigned char key;
+    bool pressed;
+};
+
+struct ClickEvent {
+    glm::vec2 ndc; // normalized device coordinates.
+};
+
+// GLUT callbacks, only queue the event for the simulation thread.
+
 auto key_down(unsigned char key, int x, int y) noexcept -> void;
 
 auto key_up(unsigned char key, int x, int y) noexcept -> void;
 
+auto mouse_button(int button, int button_state, int x, int y) noexcept
+    -> void;
+
+// Applies a queued event, on the simulation thread.
+auto handle_key_event(KeyEvent event) noexcept -> void;
+
 } // namespace engine::render
@@ -1,12 +1,19 @@
 #pragma once
 
-#include <glm/vec3.hpp>
-#include <vector>
+#include <brief_int.hpp>
+#include <limits>
 
 namespace engine::render {
 
+auto constexpr NO_MATRIX = std::numeric_limits<brief_int::u32>::max();
+auto constexpr NO_TEXTURE = std::numeric_limits<brief_int::u32>::max();
+
 struct Model {
-    std::vector<glm::vec3> vertices;
+    brief_int::u32 mesh; // index into World::meshes.
+    // Index into World::model_matrices, placing the model within its group,
+    // or NO_MATRIX when it's drawn right in its group's space.
+    brief_int::u32 matrix;
+    brief_int::u32 texture; // index into World::textures, or NO_TEXTURE.
 };
 
 } // namespace engine::render
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <brief_int.hpp>
+#include <glm/vec3.hpp>
+
+namespace engine::render {
+
+enum class LightType : brief_int::u8 {
+    POINT,
+    SPOT,
+    DIRECTIONAL,
+};
+
+// In world space.
+struct Light {
+    LightType type;
+    glm::vec3 position; // unused by directional lights.
+    // Where spot lights point, and where directional ones come from.
+    glm::vec3 direction; // normalized, unused by point lights.
+    glm::vec3 color;
+    float range; // no effect past this distance, unused by directional lights.
+    float cutoff; // spot lights' half angle, in degrees.
+};
+
+} // namespace engine::render
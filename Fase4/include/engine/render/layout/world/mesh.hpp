@@ -0,0 +1,24 @@
+#pragma once
+
+#include "engine/render/bounds.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace engine::render {
+
+// Geometry loaded from a model file, shared by every model using that file.
+struct Mesh {
+    std::vector<glm::vec3> vertices;
+    // Either empty or one per vertex.
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texcoords;
+    // MikkTSpace style, w is the sign of the bitangent, cross(normal,
+    // tangent) * w. Only for meshes with both normals and texcoords.
+    std::vector<glm::vec4> tangents;
+    Sphere bounds; // in model space.
+};
+
+} // namespace engine::render
@@ -1,11 +1,42 @@
 #pragma once
 
-#include "engine/render/layout/world/group/group.hpp"
+#include "engine/render/layout/world/group/model.hpp"
+#include "engine/render/layout/world/group/transform/transform.hpp"
+#include "engine/render/layout/world/light.hpp"
+#include "engine/render/layout/world/mesh.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <limits>
+#include <string>
+#include <vector>
 
 namespace engine::render {
 
+// Half-open [begin, end) range of indices into one of the World's arrays.
+struct Range {
+    brief_int::u32 begin;
+    brief_int::u32 end;
+};
+
+auto constexpr NO_PARENT = std::numeric_limits<brief_int::u32>::max();
+auto constexpr NO_MODEL = std::numeric_limits<brief_int::u32>::max();
+
+// The scene graph, flattened into contiguous arrays.
+// Groups are stored in depth-first order: every group comes after its parent,
+// and the descendants of a group occupy a contiguous range right after it.
+// All `group_*` arrays are indexed by group.
 struct World {
-    Group root;
+    std::vector<brief_int::u32> group_parents; // NO_PARENT for the root.
+    std::vector<Range> group_transforms;       // range into `transforms`.
+    std::vector<Range> group_models;           // range into `models`.
+
+    std::vector<Transform> transforms;
+    std::vector<Model> models;
+    std::vector<glm::mat4> model_matrices;
+    std::vector<Mesh> meshes;
+    std::vector<std::string> textures; // image files, each listed once.
+    std::vector<Light> lights;
 };
 
 } // namespace engine::render
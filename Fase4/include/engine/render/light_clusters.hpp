@@ -0,0 +1,77 @@
+#pragma once
+
+#include "engine/render/layout/world/light.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+// A light as the shaders read it, 3 RGBA32F texels of a buffer texture.
+struct GpuLight {
+    glm::vec4 position; // w: range, unused by directional lights.
+    glm::vec4 color; // w: the LightType.
+    glm::vec4 direction; // w: cosine of the cutoff, spot lights only.
+};
+
+struct LightClusterStats {
+    brief_int::u32 lights; // reaching the view at all.
+    brief_int::u32 max_per_cluster;
+    brief_int::u32 indices;
+};
+
+// A frame's lights, binned into a grid of view space clusters, evenly split
+// across the screen and exponentially in depth.
+// Clusters are numbered x first, then y, then z, from the bottom left of the
+// screen and the near plane.
+struct LightClusters {
+    std::vector<GpuLight> lights; // every light of the world.
+    // {offset into `indices`, count}, per cluster.
+    std::vector<glm::uvec2> ranges;
+    std::vector<brief_int::u32> indices; // into `lights`.
+    // A view space depth's slice is log(depth) * slice_scale + slice_bias.
+    float slice_scale;
+    float slice_bias;
+};
+
+// Cluster bounds, only recomputed when the projection changes, and
+// per-frame scratch space.
+struct LightClusterGrid {
+    glm::vec4 projection; // {fov_y, aspect, near, far} the bounds are for.
+    // View space bounds, per cluster, and per row of clusters of each
+    // slice.
+    std::vector<glm::vec3> cluster_min;
+    std::vector<glm::vec3> cluster_max;
+    std::vector<glm::vec3> row_min;
+    std::vector<glm::vec3> row_max;
+
+    std::vector<glm::vec4> view_lights; // view space {center, radius}.
+    std::vector<brief_int::u32> visible_lights;
+    // Per slice, so that each one is binned on its own.
+    std::vector<std::vector<brief_int::u32>> slice_candidates;
+    std::vector<std::vector<brief_int::u32>> row_candidates;
+    std::vector<std::vector<brief_int::u32>> slice_indices;
+};
+
+// Bins `lights` into `config::LIGHT_CLUSTERS_X * Y * Z` clusters of the
+// view, in parallel over depth slices.
+// Point and spot lights are bound by a sphere of their range, directional
+// lights reach every cluster.
+auto build_light_clusters(
+    LightClusterGrid& grid,
+    std::span<Light const> lights,
+    glm::mat4 const& view,
+    float fov_y, // in radians.
+    float aspect,
+    float near,
+    float far,
+    LightClusters& clusters,
+    LightClusterStats& stats
+) noexcept -> void;
+
+} // namespace engine::render
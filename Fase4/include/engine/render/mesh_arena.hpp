@@ -0,0 +1,21 @@
+#pragma once
+
+#include "engine/render/layout/world/world.hpp"
+
+#include <brief_int.hpp>
+#include <vector>
+
+namespace engine::render {
+
+// Where a mesh's vertices are in the vertex arena, in vertices.
+struct ArenaRange {
+    brief_int::u32 first;
+    brief_int::u32 count;
+};
+
+// Packs every mesh back to back, in mesh order, so all of them can be drawn
+// out of a single buffer.
+[[nodiscard]]
+auto layout_mesh_arena(World const& world) -> std::vector<ArenaRange>;
+
+} // namespace engine::render
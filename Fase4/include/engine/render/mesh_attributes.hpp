@@ -0,0 +1,22 @@
+#pragma once
+
+#include "engine/render/layout/world/mesh.hpp"
+
+#include <span>
+#include <string>
+
+namespace engine::render {
+
+// Gives smooth normals to vertices without a usable one, keeping authored
+// normals, then tangents to meshes with texcoords, in parallel across meshes.
+// Normals are weighted by both the area of each face and its angle at the
+// vertex, and only smoothed across faces within the crease angle.
+// Results are cached in a file next to each mesh's own, `files[mesh]`, and
+// read back by later loads of the same geometry.
+// Best effort, meshes that can't be processed are left as they were.
+auto generate_mesh_attributes(
+    std::span<Mesh> meshes,
+    std::span<std::string const> files
+) noexcept -> void;
+
+} // namespace engine::render
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "engine/render/bounds.hpp"
+#include "engine/render/layout/world/world.hpp"
+#include "engine/render/scene.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+struct OcclusionStats {
+    brief_int::u32 occluders;
+    brief_int::u32 tested;
+    brief_int::u32 occluded;
+};
+
+// Low resolution software depth buffer, with a pyramid of the farthest
+// depth under each texel of the level below.
+struct OcclusionBuffer {
+    std::vector<std::vector<float>> levels; // level 0 is full resolution.
+    std::vector<brief_int::u32> level_widths;
+    std::vector<brief_int::u32> level_heights;
+
+    // Per-frame scratch space.
+    std::vector<brief_int::u32> occluders; // indices into the draws.
+    std::vector<brief_int::u32> occluder_vertices_begin;
+    std::vector<glm::vec3> vertices; // screen space {x, y, depth}.
+    std::vector<brief_int::u8> visible; // per draw.
+};
+
+// Rasterizes the draws that cover the most of the screen into `buffer`,
+// then removes the draws hidden behind them.
+auto cull_occluded(
+    OcclusionBuffer& buffer,
+    World const& world,
+    std::span<Sphere const> model_bounds,
+    glm::mat4 const& view,
+    glm::mat4 const& proj,
+    std::vector<Draw>& draws,
+    OcclusionStats& stats
+) noexcept -> void;
+
+} // namespace engine::render
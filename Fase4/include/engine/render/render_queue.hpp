@@ -0,0 +1,74 @@
+#pragma once
+
+#include "engine/render/layout/world/world.hpp"
+#include "engine/render/scene.hpp"
+#include "engine/render/texture_loader.hpp"
+
+#include <brief_int.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+enum class RenderPass : brief_int::u8 {
+    SOLID,
+};
+
+// What a draw needs bound, from the most to the least expensive to change.
+// Packed into a 64 bit key, in this order from the most significant bits:
+// pass 2, program 4, texture 12, material 10, mesh 16 and depth 20.
+struct RenderKeyFields {
+    RenderPass pass;
+    brief_int::u32 program;
+    brief_int::u32 texture;
+    brief_int::u32 material;
+    brief_int::u32 mesh;
+    float depth; // in [0, 1], nearest first.
+};
+
+// Draws as sort keys, each with the index of the draw it stands for.
+struct RenderQueue {
+    std::vector<brief_int::u64> keys;
+    std::vector<brief_int::u32> payloads;
+
+    // Scratch space for sorting.
+    std::vector<brief_int::u64> sorted_keys;
+    std::vector<brief_int::u32> sorted_payloads;
+    std::vector<Draw> sorted_draws;
+};
+
+struct RenderQueueStats {
+    brief_int::u32 state_changes;
+    // Compared to drawing in the order the scene lists models.
+    brief_int::u32 state_changes_avoided;
+};
+
+[[nodiscard]]
+auto make_render_key(RenderKeyFields const& fields) noexcept
+    -> brief_int::u64;
+
+// The part of a key two draws must share to be drawn with the same state,
+// everything but the depth.
+[[nodiscard]]
+auto render_state(brief_int::u64 key) noexcept -> brief_int::u64;
+
+// Sorts `queue.keys` in ascending order, moving `queue.payloads` along.
+// Stable, so draws with equal keys keep their order.
+auto sort_render_queue(RenderQueue& queue) noexcept -> void;
+
+// Sorts `draws` by state, then front to back, leaving their keys in
+// `queue.keys`.
+// Textures sharing an array share their state too.
+auto sort_draws(
+    RenderQueue& queue,
+    World const& world,
+    Scene const& scene,
+    std::span<TextureSlot const> texture_slots,
+    glm::vec3 const& eye,
+    float far,
+    std::vector<Draw>& draws,
+    RenderQueueStats& stats
+) noexcept -> void;
+
+} // namespace engine::render
@@ -7,6 +7,11 @@ namespace engine::render {
 
 class Renderer;
 
+// WARNING: must be called before the first call to get() to have any effect.
+// Draws with the fixed function pipeline instead of a core context,
+// config::ENABLE_CORE_PROFILE deciding if never called.
+auto set_legacy(bool legacy) noexcept -> void;
+
 auto get() -> Renderer&;
 
 class Renderer {
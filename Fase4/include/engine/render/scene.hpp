@@ -0,0 +1,82 @@
+#pragma once
+
+#include "engine/render/animation.hpp"
+#include "engine/render/bounds.hpp"
+#include "engine/render/bvh.hpp"
+#include "engine/render/layout/world/world.hpp"
+#include "engine/render/mesh_arena.hpp"
+
+#include <brief_int.hpp>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+namespace engine::render {
+
+// One step of a group's compiled transform chain.
+struct TransformOp {
+    enum class Kind {
+        Static,   // index into Scene::static_matrices.
+        Rotation, // index into Animations::rotation_matrices.
+        Curve,    // index into Animations::curve_matrices.
+    } kind;
+    brief_int::u32 index;
+};
+
+// A model to submit to the GPU, with its world matrix.
+struct Draw {
+    glm::mat4 matrix;
+    brief_int::u32 model; // index into World::models.
+};
+
+// The world's transforms compiled at load time.
+// Runs of consecutive static transforms are folded into a single matrix,
+// and world matrices of groups that never move are computed only once.
+struct Scene {
+    std::vector<Range> group_ops; // range into `ops`.
+    std::vector<brief_int::u32> subtree_ends; // one past the last descendant.
+    // Bounds of everything under a group, in the space its models are drawn
+    // in, over the whole range of every animation below it.
+    std::vector<Sphere> group_bounds;
+
+    // Groups whose world matrix depends on time, sorted by depth.
+    // Groups of the same depth don't depend on each other.
+    std::vector<brief_int::u32> dynamic_groups;
+    std::vector<Range> dynamic_levels; // range into `dynamic_groups`.
+
+    std::vector<TransformOp> ops;
+    std::vector<glm::mat4> static_matrices;
+    Animations animations;
+
+    std::vector<glm::mat4> world_matrices; // indexed by group.
+    std::vector<glm::mat4> orbit_matrices; // matrix each curve is drawn in.
+
+    std::vector<Draw> draws; // indexed like World::models.
+    std::vector<Sphere> model_bounds; // world space, indexed like draws.
+    Bvh bvh; // over `model_bounds`.
+
+    // Both indexed like World::meshes.
+    std::vector<ArenaRange> mesh_ranges;
+    // Maps the arena's positions, relative to the mesh's bounds, back to
+    // model space.
+    std::vector<glm::mat4> mesh_dequantization;
+};
+
+[[nodiscard]]
+auto is_time_based(Transform const& transform) noexcept -> bool;
+
+// Local matrix of a transform that isn't time based.
+[[nodiscard]]
+auto static_transform_matrix(Transform const& transform) noexcept
+    -> glm::mat4;
+
+// Throws std::bad_alloc.
+[[nodiscard]]
+auto compile_scene(World const& world) -> Scene;
+
+// Recomputes the world matrices of groups that depend on time, and the draws
+// and bounds of their models, spread over the job system.
+// Simulation thread only, the task graph is built once and reused.
+auto update_scene(Scene& scene, World const& world, float time_ms) noexcept
+    -> void;
+
+} // namespace engine::render
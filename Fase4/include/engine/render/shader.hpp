@@ -0,0 +1,14 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <optional>
+
+namespace engine::render {
+
+// Compiles and links a program out of GLSL sources, logging any errors.
+[[nodiscard]]
+auto compile_program(char const* vertex_src, char const* fragment_src)
+    noexcept -> std::optional<GLuint>;
+
+} // namespace engine::render
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace engine::render {
+
+// Produces a first frame, then keeps producing frames on a separate thread,
+// one ahead of the render thread.
+auto start_simulation() -> void;
+
+auto stop_simulation() noexcept -> void;
+
+} // namespace engine::render
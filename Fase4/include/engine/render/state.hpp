@@ -1,11 +1,22 @@
 #pragma once
 
 #include "engine/render/camera.hpp"
+#include "engine/render/frame.hpp"
+#include "engine/render/gpu_resources.hpp"
+#include "engine/render/io_events.hpp"
 #include "engine/render/keyboard.hpp"
 #include "engine/render/layout/world/camera.hpp"
 #include "engine/render/layout/world/world.hpp"
+#include "engine/render/scene.hpp"
+#include "engine/render/stream_ring.hpp"
+#include "engine/render/vertex_format.hpp"
+
+#include "util/spsc_queue.hpp"
+#include "util/triple_buffer.hpp"
 
 #include <GL/freeglut.h>
+#include <brief_int.hpp>
+#include <atomic>
 #include <nonnull_ptr.hpp>
 #include <vector>
 
@@ -13,6 +24,7 @@ namespace engine::render::state {
 
 extern bool enable_axis;
 extern bool enable_lookat_indicator;
+extern bool enable_occlusion_culling;
 
 extern GLenum polygon_mode;
 
@@ -26,8 +38,61 @@ extern ptr::nonnull_ptr<World> world_ptr;
 extern Camera default_camera_mut;
 extern ptr::nonnull_ptr<Camera> camera_ptr;
 extern CameraMode camera_mode;
+extern brief_int::u32 focused_model; // NO_MODEL when not following one.
+
+extern Scene scene;
+extern std::vector<GpuHandle> orbit_buffers; // per curve animation.
+extern GpuHandle axis_buffer;
+extern GpuHandle lookat_indicator_buffer;
+extern brief_int::u32 lookat_indicator_num_vertices;
+
+// Render thread -> simulation thread, for culling.
+extern std::atomic<float> aspect_ratio;
+// Render thread only, in pixels.
+extern float viewport_height;
+
+// Simulation thread -> render thread.
+extern util::TripleBuffer<Frame> frames;
+// GLUT callbacks -> simulation thread.
+extern util::SpscQueue<KeyEvent, 256> key_events;
+extern util::SpscQueue<ClickEvent, 64> click_events;
+
+// Every mesh's vertices, laid out as in Scene::mesh_ranges.
+extern GpuHandle mesh_arena;
+extern VertexLayout vertex_layout;
+
+// Whether to draw through the core profile path, with shaders and vertex
+// arrays, or the legacy fixed function one.
+extern bool core_profile;
 
-extern std::vector<std::vector<float>> buffers;
-extern GLuint bind[3][500];
+// Core profile only.
+extern GLuint mesh_vao;
+extern GLuint simple_vao; // plain float positions.
+extern GLuint simple_program;
+extern GLint simple_mvp_location;
+extern GLint simple_color_location;
+extern GLuint instanced_program;
+extern GLint instanced_view_proj_location;
+extern GLint instanced_color_location;
+extern GLint instanced_texcoord_min_location;
+extern GLint instanced_texcoord_scale_location;
+extern GLint instanced_view_location;
+extern GLint instanced_octahedral_normals_location;
+extern GLint instanced_enable_lighting_location;
+extern GLint instanced_ambient_location;
+extern GLint instanced_light_bases_location;
+extern GLint instanced_cluster_grid_location;
+extern GLint instanced_cluster_scale_location;
+extern GLint instanced_slice_params_location;
+// Batches are submitted with a single multi-draw when supported.
+extern bool enable_multi_draw;
+// Each frame's instance matrices, followed by its indirect commands.
+extern StreamRing stream_ring;
+// Each frame's lights, cluster ranges and light indices, read by the shaders
+// through one buffer texture each.
+extern StreamRing light_ring;
+extern GpuHandle light_texture;
+extern GpuHandle light_range_texture;
+extern GpuHandle light_index_texture;
 
 } // namespace engine::render::state
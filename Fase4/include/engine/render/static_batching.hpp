@@ -0,0 +1,15 @@
+#pragma once
+
+#include "engine/render/layout/world/world.hpp"
+
+namespace engine::render {
+
+// Merges the models of every subtree that never moves into a few combined
+// meshes, already transformed into the space of the subtree's root.
+// Groups with time based transforms anywhere below them keep their models
+// apart, only their own ones are merged.
+// Models placed by <instances> are never merged, they stay instanced.
+// Meshes left unused afterwards are dropped.
+auto batch_static_models(World& world) -> void;
+
+} // namespace engine::render
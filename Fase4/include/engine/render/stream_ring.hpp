@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "engine/render/gpu_resources.hpp"
+
+#include <array>
+#include <brief_int.hpp>
+#include <cstddef>
+
+namespace engine::render {
+
+// A buffer for data rewritten every frame, split in one region per frame in
+// flight so the CPU never writes what the GPU may still be reading.
+// Persistently mapped when buffer storage is available, written with
+// glBufferSubData otherwise.
+struct StreamRing {
+    brief_int::usize static constexpr NUM_REGIONS = 3;
+
+    GpuHandle buffer;
+    std::byte* mapped; // null when not persistently mapped.
+    brief_int::usize region_size; // in bytes.
+    brief_int::usize region; // being written this frame.
+    std::array<GLsync, NUM_REGIONS> fences; // null when not in use.
+};
+
+auto init_stream_ring(StreamRing& ring, brief_int::usize region_size)
+    noexcept -> void;
+
+// Moves on to the next region, growing every region to fit `size` bytes if
+// needed, and waits until the GPU is done reading it.
+// Returns the region's offset into the buffer.
+[[nodiscard]]
+auto begin_stream_frame(StreamRing& ring, brief_int::usize size) noexcept
+    -> brief_int::usize;
+
+// Copies `size` bytes to `offset` bytes into this frame's region.
+auto stream_write(
+    StreamRing& ring,
+    brief_int::usize offset,
+    void const* data,
+    brief_int::usize size
+) noexcept -> void;
+
+// To be called once every draw reading this frame's region was issued.
+auto end_stream_frame(StreamRing& ring) noexcept -> void;
+
+} // namespace engine::render
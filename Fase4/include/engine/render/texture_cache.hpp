@@ -0,0 +1,56 @@
+#pragma once
+
+#include "util/mapped_file.hpp"
+
+#include <brief_int.hpp>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+enum class TexelFormat : brief_int::u32 {
+    RGBA8,
+    BC1, // S3TC DXT1, opaque RGB in 4x4 blocks of 8 bytes.
+};
+
+struct MipLevel {
+    brief_int::u32 width;
+    brief_int::u32 height;
+    brief_int::usize offset; // into the texture's bytes.
+    brief_int::usize size; // in bytes.
+};
+
+// Every mip level of a texture, finest first, either owned or mapped right
+// out of the cache.
+struct TextureData {
+    TexelFormat format;
+    std::vector<MipLevel> levels;
+    std::vector<std::byte> pixels; // empty when mapped.
+    util::MappedFile mapping;
+
+    [[nodiscard]]
+    auto bytes() const noexcept -> std::span<std::byte const>;
+};
+
+// Identifies what a source image turns into: a hash of its contents, mixed
+// with every setting that changes the result.
+[[nodiscard]]
+auto texture_cache_key(std::span<char const> source, bool compress) noexcept
+    -> brief_int::u64;
+
+// Empty if nothing valid is cached under `key`.
+[[nodiscard]]
+auto read_cached_texture(brief_int::u64 key) noexcept
+    -> std::optional<TextureData>;
+
+// Best effort, failures are only logged.
+auto write_cached_texture(brief_int::u64 key, TextureData const& data)
+    noexcept -> void;
+
+// Replaces RGBA8 levels with BC1 ones.
+// Textures that aren't fully opaque are left as they are, returning false.
+auto compress_bc1(TextureData& data) -> bool;
+
+} // namespace engine::render
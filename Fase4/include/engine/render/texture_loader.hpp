@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "engine/render/layout/world/group/model.hpp"
+#include "engine/render/layout/world/world.hpp"
+#include "engine/render/scene.hpp"
+
+#include <brief_int.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace engine::render {
+
+struct TextureStats {
+    brief_int::u32 requested;
+    brief_int::u32 resident; // at least down to their tail.
+    brief_int::u32 failed;
+    brief_int::usize resident_size; // of every streamed level, in bytes.
+};
+
+// Where a texture ended up: a layer of one of the texture arrays, or a plain
+// texture of its own at layer 0 when not using arrays.
+struct TextureSlot {
+    brief_int::u32 array; // NO_TEXTURE until packed, or if it failed.
+    brief_int::u32 layer;
+};
+
+// Starts reading, decoding and mipmapping `files` on the loader's own
+// threads, dropping every texture loaded before.
+// Textures are identified by their index into `files`.
+// As they finish decoding, same sized ones are packed into
+// GL_TEXTURE_2D_ARRAY layers if `use_arrays`, or each kept as a
+// GL_TEXTURE_2D otherwise.
+// Must not be called while the simulation thread runs.
+auto load_textures(std::span<std::string const> files, bool use_arrays)
+    -> void;
+
+// Render thread, once per frame.
+// Streams each array's levels in, coarsest first, down to the finest one
+// worth having at its size on screen, and drops the ones no longer needed.
+// Levels up to config::TEXTURE_STREAMING_TAIL_SIZE are always kept, finer
+// ones only within config::TEXTURE_MEMORY_BUDGET.
+// Uploads go through a pixel buffer ring, at most
+// config::TEXTURE_UPLOAD_BUDGET bytes per frame but always at least one
+// layer of a level.
+// `array_sizes` are as given by measure_texture_arrays.
+auto stream_textures(
+    std::span<float const> array_sizes,
+    float viewport_height
+) noexcept -> void;
+
+// Simulation thread, once per frame.
+// How tall each texture array's biggest drawn model is on screen, as a
+// fraction of its height, indexed by array.
+// `fov_y` is in radians.
+auto measure_texture_arrays(
+    World const& world,
+    Scene const& scene,
+    std::span<TextureSlot const> texture_slots,
+    std::span<Draw const> draws,
+    glm::vec3 const& eye,
+    float fov_y,
+    std::vector<float>& array_sizes
+) noexcept -> void;
+
+// Simulation thread, once per frame.
+// Every texture's slot, indexed like World::textures.
+auto read_texture_slots(std::vector<TextureSlot>& slots) noexcept -> void;
+
+// Where a model's `texture` is, NO_TEXTURE included.
+[[nodiscard]]
+auto find_texture_slot(
+    std::span<TextureSlot const> slots,
+    brief_int::u32 texture
+) noexcept -> TextureSlot;
+
+// What to bind for `array`: a plain white placeholder until its tail is
+// uploaded, or if it's NO_TEXTURE.
+[[nodiscard]]
+auto texture_array_name(brief_int::u32 array) noexcept -> GLuint;
+
+[[nodiscard]]
+auto texture_stats() noexcept -> TextureStats;
+
+// Joins the loader's threads, dropping any pending work.
+auto stop_texture_loader() noexcept -> void;
+
+} // namespace engine::render
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "engine/render/bounds.hpp"
+#include "engine/render/layout/world/world.hpp"
+
+#include <brief_int.hpp>
+#include <cstddef>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <span>
+#include <vector>
+
+namespace engine::render {
+
+enum class PositionFormat : brief_int::u8 {
+    FLOAT, // 3 floats.
+    HALF,  // 3 halves and padding, relative to the mesh's bounds.
+};
+
+enum class NormalFormat : brief_int::u8 {
+    INT_2_10_10_10, // signed normalized, w unused.
+    OCTAHEDRAL,     // 2 signed normalized shorts.
+};
+
+enum class TexcoordFormat : brief_int::u8 {
+    FLOAT,   // 2 floats.
+    UNORM16, // 2 unsigned normalized shorts, over every texcoord's range.
+};
+
+// How every vertex of the mesh arena is interleaved.
+// Positions are always stored relative to their mesh's bounds, see
+// `dequantization_matrix`.
+struct VertexLayout {
+    PositionFormat position_format;
+    NormalFormat normal_format;
+    TexcoordFormat texcoord_format;
+    bool has_normals;
+    bool has_texcoords;
+
+    brief_int::u32 stride; // in bytes.
+    brief_int::u32 normal_offset;
+    brief_int::u32 texcoord_offset;
+
+    // texcoord = stored * texcoord_scale + texcoord_offset.
+    glm::vec2 texcoord_min;
+    glm::vec2 texcoord_scale;
+};
+
+// Largest errors introduced by a layout.
+struct QuantizationErrors {
+    float position; // relative to the mesh's radius.
+    float normal; // in degrees.
+    float texcoord;
+};
+
+// Maps positions stored relative to `bounds` back to model space.
+[[nodiscard]]
+auto dequantization_matrix(Sphere const& bounds) noexcept -> glm::mat4;
+
+// The most compact layout for `world` out of the requested formats,
+// falling back to wider ones for any attribute whose error would exceed the
+// configured tolerances.
+[[nodiscard]]
+auto choose_vertex_layout(
+    World const& world,
+    PositionFormat position_format,
+    NormalFormat normal_format,
+    TexcoordFormat texcoord_format
+) -> VertexLayout;
+
+[[nodiscard]]
+auto quantization_errors(World const& world, VertexLayout const& layout)
+    noexcept -> QuantizationErrors;
+
+// Appends `mesh`'s vertices to `out`, `layout.stride` bytes each.
+auto pack_vertices(
+    Mesh const& mesh,
+    VertexLayout const& layout,
+    std::vector<std::byte>& out
+) -> void;
+
+} // namespace engine::render
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <brief_int.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace util {
+
+// What every cache file starts with, read back in host order.
+struct CacheHeader {
+    brief_int::u32 magic; // which kind of cache.
+    brief_int::u32 version; // bumped whenever its contents or layout change.
+    brief_int::u64 key; // of what was cached.
+};
+
+// Whether `bytes` start with `expected`.
+[[nodiscard]]
+auto matches_cache_header(
+    std::span<std::byte const> bytes,
+    CacheHeader const& expected
+) noexcept -> bool;
+
+// Writes `chunks` back to back into `path`, creating its directory.
+// Written aside and renamed over, so no one maps a half-written file, and
+// nothing is left behind on failure.
+[[nodiscard]]
+auto write_file_atomically(
+    std::filesystem::path const& path,
+    std::span<std::span<std::byte const> const> chunks
+) noexcept -> bool;
+
+} // namespace util
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <utility>
+
+namespace util {
+
+// Where the texels under `index` of a level `coarse` texels across begin
+// and end, along one axis of the level `fine` texels across it was halved
+// from: two of them, three for the last one of an odd sized level so none
+// are left out.
+[[nodiscard]]
+auto constexpr downsample_footprint(
+    brief_int::u32 const index,
+    brief_int::u32 const coarse,
+    brief_int::u32 const fine
+) noexcept -> std::pair<brief_int::u32, brief_int::u32> {
+    auto const begin = std::min(2 * index, fine - 1);
+    auto const end = index + 1 == coarse ? fine : 2 * index + 2;
+    return {begin, end};
+}
+
+} // namespace util
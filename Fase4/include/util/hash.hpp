@@ -0,0 +1,32 @@
+#pragma once
+
+#include <brief_int.hpp>
+#include <cstddef>
+#include <span>
+
+namespace util {
+
+inline constexpr auto FNV_OFFSET_BASIS = brief_int::u64{0xcbf29ce484222325};
+
+// FNV-1a, to tell cached data apart, not for hash tables.
+[[nodiscard]]
+auto inline hash_bytes(
+    brief_int::u64 hash,
+    std::span<std::byte const> const bytes
+) noexcept -> brief_int::u64 {
+    for (auto const byte : bytes) {
+        hash ^= static_cast<brief_int::u64>(byte);
+        hash *= brief_int::u64{0x100000001b3};
+    }
+    return hash;
+}
+
+template <typename T>
+[[nodiscard]]
+auto hash_value(brief_int::u64 const hash, T const& value) noexcept
+    -> brief_int::u64
+{
+    return hash_bytes(hash, std::as_bytes(std::span{&value, 1}));
+}
+
+} // namespace util
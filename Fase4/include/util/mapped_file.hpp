@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace util {
+
+// A whole file mapped read-only into memory, unmapped on destruction.
+class MappedFile {
+  private:
+    std::byte const* data = nullptr;
+    std::size_t size = 0;
+
+    MappedFile(std::byte const* data, std::size_t size) noexcept;
+
+  public:
+    MappedFile() noexcept = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile const&) -> MappedFile& = delete;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+    ~MappedFile();
+
+    // Empty if the file can't be opened or is empty.
+    [[nodiscard]]
+    auto static open(std::string const& path) noexcept
+        -> std::optional<MappedFile>;
+
+    [[nodiscard]]
+    auto bytes() const noexcept -> std::span<std::byte const>;
+};
+
+} // namespace util
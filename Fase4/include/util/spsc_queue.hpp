@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <brief_int.hpp>
+#include <optional>
+
+namespace util {
+
+// Lock-free bounded single-producer single-consumer queue.
+template <typename T, brief_int::usize N>
+    requires (N > 0 and (N & (N - 1)) == 0) // power of 2.
+class SpscQueue {
+  private:
+    std::array<T, N> items = {};
+    alignas(64) std::atomic<brief_int::usize> head = 0; // next to pop.
+    alignas(64) std::atomic<brief_int::usize> tail = 0; // next to push.
+
+  public:
+    // Producer side, fails when full.
+    auto try_push(T const& item) noexcept -> bool {
+        auto const tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - this->head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        this->items[tail % N] = item;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, empty when there's nothing to pop.
+    [[nodiscard]]
+    auto try_pop() noexcept -> std::optional<T> {
+        auto const head = this->head.load(std::memory_order_relaxed);
+        if (head == this->tail.load(std::memory_order_acquire)) {
+            return {};
+        }
+        auto item = this->items[head % N];
+        this->head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+};
+
+} // namespace util
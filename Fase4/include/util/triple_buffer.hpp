@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <brief_int.hpp>
+
+namespace util {
+
+// Lock-free single-producer single-consumer triple buffer.
+// The producer fills the back slot and publishes it, the consumer always
+// reads the latest published slot. Neither ever waits on the other, unless
+// the producer explicitly waits for its last slot to be consumed.
+template <typename T>
+class TripleBuffer {
+  private:
+    auto static constexpr INDEX_MASK = brief_int::u8{0b011};
+    auto static constexpr FRESH_BIT = brief_int::u8{0b100};
+
+    std::array<T, 3> slots = {};
+    brief_int::u8 back_index = 0;  // producer only.
+    brief_int::u8 front_index = 1; // consumer only.
+    std::atomic<brief_int::u8> middle = 2;
+
+  public:
+    // Producer side.
+
+    [[nodiscard]]
+    auto back() noexcept -> T& {
+        return this->slots[this->back_index];
+    }
+
+    auto publish() noexcept -> void {
+        auto const prev = this->middle.exchange(
+            this->back_index | FRESH_BIT, std::memory_order_acq_rel
+        );
+        this->back_index = prev & INDEX_MASK;
+    }
+
+    // Blocks until the last published slot has been consumed.
+    auto wait_consumed() const noexcept -> void {
+        auto current = this->middle.load(std::memory_order_acquire);
+        while ((current & FRESH_BIT) != 0) {
+            this->middle.wait(current, std::memory_order_acquire);
+            current = this->middle.load(std::memory_order_acquire);
+        }
+    }
+
+    // Consumer side.
+
+    // Whether a slot was published since the last acquire().
+    [[nodiscard]]
+    auto fresh() const noexcept -> bool {
+        return (this->middle.load(std::memory_order_relaxed) & FRESH_BIT) != 0;
+    }
+
+    // Latest published slot, valid until the next call.
+    [[nodiscard]]
+    auto acquire() noexcept -> T const& {
+        if ((this->middle.load(std::memory_order_relaxed) & FRESH_BIT) != 0) {
+            auto const prev = this->middle.exchange(
+                this->front_index, std::memory_order_acq_rel
+            );
+            this->front_index = prev & INDEX_MASK;
+            this->middle.notify_one();
+        }
+        return this->slots[this->front_index];
+    }
+};
+
+} // namespace util
@@ -59,8 +59,75 @@ constinit float const LINE_WIDTH_STEP = 1.f;
 
 constinit GLenum const DEFAULT_POLYGON_MODE = GL_LINE;
 
+// Shaders and vertex arrays in a 3.3 core context, or the legacy fixed
+// function pipeline. Only the default, --legacy overrides it.
+constinit bool const ENABLE_CORE_PROFILE = true;
+
+constinit brief_int::usize const ORBIT_NUM_POINTS = 100;
+
 constinit unsigned int const RENDER_TICK_MILLIS = 16; // 60 FPS
 
+// Occluders are rasterized in software at low resolution, the biggest ones
+// on screen first.
+constinit bool const ENABLE_OCCLUSION_CULLING = true;
+constinit brief_int::u32 const OCCLUSION_BUFFER_WIDTH = 256;
+constinit brief_int::u32 const OCCLUSION_BUFFER_HEIGHT = 128;
+constinit brief_int::usize const OCCLUSION_MAX_OCCLUDERS = 16;
+constinit brief_int::usize const OCCLUSION_MAX_OCCLUDER_TRIANGLES = 4096;
+
+// Resources unused for the longest are evicted past this, and uploaded again
+// when next needed.
+constinit brief_int::usize const GPU_MEMORY_BUDGET = 512 * 1024 * 1024;
+// Initial size of each frame's streamed data, grown as needed.
+constinit brief_int::usize const STREAM_RING_REGION_SIZE = 1024 * 1024;
+
+// Textures are decoded and mipmapped in the background, then uploaded a few
+// levels per frame so loading never stalls drawing.
+constinit brief_int::usize const TEXTURE_LOADER_THREADS = 2;
+constinit brief_int::usize const TEXTURE_UPLOAD_BUDGET = 4 * 1024 * 1024;
+// Decoded and mipmapped textures are kept here, keyed by their source's
+// contents, and mapped straight from disk on later runs.
+constinit char const* const TEXTURE_CACHE_DIR = ".texture_cache";
+// Opaque textures are stored as S3TC, if the driver supports it.
+constinit bool const ENABLE_TEXTURE_COMPRESSION = true;
+// Only the mip levels a texture needs at its size on screen are resident,
+// streamed in and out as that changes. Levels no bigger than the tail size
+// are always kept, so there's something to draw with right away.
+constinit brief_int::usize const TEXTURE_MEMORY_BUDGET = 256 * 1024 * 1024;
+constinit brief_int::u32 const TEXTURE_STREAMING_TAIL_SIZE = 64;
+
+// The view frustum is split into a grid of clusters, evenly across the
+// screen and exponentially in depth, each knowing which lights reach it.
+// Lights without a range stop affecting anything past this one.
+constinit brief_int::u32 const LIGHT_CLUSTERS_X = 16;
+constinit brief_int::u32 const LIGHT_CLUSTERS_Y = 9;
+constinit brief_int::u32 const LIGHT_CLUSTERS_Z = 24;
+constinit float const DEFAULT_LIGHT_RANGE = 100.f;
+constinit float const AMBIENT_LIGHT = 0.15f;
+
+// Static subtrees are merged at load, into meshes no bigger than this so
+// they can still be culled in pieces.
+constinit bool const ENABLE_STATIC_BATCHING = true;
+constinit brief_int::u32 const STATIC_BATCH_MIN_MODELS = 2;
+constinit brief_int::usize const STATIC_BATCH_MAX_VERTICES = 65536;
+
+// Formats are widened at load for any attribute that would be off by more
+// than these. Positions relative to their mesh's radius, normals in degrees.
+constinit PositionFormat const VERTEX_POSITION_FORMAT = PositionFormat::HALF;
+constinit NormalFormat const VERTEX_NORMAL_FORMAT
+    = NormalFormat::INT_2_10_10_10;
+constinit TexcoordFormat const VERTEX_TEXCOORD_FORMAT
+    = TexcoordFormat::UNORM16;
+constinit float const VERTEX_MAX_POSITION_ERROR = 1e-3f;
+constinit float const VERTEX_MAX_NORMAL_ERROR = 0.5f;
+constinit float const VERTEX_MAX_TEXCOORD_ERROR = 1.f / 8192.f;
+
+// Generated normals are smoothed across vertices closer than the tolerance,
+// relative to their mesh's radius, unless their faces meet at a sharper
+// angle than the crease.
+constinit float const NORMAL_WELD_TOLERANCE = 1e-5f;
+constinit float const NORMAL_CREASE_ANGLE = 60.f;
+
 // WARNING: not constinit, do not rely on initialization order!
 World const DEFAULT_WORLD = {};
 
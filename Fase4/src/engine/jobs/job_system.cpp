@@ -0,0 +1,178 @@
+#include "engine/jobs/job_system.hpp"
+
+#include <utility>
+
+namespace engine::jobs {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+usize static requested_num_threads = 0;
+
+// Index of the queue owned by the current thread.
+thread_local usize static this_queue = 0;
+
+auto TaskGraph::add(Job job) -> TaskId {
+    auto& task = this->tasks.emplace_back();
+    task.job = std::move(job);
+    task.num_dependencies = 0;
+    return static_cast<TaskId>(this->tasks.size() - 1);
+}
+
+auto TaskGraph::precede(TaskId const before, TaskId const after) -> void {
+    this->tasks[before].successors.push_back(after);
+    ++this->tasks[after].num_dependencies;
+}
+
+JobSystem::JobSystem(usize const num_threads) {
+    this->queues.reserve(num_threads);
+    for (auto queue = 0_uz; queue < num_threads; ++queue) {
+        this->queues.push_back(std::make_unique<Queue>());
+    }
+
+    // The calling thread counts as one of the threads running jobs.
+    this->workers.reserve(num_threads - 1);
+    for (auto queue = 1_uz; queue < num_threads; ++queue) {
+        this->workers.emplace_back([this, queue](std::stop_token stop) {
+            this->worker_loop(std::move(stop), queue);
+        });
+    }
+}
+
+JobSystem::~JobSystem() {
+    // Stopping wakes up sleeping workers, which are then joined here, before
+    // the queues they use are destroyed.
+    for (auto& worker : this->workers) {
+        worker.request_stop();
+    }
+    this->workers.clear();
+}
+
+auto JobSystem::num_threads() const noexcept -> usize {
+    return this->queues.size();
+}
+
+auto JobSystem::push(Job job, std::atomic<usize>* const counter) -> void {
+    {
+        auto& queue = *this->queues[this_queue];
+        auto lock = std::scoped_lock{queue.mutex};
+        queue.jobs.emplace_back(std::move(job), counter);
+    }
+    this->num_queued.fetch_add(1, std::memory_order_release);
+    {
+        // Prevents a lost wake up if a worker is about to sleep.
+        auto lock = std::scoped_lock{this->sleep_mutex};
+    }
+    this->wake_up.notify_one();
+}
+
+auto JobSystem::try_run_one() noexcept -> bool {
+    auto job = std::pair<Job, std::atomic<usize>*>{};
+    auto found = false;
+
+    // Own queue first, newest job first for locality.
+    {
+        auto& queue = *this->queues[this_queue];
+        auto lock = std::scoped_lock{queue.mutex};
+        if (not queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // Then steal the oldest job of some other queue.
+    auto const num_queues = this->queues.size();
+    for (auto offset = 1_uz; not found and offset < num_queues; ++offset) {
+        auto& queue = *this->queues[(this_queue + offset) % num_queues];
+        auto lock = std::scoped_lock{queue.mutex};
+        if (not queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (not found) {
+        return false;
+    }
+
+    this->num_queued.fetch_sub(1, std::memory_order_relaxed);
+    job.first();
+    job.second->fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+auto JobSystem::worker_loop(std::stop_token const stop, usize const queue)
+    noexcept -> void
+{
+    this_queue = queue;
+
+    while (not stop.stop_requested()) {
+        if (this->try_run_one()) {
+            continue;
+        }
+        auto lock = std::unique_lock{this->sleep_mutex};
+        this->wake_up.wait(lock, stop, [this] {
+            return this->num_queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+auto JobSystem::wait(std::atomic<usize> const& counter) noexcept -> void {
+    while (counter.load(std::memory_order_acquire) > 0) {
+        if (not this->try_run_one()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+auto JobSystem::run(TaskGraph& graph) -> void {
+    auto pending = std::atomic<usize>{graph.tasks.size()};
+
+    for (auto& task : graph.tasks) {
+        task.remaining_dependencies.store(
+            task.num_dependencies, std::memory_order_relaxed
+        );
+    }
+
+    auto schedule = std::function<void(TaskGraph::TaskId)>{};
+    schedule = [&](TaskGraph::TaskId const id) {
+        this->push([&, id] {
+            auto& task = graph.tasks[id];
+            task.job();
+            for (auto const successor : task.successors) {
+                auto& next = graph.tasks[successor];
+                if (next.remaining_dependencies.fetch_sub(
+                        1, std::memory_order_acq_rel
+                    ) == 1
+                ) {
+                    schedule(successor);
+                }
+            }
+        }, &pending);
+    };
+
+    for (auto id = 0_uz; id < graph.tasks.size(); ++id) {
+        if (graph.tasks[id].num_dependencies == 0) {
+            schedule(static_cast<TaskGraph::TaskId>(id));
+        }
+    }
+
+    this->wait(pending);
+}
+
+auto set_num_threads(usize const num_threads) noexcept -> void {
+    requested_num_threads = num_threads;
+}
+
+auto get() -> JobSystem& {
+    auto static lazy_static = JobSystem {
+        requested_num_threads != 0
+            ? requested_num_threads
+            : std::max(1_uz, usize{std::thread::hardware_concurrency()}),
+    };
+    return lazy_static;
+}
+
+} // namespace engine::jobs
@@ -1,4 +1,5 @@
 #include "engine/module.hpp"
+#include "util/parse_number.hpp"
 
 #include <brief_int.hpp>
 #include <cerrno>
@@ -8,6 +9,7 @@
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <spdlog/sinks/stdout_color_sinks-inl.h>
+#include <span>
 #include <spdlog/spdlog.h>
 #include <string_view>
 
@@ -31,29 +33,40 @@ auto main(int argc, char* argv[]) -> int {
     spdlog::flush_on(spdlog::level::err);
     spdlog::set_pattern(std::move(log_prefix));
 
-    if (argc > 2) {
-        spdlog::error("too many options provided.");
-        spdlog::critical("aborting.");
-        return EXIT_FAILURE;
+    char const* input_filename = nullptr;
+
+    for (auto const* const arg : std::span{argv + 1, argv + argc}) {
+        auto const cmd = std::string_view{arg};
+        auto const value = cmd.substr(cmd.find('=') + 1);
+
+        if (cmd == "-h" or cmd == "--help") {
+            engine::display_help();
+            return EXIT_SUCCESS;
+        } else if (cmd.starts_with("--input=")) {
+            input_filename = value.data();
+        } else if (cmd.starts_with("--threads=")) {
+            auto const num_threads = util::parse_number<brief_int::u32>(value);
+            if (not num_threads.has_value()) {
+                spdlog::error("invalid number of threads '{}'.", value);
+                spdlog::critical("aborting.");
+                return EXIT_FAILURE;
+            }
+            engine::jobs::set_num_threads(*num_threads);
+        } else if (cmd == "--legacy") {
+            engine::render::set_legacy(true);
+        } else {
+            spdlog::error("unrecognized command '{}'.", cmd);
+            spdlog::critical("aborting.");
+            return EXIT_FAILURE;
+        }
     }
 
-    if (argc == 1) {
+    if (input_filename == nullptr) {
         spdlog::info("no XML file was provided, rendering a default world.");
         engine::render::get().run();
         return EXIT_SUCCESS;
     }
 
-    auto const cmd = std::string_view{argv[1]};
-    if (cmd == "-h" or cmd == "--help") {
-        engine::display_help();
-        return EXIT_SUCCESS;
-    } else if (not cmd.starts_with("--input=")) {
-        spdlog::error("unrecognized command '{}'.", cmd);
-        spdlog::critical("aborting.");
-        return EXIT_FAILURE;
-    }
-    char const* const input_filename = cmd.data() + cmd.find('=') + 1;
-
     errno = 0;
     auto world_and_cam = engine::parse::xml::parse_xml(input_filename);
 
@@ -90,9 +103,14 @@ auto static display_help() -> void {
         "    {prog} (-h | --help)\n"
         "        Display this message.\n"
         "\n"
-        "    {prog} --input=<input_file>\n"
+        "    {prog} [--input=<input_file>] [--threads=<num_threads>]\n"
+        "            [--legacy]\n"
         "        Render the world described in the XML file named\n"
-        "        <input_file>.\n",
+        "        <input_file>, or a default world if none is given.\n"
+        "        Scene updates are spread over <num_threads> threads,\n"
+        "        0 (the default) meaning one per hardware thread.\n"
+        "        --legacy draws with the fixed function pipeline instead\n"
+        "        of an OpenGL 3.3 core context.\n",
         fmt::arg("prog", config::PROG_NAME)
     );
 }
@@ -1,49 +1,134 @@
 #include "engine/parse/xml/group/group.hpp"
 
+#include "engine/parse/xml/group/instances/instances.hpp"
 #include "engine/parse/xml/group/model/model_list.hpp"
 #include "engine/parse/xml/group/transform/transform_list.hpp"
+#include "engine/render/mesh_attributes.hpp"
 #include "util/try.hpp"
 
+#include <brief_int.hpp>
+#include <iterator>
 #include <new>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace engine::parse::xml {
 
-// TODO: Implement non-recursively.
 auto parse_group(rapidxml::xml_node<> const* const node) noexcept
-    -> cpp::result<render::Group, ParseErr>
+    -> cpp::result<render::World, ParseErr>
 try {
+    using namespace brief_int;
     using namespace std::string_view_literals;
 
     auto static constexpr transform_str = "transform"sv;
     auto static constexpr models_str = "models"sv;
     auto static constexpr group_str = "group"sv;
+    auto static constexpr instances_str = "instances"sv;
 
-    auto root = render::Group{};
-
-    for (
-        auto const* child = node->first_node();
-        child != nullptr;
-        child = child->next_sibling()
-    ) {
-        auto const child_name = std::string_view {
-            child->name(),
-            child->name_size(),
-        };
-
-        if (child_name == transform_str) {
-            root.transforms = TRY_RESULT(parse_transform_list(child));
-        } else if (child_name == models_str) {
-            root.models = TRY_RESULT(parse_model_list(child));
-        } else if (child_name == group_str) {
-            root.children.push_back(TRY_RESULT(parse_group(child)));
-        } else {
-            return cpp::fail(ParseErr::UNKNOWN_GROUP_CHILD_NODE);
+    struct PendingGroup {
+        rapidxml::xml_node<> const* node;
+        u32 parent;
+    };
+
+    auto world = render::World{};
+    auto asset_cache = AssetCache{};
+
+    // Explicit stack instead of recursion, so arbitrarily deep scenes can't
+    // overflow the call stack.
+    auto pending = std::vector<PendingGroup>{{node, render::NO_PARENT}};
+    auto child_groups = std::vector<rapidxml::xml_node<> const*>{};
+    auto instance_models = std::vector<render::Model>{};
+
+    while (not pending.empty()) {
+        auto const [group_node, parent] = pending.back();
+        pending.pop_back();
+
+        auto const group = static_cast<u32>(world.group_parents.size());
+        auto const transforms_begin = static_cast<u32>(world.transforms.size());
+        auto const models_begin = static_cast<u32>(world.models.size());
+
+        child_groups.clear();
+        instance_models.clear();
+        for (
+            auto const* child = group_node->first_node();
+            child != nullptr;
+            child = child->next_sibling()
+        ) {
+            auto const child_name = std::string_view {
+                child->name(),
+                child->name_size(),
+            };
+
+            if (child_name == transform_str) {
+                auto transforms = TRY_RESULT(parse_transform_list(child));
+                // Only the last transform node of a group is kept.
+                world.transforms.resize(transforms_begin);
+                world.transforms.insert(
+                    world.transforms.end(),
+                    std::make_move_iterator(transforms.begin()),
+                    std::make_move_iterator(transforms.end())
+                );
+            } else if (child_name == models_str) {
+                auto models = TRY_RESULT(parse_model_list(child, asset_cache));
+                // Only the last models node of a group is kept.
+                world.models.resize(models_begin);
+                world.models.insert(
+                    world.models.end(),
+                    std::make_move_iterator(models.begin()),
+                    std::make_move_iterator(models.end())
+                );
+            } else if (child_name == instances_str) {
+                auto const [mesh, texture, matrices]
+                    = TRY_RESULT(parse_instances(child, asset_cache));
+                for (auto const& matrix : matrices) {
+                    instance_models.push_back({
+                        .mesh = mesh,
+                        .matrix = static_cast<u32>(world.model_matrices.size()),
+                        .texture = texture,
+                    });
+                    world.model_matrices.push_back(matrix);
+                }
+            } else if (child_name == group_str) {
+                child_groups.push_back(child);
+            } else {
+                return cpp::fail(ParseErr::UNKNOWN_GROUP_CHILD_NODE);
+            }
         }
+
+        // Kept apart until now, so a later models node can't drop them.
+        world.models.insert(
+            world.models.end(), instance_models.begin(), instance_models.end()
+        );
+
+        world.group_parents.push_back(parent);
+        world.group_transforms.push_back({
+            .begin = transforms_begin,
+            .end = static_cast<u32>(world.transforms.size()),
+        });
+        world.group_models.push_back({
+            .begin = models_begin,
+            .end = static_cast<u32>(world.models.size()),
+        });
+
+        // Pushed in reverse so children are popped in document order.
+        for (auto it = child_groups.rbegin(); it != child_groups.rend(); ++it) {
+            pending.push_back({.node = *it, .parent = group});
+        }
+    }
+
+    // Generated only once every mesh is known, so they're all done at once.
+    auto mesh_files = std::vector<std::string>(asset_cache.meshes.size());
+    for (auto const& [filename, mesh] : asset_cache.by_filename) {
+        mesh_files[mesh] = filename;
     }
+    render::generate_mesh_attributes(asset_cache.meshes, mesh_files);
 
-    return root;
+    world.meshes = std::move(asset_cache.meshes);
+    world.textures = std::move(asset_cache.textures);
+    return world;
 
 } catch (std::bad_alloc const&) {
     return cpp::fail(ParseErr::NO_MEM);
@@ -0,0 +1,200 @@
+#include "engine/parse/xml/group/instances/instances.hpp"
+
+#include "engine/parse/xml/util/number_attr.hpp"
+#include "util/try.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/scalar_constants.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <iterator>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+namespace engine::parse::xml {
+
+using namespace brief_int;
+
+[[nodiscard]]
+auto static attr_value(
+    rapidxml::xml_node<> const* const node,
+    std::string_view const name
+) noexcept -> std::string_view {
+    auto const* const attr = node->first_attribute(name.data(), name.length());
+    return attr == nullptr
+        ? std::string_view{}
+        : std::string_view{attr->value(), attr->value_size()};
+}
+
+auto static read_matrices(char const* const filename) noexcept
+    -> cpp::result<std::vector<glm::mat4>, ParseErr>
+try {
+    auto file = std::ifstream{filename, std::ios::binary};
+    if (not file) {
+        return cpp::fail(ParseErr::NO_INSTANCES_FILE);
+    }
+
+    auto const bytes = std::vector<char> {
+        std::istreambuf_iterator<char>{file},
+        std::istreambuf_iterator<char>{},
+    };
+    if (file.bad()) {
+        return cpp::fail(ParseErr::IO_ERR);
+    }
+    if (bytes.size() % sizeof(glm::mat4) != 0) {
+        return cpp::fail(ParseErr::MALFORMED_INSTANCES_FILE);
+    }
+
+    auto matrices = std::vector<glm::mat4>(bytes.size() / sizeof(glm::mat4));
+    std::memcpy(matrices.data(), bytes.data(), bytes.size());
+    return matrices;
+
+} catch (std::bad_alloc const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+} catch (std::length_error const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+}
+
+auto static generate_matrices(rapidxml::xml_node<> const* const node) noexcept
+    -> cpp::result<std::vector<glm::mat4>, ParseErr>
+try {
+    using namespace std::string_view_literals;
+
+    enum class Distribution {
+        RING,
+        SPHERE,
+        BOX,
+    };
+
+    auto const distribution_str = attr_value(node, "distribution"sv);
+    Distribution distribution;
+    if (distribution_str == "ring"sv) {
+        distribution = Distribution::RING;
+    } else if (distribution_str == "sphere"sv) {
+        distribution = Distribution::SPHERE;
+    } else if (distribution_str == "box"sv) {
+        distribution = Distribution::BOX;
+    } else {
+        return cpp::fail(ParseErr::UNKNOWN_INSTANCES_DISTRIBUTION);
+    }
+
+    auto const count = TRY_RESULT(parse_number_attr<u32>(node, "count"sv));
+    auto const seed = TRY_RESULT(parse_number_attr_or(node, "seed"sv, u32{0}));
+    auto const radius
+        = TRY_RESULT(parse_number_attr_or(node, "radius"sv, 1.f));
+    auto const inner = TRY_RESULT(parse_number_attr_or(node, "inner"sv, 0.f));
+    auto const height
+        = TRY_RESULT(parse_number_attr_or(node, "height"sv, 0.f));
+    auto const min_scale
+        = TRY_RESULT(parse_number_attr_or(node, "min_scale"sv, 1.f));
+    auto const max_scale
+        = TRY_RESULT(parse_number_attr_or(node, "max_scale"sv, 1.f));
+
+    // Same seed, same population.
+    auto rng = std::mt19937{seed};
+    auto uniform = std::uniform_real_distribution<float>{0.f, 1.f};
+    auto const random = [&] { return uniform(rng); };
+    auto const random_direction = [&] {
+        auto const z = random() * 2.f - 1.f;
+        auto const angle = random() * glm::two_pi<float>();
+        auto const r = std::sqrt(1.f - z * z);
+        return glm::vec3{r * std::cos(angle), r * std::sin(angle), z};
+    };
+
+    auto matrices = std::vector<glm::mat4>{};
+    matrices.reserve(count);
+    for (auto i = u32{0}; i < count; ++i) {
+        glm::vec3 pos;
+        switch (distribution) {
+            using enum Distribution;
+
+            case RING: {
+                // Uniform over the ring's area, around the y axis.
+                auto const angle = random() * glm::two_pi<float>();
+                auto const r = std::sqrt(glm::mix(
+                    inner * inner, radius * radius, random()
+                ));
+                pos = {
+                    r * std::cos(angle),
+                    (random() - 0.5f) * height,
+                    r * std::sin(angle),
+                };
+                break;
+            }
+
+            case SPHERE: {
+                // Uniform over the shell's volume.
+                auto const r = std::cbrt(glm::mix(
+                    inner * inner * inner, radius * radius * radius, random()
+                ));
+                pos = random_direction() * r;
+                break;
+            }
+
+            case BOX:
+                pos = glm::vec3{random(), random(), random()} * (2.f * radius)
+                    - radius;
+                break;
+        }
+
+        auto const angle = random() * glm::two_pi<float>();
+        auto const scale = glm::mix(min_scale, max_scale, random());
+        auto matrix = glm::translate(glm::mat4{1.f}, pos);
+        matrix = glm::rotate(matrix, angle, random_direction());
+        matrix = glm::scale(matrix, glm::vec3{scale});
+        matrices.push_back(matrix);
+    }
+    return matrices;
+
+} catch (std::bad_alloc const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+} catch (std::length_error const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+}
+
+auto parse_instances(
+    rapidxml::xml_node<> const* const node,
+    AssetCache& cache
+) noexcept -> cpp::result<Instances, ParseErr> {
+    auto const* const model_attr = TRY_NULLABLE_OR(
+        node->first_attribute("model"),
+        return cpp::fail(ParseErr::NO_MODEL_FILENAME);
+    );
+    auto const mesh = TRY_RESULT(load_mesh(
+        std::string_view{model_attr->value(), model_attr->value_size()},
+        cache
+    ));
+
+    auto texture = render::NO_TEXTURE;
+    if (auto const* const texture_attr = node->first_attribute("texture");
+        texture_attr != nullptr
+    ) {
+        texture = TRY_RESULT(add_texture(
+            std::string_view{texture_attr->value(), texture_attr->value_size()},
+            cache
+        ));
+    }
+
+    if (auto const* const file_attr = node->first_attribute("file");
+        file_attr != nullptr
+    ) {
+        return Instances {
+            .mesh = mesh,
+            .texture = texture,
+            .matrices = TRY_RESULT(read_matrices(file_attr->value())),
+        };
+    }
+
+    return Instances {
+        .mesh = mesh,
+        .texture = texture,
+        .matrices = TRY_RESULT(generate_matrices(node)),
+    };
+}
+
+} // namespace engine::parse::xml
@@ -9,6 +9,7 @@
 #include <glm/vec3.hpp>
 #include <new>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <tiny_obj_loader.h>
 #include <utility>
@@ -16,14 +17,19 @@
 
 namespace engine::parse::xml {
 
+auto static parse_mesh(char const* model_filename) noexcept
+    -> cpp::result<render::Mesh, ParseErr>;
+
 auto static parse_3d(char const* model_filename) noexcept
-    -> cpp::result<render::Model, ParseErr>;
+    -> cpp::result<render::Mesh, ParseErr>;
 
 auto static parse_obj(char const* model_filename) noexcept
-    -> cpp::result<render::Model, ParseErr>;
+    -> cpp::result<render::Mesh, ParseErr>;
 
-auto parse_model(rapidxml::xml_node<> const* const node) noexcept
-    -> cpp::result<render::Model, ParseErr>
+auto parse_model(
+    rapidxml::xml_node<> const* const node,
+    AssetCache& cache
+) noexcept -> cpp::result<render::Model, ParseErr>
 {
     auto const* const model_filename_attr = TRY_NULLABLE_OR(
         node->first_attribute("file"),
@@ -35,11 +41,79 @@ auto parse_model(rapidxml::xml_node<> const* const node) noexcept
         return cpp::fail(ParseErr::NO_MODEL_FILENAME);
     );
 
-    auto const model_filename_sized = std::string_view {
-        model_filename,
-        model_filename_attr->value_size(),
+    auto const mesh = TRY_RESULT(load_mesh(
+        std::string_view {
+            model_filename,
+            model_filename_attr->value_size(),
+        },
+        cache
+    ));
+
+    auto texture = render::NO_TEXTURE;
+    if (auto const* const texture_node = node->first_node("texture");
+        texture_node != nullptr
+    ) {
+        auto const* const texture_filename_attr = TRY_NULLABLE_OR(
+            texture_node->first_attribute("file"),
+            return cpp::fail(ParseErr::NO_TEXTURE_FILENAME);
+        );
+        texture = TRY_RESULT(add_texture(
+            std::string_view {
+                texture_filename_attr->value(),
+                texture_filename_attr->value_size(),
+            },
+            cache
+        ));
+    }
+
+    return render::Model {
+        .mesh = mesh,
+        .matrix = render::NO_MATRIX,
+        .texture = texture,
     };
+}
+
+auto load_mesh(std::string_view const filename, AssetCache& cache) noexcept
+    -> cpp::result<brief_int::u32, ParseErr>
+try {
+    auto const [it, inserted] = cache.by_filename.try_emplace(
+        std::string{filename},
+        static_cast<brief_int::u32>(cache.meshes.size())
+    );
+    // Any other model using the same file shares its mesh.
+    if (inserted) {
+        cache.meshes.push_back(TRY_RESULT(parse_mesh(it->first.c_str())));
+    }
+    return it->second;
+
+} catch (std::bad_alloc const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+} catch (std::length_error const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+}
 
+auto add_texture(std::string_view const filename, AssetCache& cache) noexcept
+    -> cpp::result<brief_int::u32, ParseErr>
+try {
+    auto const [it, inserted] = cache.texture_by_filename.try_emplace(
+        std::string{filename},
+        static_cast<brief_int::u32>(cache.textures.size())
+    );
+    if (inserted) {
+        cache.textures.push_back(it->first);
+    }
+    return it->second;
+
+} catch (std::bad_alloc const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+} catch (std::length_error const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+}
+
+auto static parse_mesh(char const* const model_filename) noexcept
+    -> cpp::result<render::Mesh, ParseErr>
+{
+    auto const model_filename_sized = std::string_view{model_filename};
     if (model_filename_sized.ends_with(".3d")) {
         return parse_3d(model_filename);
     } else if (model_filename_sized.ends_with(".obj")) {
@@ -50,7 +124,7 @@ auto parse_model(rapidxml::xml_node<> const* const node) noexcept
 }
 
 auto static parse_3d(char const* const model_filename) noexcept
-    -> cpp::result<render::Model, ParseErr>
+    -> cpp::result<render::Mesh, ParseErr>
 try {
     using namespace brief_int;
 
@@ -87,8 +161,13 @@ try {
     }
 
     SUCCESS:
-    return render::Model {
-        .vertices = std::move(vertices)
+    auto const bounds = render::bounding_sphere(vertices);
+    return render::Mesh {
+        .vertices = std::move(vertices),
+        .normals = {},
+        .texcoords = {},
+        .tangents = {},
+        .bounds = bounds,
     };
 
 } catch (std::bad_alloc const&) {
@@ -98,7 +177,7 @@ try {
 }
 
 auto static parse_obj(char const* const model_filename) noexcept
-    -> cpp::result<render::Model, ParseErr>
+    -> cpp::result<render::Mesh, ParseErr>
 try {
     using namespace brief_int;
     using namespace brief_int::literals;
@@ -123,13 +202,28 @@ try {
     }
 
     auto vertices = std::vector<glm::vec3>{};
+    auto normals = std::vector<glm::vec3>{};
+    auto texcoords = std::vector<glm::vec2>{};
 
     auto num_vertices = 0_uz;
+    // Only kept if every vertex has them.
+    auto has_normals = true;
+    auto has_texcoords = true;
     for (auto const& shape : shapes) {
         num_vertices += shape.mesh.indices.size();
+        for (auto const& idx : shape.mesh.indices) {
+            has_normals = has_normals and idx.normal_index >= 0;
+            has_texcoords = has_texcoords and idx.texcoord_index >= 0;
+        }
     }
 
     vertices.reserve(num_vertices);
+    if (has_normals) {
+        normals.reserve(num_vertices);
+    }
+    if (has_texcoords) {
+        texcoords.reserve(num_vertices);
+    }
 
     for (auto const& shape : shapes) {
         for (auto const& idx : shape.mesh.indices) {
@@ -139,11 +233,33 @@ try {
                 attrib.vertices[vertex_idx + 1],
                 attrib.vertices[vertex_idx + 2]
             );
+            if (has_normals) {
+                auto const normal_idx
+                    = static_cast<usize>(idx.normal_index) * 3;
+                normals.emplace_back(
+                    attrib.normals[normal_idx],
+                    attrib.normals[normal_idx + 1],
+                    attrib.normals[normal_idx + 2]
+                );
+            }
+            if (has_texcoords) {
+                auto const texcoord_idx
+                    = static_cast<usize>(idx.texcoord_index) * 2;
+                texcoords.emplace_back(
+                    attrib.texcoords[texcoord_idx],
+                    attrib.texcoords[texcoord_idx + 1]
+                );
+            }
         }
     }
 
-    return render::Model {
-        .vertices = std::move(vertices)
+    auto const bounds = render::bounding_sphere(vertices);
+    return render::Mesh {
+        .vertices = std::move(vertices),
+        .normals = std::move(normals),
+        .texcoords = std::move(texcoords),
+        .tangents = {},
+        .bounds = bounds,
     };
 
 } catch (std::bad_alloc const&) {
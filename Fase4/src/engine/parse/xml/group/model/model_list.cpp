@@ -8,8 +8,10 @@
 
 namespace engine::parse::xml {
 
-auto parse_model_list(rapidxml::xml_node<> const* const node) noexcept
-    -> cpp::result<std::vector<render::Model>, ParseErr>
+auto parse_model_list(
+    rapidxml::xml_node<> const* const node,
+    AssetCache& cache
+) noexcept -> cpp::result<std::vector<render::Model>, ParseErr>
 try {
     auto model_list = std::vector<render::Model>{};
 
@@ -18,7 +20,7 @@ try {
         model != nullptr;
         model = model->next_sibling()
     ) {
-        model_list.push_back(TRY_RESULT(parse_model(model)));
+        model_list.push_back(TRY_RESULT(parse_model(model, cache)));
     }
 
     return model_list;
@@ -0,0 +1,97 @@
+#include "engine/parse/xml/lights/lights.hpp"
+
+#include "engine/config.hpp"
+#include "engine/parse/xml/util/number_attr.hpp"
+#include "util/try.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+
+namespace engine::parse::xml {
+
+[[nodiscard]]
+auto static parse_light_type(rapidxml::xml_node<> const* const node) noexcept
+    -> cpp::result<render::LightType, ParseErr>
+{
+    using namespace std::string_view_literals;
+
+    auto const* const attr = node->first_attribute("type");
+    auto const type = attr == nullptr
+        ? std::string_view{}
+        : std::string_view{attr->value(), attr->value_size()};
+    if (type == "point"sv) {
+        return render::LightType::POINT;
+    } else if (type == "spotlight"sv) {
+        return render::LightType::SPOT;
+    } else if (type == "directional"sv) {
+        return render::LightType::DIRECTIONAL;
+    }
+    return cpp::fail(ParseErr::UNKNOWN_LIGHT_TYPE);
+}
+
+[[nodiscard]]
+auto static parse_light(rapidxml::xml_node<> const* const node) noexcept
+    -> cpp::result<render::Light, ParseErr>
+{
+    auto light = render::Light {
+        .type = TRY_RESULT(parse_light_type(node)),
+        .position = {0.f, 0.f, 0.f},
+        .direction = {0.f, -1.f, 0.f},
+        .color = {
+            TRY_RESULT(parse_number_attr_or(node, "r", 1.f)),
+            TRY_RESULT(parse_number_attr_or(node, "g", 1.f)),
+            TRY_RESULT(parse_number_attr_or(node, "b", 1.f)),
+        },
+        .range = TRY_RESULT(
+            parse_number_attr_or(
+                node, "range", render::config::DEFAULT_LIGHT_RANGE
+            )
+        ),
+        .cutoff = 0.f,
+    };
+
+    if (light.type != render::LightType::DIRECTIONAL) {
+        light.position = {
+            TRY_RESULT(parse_number_attr<float>(node, "posx")),
+            TRY_RESULT(parse_number_attr<float>(node, "posy")),
+            TRY_RESULT(parse_number_attr<float>(node, "posz")),
+        };
+    }
+    if (light.type != render::LightType::POINT) {
+        auto const direction = glm::vec3 {
+            TRY_RESULT(parse_number_attr<float>(node, "dirx")),
+            TRY_RESULT(parse_number_attr<float>(node, "diry")),
+            TRY_RESULT(parse_number_attr<float>(node, "dirz")),
+        };
+        if (glm::dot(direction, direction) > 0.f) {
+            light.direction = glm::normalize(direction);
+        }
+    }
+    if (light.type == render::LightType::SPOT) {
+        light.cutoff = TRY_RESULT(parse_number_attr<float>(node, "cutoff"));
+    }
+    return light;
+}
+
+auto parse_lights(rapidxml::xml_node<> const* const node) noexcept
+    -> cpp::result<std::vector<render::Light>, ParseErr>
+try {
+    auto lights = std::vector<render::Light>{};
+    for (auto const* light_node = node->first_node("light");
+        light_node != nullptr;
+        light_node = light_node->next_sibling("light")
+    ) {
+        lights.push_back(TRY_RESULT(parse_light(light_node)));
+    }
+    return lights;
+
+} catch (std::bad_alloc const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+} catch (std::length_error const&) {
+    return cpp::fail(ParseErr::NO_MEM);
+}
+
+} // namespace engine::parse::xml
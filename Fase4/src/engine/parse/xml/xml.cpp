@@ -2,6 +2,7 @@
 
 #include "engine/parse/xml/camera/camera.hpp"
 #include "engine/parse/xml/group/group.hpp"
+#include "engine/parse/xml/lights/lights.hpp"
 #include "util/try.hpp"
 
 #include <exception>
@@ -56,10 +57,14 @@ auto parse_xml(char const* const xml_filepath) noexcept
         return cpp::fail(ParseErr::NO_GROUP_NODE);
     );
 
+    auto world = TRY_RESULT(parse_group(group_node));
+    // Optional, the scene is drawn unlit without them.
+    if (auto const* const lights_node = world_node->first_node("lights")) {
+        world.lights = TRY_RESULT(parse_lights(lights_node));
+    }
+
     return std::pair {
-        render::World {
-            .root =  TRY_RESULT(parse_group(group_node))
-        },
+        std::move(world),
         render::Camera {
             TRY_RESULT(parse_camera(camera_node))
         },
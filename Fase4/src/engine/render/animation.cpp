@@ -0,0 +1,187 @@
+#include "engine/render/animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+// Sine and cosine of a whole number of turns plus `turns`.
+// Branch-free polynomials so the loops calling this can be vectorized,
+// unlike with std::sin and std::cos.
+auto static sin_cos_turns(float const turns, float& sin, float& cos) noexcept
+    -> void
+{
+    auto constexpr two_pi = 6.28318530718f;
+
+    // Reduced to [-pi, pi], where the truncated Taylor series are accurate to
+    // around 1e-6.
+    auto const x = two_pi * (turns - std::nearbyint(turns));
+    auto const x2 = x * x;
+
+    sin = x * (1.f + x2 * (-1.f / 6.f + x2 * (1.f / 120.f
+        + x2 * (-1.f / 5040.f + x2 * (1.f / 362880.f
+        + x2 * (-1.f / 39916800.f + x2 * (1.f / 6227020800.f
+        + x2 * (-1.f / 1307674368000.f))))))));
+
+    cos = 1.f + x2 * (-1.f / 2.f + x2 * (1.f / 24.f
+        + x2 * (-1.f / 720.f + x2 * (1.f / 40320.f
+        + x2 * (-1.f / 3628800.f + x2 * (1.f / 479001600.f
+        + x2 * (-1.f / 87178291200.f + x2 * (1.f / 20922789888000.f))))))));
+}
+
+auto add_rotation(Animations& animations, Rotate const& rotate) -> u32 {
+    auto const index = static_cast<u32>(animations.rotation_freqs.size());
+    auto const axis = glm::normalize(
+        glm::vec3{rotate.rotate[1], rotate.rotate[2], rotate.rotate[3]}
+    );
+
+    animations.rotation_freqs.push_back(1.f / (rotate.rotate[0] * 1000.f));
+    animations.rotation_axis_x.push_back(axis.x);
+    animations.rotation_axis_y.push_back(axis.y);
+    animations.rotation_axis_z.push_back(axis.z);
+    animations.rotation_matrices.emplace_back(1.f);
+    animations.rotation_sin.push_back(0.f);
+    animations.rotation_cos.push_back(1.f);
+
+    return index;
+}
+
+auto add_curve(Animations& animations, DynamicTranslate const& translate)
+    -> u32
+{
+    auto const index = static_cast<u32>(animations.curve_freqs.size());
+    auto const segments_begin = animations.curve_segments.size();
+
+    compile_catmull_rom(translate.points, animations.curve_segments);
+
+    animations.curve_segments_begin.push_back(static_cast<u32>(segments_begin));
+    animations.curve_num_segments.push_back(
+        static_cast<u32>(animations.curve_segments.size() - segments_begin)
+    );
+    animations.curve_freqs.push_back(
+        1.f / (static_cast<float>(translate.time) * 1000.f)
+    );
+    animations.curve_align.push_back(translate.align);
+    animations.curve_up_x.push_back(0.f);
+    animations.curve_up_y.push_back(1.f);
+    animations.curve_up_z.push_back(0.f);
+    animations.curve_matrices.emplace_back(1.f);
+    animations.curve_segment.push_back(0);
+    animations.curve_t.push_back(0.f);
+
+    return index;
+}
+
+auto curve_segments(Animations const& animations, u32 const curve) noexcept
+    -> std::span<CatmullRomSegment const>
+{
+    return std::span {
+        animations.curve_segments.data()
+            + animations.curve_segments_begin[curve],
+        animations.curve_num_segments[curve],
+    };
+}
+
+auto animate_rotations(
+    Animations& animations,
+    float const time_ms,
+    usize const begin,
+    usize const end
+) noexcept -> void {
+    auto const* const freqs = animations.rotation_freqs.data();
+    auto* const sines = animations.rotation_sin.data();
+    auto* const cosines = animations.rotation_cos.data();
+
+    for (auto i = begin; i < end; ++i) {
+        sin_cos_turns(time_ms * freqs[i], sines[i], cosines[i]);
+    }
+
+    auto const* const axis_x = animations.rotation_axis_x.data();
+    auto const* const axis_y = animations.rotation_axis_y.data();
+    auto const* const axis_z = animations.rotation_axis_z.data();
+    auto* const matrices = animations.rotation_matrices.data();
+
+    // Same layout as glm::rotate.
+    for (auto i = begin; i < end; ++i) {
+        auto const s = sines[i];
+        auto const c = cosines[i];
+        auto const x = axis_x[i];
+        auto const y = axis_y[i];
+        auto const z = axis_z[i];
+        auto const tx = (1.f - c) * x;
+        auto const ty = (1.f - c) * y;
+        auto const tz = (1.f - c) * z;
+
+        auto& m = matrices[i];
+        m[0][0] = c + tx * x;
+        m[0][1] = tx * y + s * z;
+        m[0][2] = tx * z - s * y;
+        m[1][0] = ty * x - s * z;
+        m[1][1] = c + ty * y;
+        m[1][2] = ty * z + s * x;
+        m[2][0] = tz * x + s * y;
+        m[2][1] = tz * y - s * x;
+        m[2][2] = c + tz * z;
+    }
+}
+
+auto animate_curves(
+    Animations& animations,
+    float const time_ms,
+    usize const begin,
+    usize const end
+) noexcept -> void {
+    auto const* const freqs = animations.curve_freqs.data();
+    auto const* const num_segments = animations.curve_num_segments.data();
+    auto* const segment = animations.curve_segment.data();
+    auto* const curve_t = animations.curve_t.data();
+
+    for (auto i = begin; i < end; ++i) {
+        auto const gt = time_ms * freqs[i];
+        auto const t
+            = (gt - std::floor(gt)) * static_cast<float>(num_segments[i]);
+        auto const s = std::min(static_cast<u32>(t), num_segments[i] - 1);
+        segment[i] = s;
+        curve_t[i] = t - static_cast<float>(s);
+    }
+
+    auto const* const segments = animations.curve_segments.data();
+    auto const* const segments_begin = animations.curve_segments_begin.data();
+    auto const* const align = animations.curve_align.data();
+    auto* const up_x = animations.curve_up_x.data();
+    auto* const up_y = animations.curve_up_y.data();
+    auto* const up_z = animations.curve_up_z.data();
+    auto* const matrices = animations.curve_matrices.data();
+
+    for (auto i = begin; i < end; ++i) {
+        auto const [pos, deriv] = eval_catmull_rom_segment(
+            segments[segments_begin[i] + segment[i]], curve_t[i]
+        );
+
+        auto& m = matrices[i];
+        m[3] = glm::vec4{pos, 1.f};
+
+        if (align[i]) {
+            // Each curve keeps its own up vector between frames.
+            auto const x = glm::normalize(deriv);
+            auto const z
+                = glm::normalize(glm::cross(x, glm::vec3{up_x[i], up_y[i], up_z[i]}));
+            auto const y = glm::normalize(glm::cross(z, x));
+            up_x[i] = y.x;
+            up_y[i] = y.y;
+            up_z[i] = y.z;
+
+            m[0] = glm::vec4{x, 0.f};
+            m[1] = glm::vec4{y, 0.f};
+            m[2] = glm::vec4{z, 0.f};
+        }
+    }
+}
+
+} // namespace engine::render
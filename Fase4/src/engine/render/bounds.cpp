@@ -0,0 +1,147 @@
+#include "engine/render/bounds.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+namespace engine::render {
+
+// Sphere around an axis aligned box.
+[[nodiscard]]
+auto static box_sphere(glm::vec3 const& min, glm::vec3 const& max) noexcept
+    -> Sphere
+{
+    return {
+        .center = (min + max) * 0.5f,
+        .radius = glm::length(max - min) * 0.5f,
+    };
+}
+
+auto bounding_sphere(std::span<glm::vec3 const> const points) noexcept
+    -> Sphere
+{
+    if (points.empty()) {
+        return EMPTY_SPHERE;
+    }
+
+    auto min = points.front();
+    auto max = points.front();
+    for (auto const& point : points) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    // Centered on the box, but sized to the farthest point, which is usually
+    // tighter than the box's own sphere.
+    auto const center = (min + max) * 0.5f;
+    auto radius_sq = 0.f;
+    for (auto const& point : points) {
+        auto const offset = point - center;
+        radius_sq = std::max(radius_sq, glm::dot(offset, offset));
+    }
+    return {.center = center, .radius = std::sqrt(radius_sq)};
+}
+
+auto bounding_sphere(std::span<CatmullRomSegment const> const curve) noexcept
+    -> Sphere
+{
+    if (curve.empty()) {
+        return EMPTY_SPHERE;
+    }
+
+    auto min = curve.front()[3];
+    auto max = curve.front()[3];
+    auto const include = [&](CatmullRomSegment const& segment, float const t) {
+        auto const pos = eval_catmull_rom_segment(segment, t).pos;
+        min = glm::min(min, pos);
+        max = glm::max(max, pos);
+    };
+
+    // Each segment's extremes are at its ends or where an axis of the
+    // derivative, 3a*t^2 + 2b*t + c, is zero.
+    for (auto const& segment : curve) {
+        auto const& [a, b, c, d] = segment;
+        include(segment, 0.f);
+        include(segment, 1.f);
+        for (auto axis = 0; axis < 3; ++axis) {
+            auto const qa = 3.f * a[axis];
+            auto const qb = 2.f * b[axis];
+            auto const qc = c[axis];
+            auto const include_root = [&](float const t) {
+                if (t > 0.f and t < 1.f) {
+                    include(segment, t);
+                }
+            };
+
+            if (std::abs(qa) < 1e-12f) {
+                if (std::abs(qb) >= 1e-12f) {
+                    include_root(-qc / qb);
+                }
+                continue;
+            }
+            auto const discriminant = qb * qb - 4.f * qa * qc;
+            if (discriminant < 0.f) {
+                continue;
+            }
+            auto const sqrt_discriminant = std::sqrt(discriminant);
+            include_root((-qb + sqrt_discriminant) / (2.f * qa));
+            include_root((-qb - sqrt_discriminant) / (2.f * qa));
+        }
+    }
+
+    return box_sphere(min, max);
+}
+
+auto merge(Sphere const& lhs, Sphere const& rhs) noexcept -> Sphere {
+    if (lhs.radius < 0.f) {
+        return rhs;
+    }
+    if (rhs.radius < 0.f) {
+        return lhs;
+    }
+
+    auto const offset = rhs.center - lhs.center;
+    auto const distance = glm::length(offset);
+    if (distance + rhs.radius <= lhs.radius) {
+        return lhs;
+    }
+    if (distance + lhs.radius <= rhs.radius) {
+        return rhs;
+    }
+
+    auto const radius = (distance + lhs.radius + rhs.radius) * 0.5f;
+    return {
+        .center = lhs.center + offset * ((radius - lhs.radius) / distance),
+        .radius = radius,
+    };
+}
+
+auto transform(Sphere const& sphere, glm::mat4 const& matrix) noexcept
+    -> Sphere
+{
+    if (sphere.radius < 0.f) {
+        return sphere;
+    }
+
+    // The largest stretch is the square root of the largest eigenvalue of
+    // the columns' Gram matrix, which Gershgorin bounds by its largest row
+    // sum. Exact when the columns are orthogonal.
+    auto const x = glm::vec3{matrix[0]};
+    auto const y = glm::vec3{matrix[1]};
+    auto const z = glm::vec3{matrix[2]};
+    auto const xy = std::abs(glm::dot(x, y));
+    auto const xz = std::abs(glm::dot(x, z));
+    auto const yz = std::abs(glm::dot(y, z));
+    auto const scale_sq = std::max({
+        glm::dot(x, x) + xy + xz,
+        glm::dot(y, y) + xy + yz,
+        glm::dot(z, z) + xz + yz,
+    });
+    return {
+        .center = glm::vec3{matrix * glm::vec4{sphere.center, 1.f}},
+        .radius = sphere.radius * std::sqrt(scale_sq),
+    };
+}
+
+} // namespace engine::render
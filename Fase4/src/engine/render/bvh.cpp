@@ -0,0 +1,315 @@
+#include "engine/render/bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto static constexpr MAX_LEAF_ITEMS = 4_u32;
+// Refitting never changes the hierarchy, so it gets looser as things move.
+auto static constexpr MAX_AREA_GROWTH = 2.f;
+
+auto static constexpr INF = std::numeric_limits<float>::infinity();
+
+[[nodiscard]]
+auto static radius(Sphere const& sphere) noexcept -> float {
+    // Empty spheres still get a place in the hierarchy, as a point.
+    return std::max(sphere.radius, 0.f);
+}
+
+[[nodiscard]]
+auto static area(BvhNode const& node) noexcept -> float {
+    auto const size = node.max - node.min;
+    return 2.f * (size.x * size.y + size.x * size.z + size.y * size.z);
+}
+
+auto static fit_leaf(
+    BvhNode& node,
+    std::span<u32 const> items,
+    std::span<Sphere const> spheres
+) noexcept -> void {
+    node.min = glm::vec3{INF};
+    node.max = glm::vec3{-INF};
+    for (auto const item : items) {
+        auto const& sphere = spheres[item];
+        node.min = glm::min(node.min, sphere.center - radius(sphere));
+        node.max = glm::max(node.max, sphere.center + radius(sphere));
+    }
+}
+
+auto build_bvh(Bvh& bvh, std::span<Sphere const> const spheres) noexcept
+    -> void
+{
+    struct PendingNode {
+        u32 node;
+        u32 first;
+        u32 count;
+    };
+
+    auto const num_items = static_cast<u32>(spheres.size());
+    bvh.nodes.clear();
+    bvh.items.resize(num_items);
+    for (auto item = 0_u32; item < num_items; ++item) {
+        bvh.items[item] = item;
+    }
+    bvh.built_area = 0.f;
+    if (num_items == 0) {
+        return;
+    }
+
+    bvh.nodes.push_back({});
+    auto pending = std::vector<PendingNode>{{0, 0, num_items}};
+    while (not pending.empty()) {
+        auto const [node, first, count] = pending.back();
+        pending.pop_back();
+
+        auto const items = std::span{bvh.items}.subspan(first, count);
+        fit_leaf(bvh.nodes[node], items, spheres);
+        bvh.built_area += area(bvh.nodes[node]);
+
+        if (count <= MAX_LEAF_ITEMS) {
+            bvh.nodes[node].first = first;
+            bvh.nodes[node].count = count;
+            continue;
+        }
+
+        // Median split along the longest axis of the centers.
+        auto centers_min = glm::vec3{INF};
+        auto centers_max = glm::vec3{-INF};
+        for (auto const item : items) {
+            centers_min = glm::min(centers_min, spheres[item].center);
+            centers_max = glm::max(centers_max, spheres[item].center);
+        }
+        auto const extent = centers_max - centers_min;
+        auto const axis = extent.x > extent.y
+            ? (extent.x > extent.z ? 0 : 2)
+            : (extent.y > extent.z ? 1 : 2);
+
+        auto const half = count / 2;
+        std::ranges::nth_element(
+            items,
+            items.begin() + half,
+            std::ranges::less{},
+            [&](u32 const item) { return spheres[item].center[axis]; }
+        );
+
+        auto const left = static_cast<u32>(bvh.nodes.size());
+        bvh.nodes.resize(bvh.nodes.size() + 2);
+        bvh.nodes[node].first = left;
+        bvh.nodes[node].count = 0;
+        pending.push_back({left, first, half});
+        pending.push_back({left + 1, first + half, count - half});
+    }
+}
+
+auto refit_bvh(Bvh& bvh, std::span<Sphere const> const spheres) noexcept
+    -> void
+{
+    if (bvh.items.size() != spheres.size()) {
+        build_bvh(bvh, spheres);
+        return;
+    }
+
+    // Children always come after their parent.
+    auto total_area = 0.f;
+    for (auto i = bvh.nodes.size(); i-- > 0;) {
+        auto& node = bvh.nodes[i];
+        if (node.count != 0) {
+            fit_leaf(
+                node,
+                std::span{bvh.items}.subspan(node.first, node.count),
+                spheres
+            );
+        } else {
+            auto const& left = bvh.nodes[node.first];
+            auto const& right = bvh.nodes[node.first + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+        total_area += area(node);
+    }
+
+    if (total_area > bvh.built_area * MAX_AREA_GROWTH) {
+        build_bvh(bvh, spheres);
+    }
+}
+
+// Distance along the ray to where it enters the node, infinite on a miss.
+[[nodiscard]]
+auto static ray_node_distance(
+    BvhNode const& node,
+    glm::vec3 const& origin,
+    glm::vec3 const& inv_direction,
+    float const max_distance
+) noexcept -> float {
+    auto const t0 = (node.min - origin) * inv_direction;
+    auto const t1 = (node.max - origin) * inv_direction;
+    auto const t_min = glm::min(t0, t1);
+    auto const t_max = glm::max(t0, t1);
+    auto const enter = std::max({t_min.x, t_min.y, t_min.z, 0.f});
+    auto const exit = std::min({t_max.x, t_max.y, t_max.z, max_distance});
+    return enter <= exit ? enter : INF;
+}
+
+// Distance along the ray to the sphere, 0 if it starts inside it.
+[[nodiscard]]
+auto static ray_sphere_distance(
+    Sphere const& sphere,
+    glm::vec3 const& origin,
+    glm::vec3 const& direction
+) noexcept -> float {
+    auto const offset = origin - sphere.center;
+    auto const a = glm::dot(direction, direction);
+    auto const b = glm::dot(offset, direction);
+    auto const c = glm::dot(offset, offset) - radius(sphere) * radius(sphere);
+    if (c <= 0.f) {
+        return 0.f;
+    }
+    auto const discriminant = b * b - a * c;
+    if (b > 0.f or discriminant < 0.f) {
+        return INF;
+    }
+    return (-b - std::sqrt(discriminant)) / a;
+}
+
+auto raycast(
+    Bvh const& bvh,
+    std::span<Sphere const> const spheres,
+    glm::vec3 const& origin,
+    glm::vec3 const& direction
+) noexcept -> std::optional<RayHit> {
+    if (bvh.nodes.empty()) {
+        return {};
+    }
+
+    auto const inv_direction = 1.f / direction;
+    auto closest = std::optional<RayHit>{};
+    auto max_distance = INF;
+
+    auto pending = std::vector<u32>{0};
+    while (not pending.empty()) {
+        auto const& node = bvh.nodes[pending.back()];
+        pending.pop_back();
+        if (ray_node_distance(node, origin, inv_direction, max_distance)
+            == INF
+        ) {
+            continue;
+        }
+
+        if (node.count != 0) {
+            for (auto i = node.first; i < node.first + node.count; ++i) {
+                auto const item = bvh.items[i];
+                auto const distance
+                    = ray_sphere_distance(spheres[item], origin, direction);
+                if (distance < max_distance) {
+                    max_distance = distance;
+                    closest = RayHit{.item = item, .distance = distance};
+                }
+            }
+            continue;
+        }
+
+        // Nearest child last, so it's visited first and prunes the other.
+        auto const left = node.first;
+        auto const right = node.first + 1;
+        auto const left_distance = ray_node_distance(
+            bvh.nodes[left], origin, inv_direction, max_distance
+        );
+        auto const right_distance = ray_node_distance(
+            bvh.nodes[right], origin, inv_direction, max_distance
+        );
+        if (left_distance < right_distance) {
+            pending.push_back(right);
+            pending.push_back(left);
+        } else {
+            pending.push_back(left);
+            pending.push_back(right);
+        }
+    }
+
+    return closest;
+}
+
+[[nodiscard]]
+auto static point_node_distance(BvhNode const& node, glm::vec3 const& point)
+    noexcept -> float
+{
+    return glm::length(glm::max(
+        glm::max(node.min - point, point - node.max), glm::vec3{0.f}
+    ));
+}
+
+[[nodiscard]]
+auto static point_sphere_distance(Sphere const& sphere, glm::vec3 const& point)
+    noexcept -> float
+{
+    return std::max(glm::distance(point, sphere.center) - radius(sphere), 0.f);
+}
+
+auto k_nearest(
+    Bvh const& bvh,
+    std::span<Sphere const> const spheres,
+    glm::vec3 const& point,
+    usize const k,
+    std::vector<u32>& nearest
+) noexcept -> void {
+    using Candidate = std::pair<float, u32>; // distance, node or item.
+
+    nearest.clear();
+    if (bvh.nodes.empty() or k == 0) {
+        return;
+    }
+
+    // Best first: nodes by increasing distance, and the best k items so far
+    // with the farthest on top.
+    auto nodes = std::priority_queue<
+        Candidate, std::vector<Candidate>, std::greater<>
+    >{};
+    auto best = std::priority_queue<Candidate>{};
+
+    nodes.emplace(point_node_distance(bvh.nodes[0], point), 0);
+    while (not nodes.empty()) {
+        auto const [distance, index] = nodes.top();
+        nodes.pop();
+        if (best.size() == k and distance >= best.top().first) {
+            break;
+        }
+
+        auto const& node = bvh.nodes[index];
+        if (node.count != 0) {
+            for (auto i = node.first; i < node.first + node.count; ++i) {
+                auto const item = bvh.items[i];
+                auto const item_distance
+                    = point_sphere_distance(spheres[item], point);
+                if (best.size() < k) {
+                    best.emplace(item_distance, item);
+                } else if (item_distance < best.top().first) {
+                    best.pop();
+                    best.emplace(item_distance, item);
+                }
+            }
+        } else {
+            for (auto const child : {node.first, node.first + 1}) {
+                nodes.emplace(
+                    point_node_distance(bvh.nodes[child], point), child
+                );
+            }
+        }
+    }
+
+    nearest.resize(best.size());
+    for (auto i = nearest.size(); i-- > 0;) {
+        nearest[i] = best.top().second;
+        best.pop();
+    }
+}
+
+} // namespace engine::render
@@ -5,7 +5,9 @@
 #include "util/coord_conv.hpp"
 
 #include <algorithm>
+#include <brief_int.hpp>
 #include <glm/geometric.hpp>
+#include <vector>
 
 namespace engine::render {
 
@@ -22,9 +24,77 @@ auto update_camera() noexcept -> void {
             update_camera_follow_mode();
             break;
     }
-    glutPostRedisplay();
-    glutTimerFunc(config::RENDER_TICK_MILLIS, [](int) { update_camera(); }, 0);
+}
+
+auto focus_model_at(
+    glm::vec3 const& origin,
+    glm::vec3 const& direction
+) noexcept -> void {
+    auto const& scene = state::scene;
+    if (auto const hit = raycast(
+            scene.bvh, scene.model_bounds, origin, direction
+        );
+        hit.has_value()
+    ) {
+        state::focused_model = hit->item;
+        state::camera_mode = CameraMode::FOLLOW_MODE;
+    }
+}
 
+auto focus_next_model() noexcept -> void {
+    auto const& scene = state::scene;
+    auto const num_models = static_cast<brief_int::u32>(
+        scene.model_bounds.size()
+    );
+    // Nothing to follow, the camera stays as it is.
+    if (num_models == 0) {
+        return;
+    }
+
+    auto& focused_model = state::focused_model;
+    if (state::camera_mode == CameraMode::FOLLOW_MODE
+        and focused_model != NO_MODEL
+    ) {
+        focused_model = (focused_model + 1) % num_models;
+        return;
+    }
+
+    auto const& camera = *state::camera_ptr;
+    if (auto const hit = raycast(
+            scene.bvh,
+            scene.model_bounds,
+            camera.pos,
+            camera.lookat - camera.pos
+        );
+        hit.has_value()
+    ) {
+        focused_model = hit->item;
+    } else {
+        auto thread_local nearest = std::vector<brief_int::u32>{};
+        k_nearest(scene.bvh, scene.model_bounds, camera.lookat, 1, nearest);
+        if (nearest.empty()) {
+            return;
+        }
+        focused_model = nearest.front();
+    }
+    state::camera_mode = CameraMode::FOLLOW_MODE;
+}
+
+auto track_focused_model() noexcept -> void {
+    auto const focused_model = state::focused_model;
+    if (state::camera_mode != CameraMode::FOLLOW_MODE
+        or focused_model == NO_MODEL
+        or focused_model >= state::scene.model_bounds.size()
+    ) {
+        return;
+    }
+
+    // Moves along with the model, keeping the same point of view.
+    auto& camera = *state::camera_ptr;
+    auto const translation
+        = state::scene.model_bounds[focused_model].center - camera.lookat;
+    camera.pos += translation;
+    camera.lookat += translation;
 }
 
 auto static update_camera_free_mode() noexcept -> void {
@@ -0,0 +1,78 @@
+#include "engine/render/catmull_rom.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto compile_catmull_rom(
+    std::span<glm::vec3 const> const points,
+    std::vector<CatmullRomSegment>& segments
+) -> void {
+    auto const num_points = points.size();
+
+    segments.reserve(segments.size() + num_points);
+
+    for (auto segment = 0_uz; segment < num_points; ++segment) {
+        auto const& p0 = points[(segment + num_points - 1) % num_points];
+        auto const& p1 = points[segment];
+        auto const& p2 = points[(segment + 1) % num_points];
+        auto const& p3 = points[(segment + 2) % num_points];
+
+        // A = M * P, with M the Catmull-Rom matrix.
+        segments.push_back({{
+            -0.5f * p0 + 1.5f * p1 - 1.5f * p2 + 0.5f * p3,
+            p0 - 2.5f * p1 + 2.f * p2 - 0.5f * p3,
+            -0.5f * p0 + 0.5f * p2,
+            p1,
+        }});
+    }
+}
+
+auto eval_catmull_rom_segment(
+    CatmullRomSegment const& segment,
+    float const t
+) noexcept -> CurvePoint {
+    auto const& [a, b, c, d] = segment;
+    return CurvePoint {
+        .pos = ((a * t + b) * t + c) * t + d,
+        .deriv = (3.f * a * t + 2.f * b) * t + c,
+    };
+}
+
+auto eval_catmull_rom(
+    std::span<CatmullRomSegment const> const curve,
+    float const gt
+) noexcept -> CurvePoint {
+    auto const num_segments = curve.size();
+
+    // Only the fractional part matters, which also keeps precision for large
+    // values of `gt`.
+    auto const t = (gt - std::floor(gt)) * static_cast<float>(num_segments);
+    auto const segment = std::min(static_cast<usize>(t), num_segments - 1);
+
+    return eval_catmull_rom_segment(
+        curve[segment], t - static_cast<float>(segment)
+    );
+}
+
+auto catmull_rom_polyline(
+    std::span<CatmullRomSegment const> const curve,
+    usize const num_points
+) -> std::vector<glm::vec3> {
+    auto polyline = std::vector<glm::vec3>{};
+    polyline.reserve(num_points);
+
+    for (auto point = 0_uz; point < num_points; ++point) {
+        auto const gt
+            = static_cast<float>(point) / static_cast<float>(num_points);
+        polyline.push_back(eval_catmull_rom(curve, gt).pos);
+    }
+
+    return polyline;
+}
+
+} // namespace engine::render
@@ -0,0 +1,114 @@
+#include "engine/render/culling.hpp"
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+namespace engine::render {
+
+using namespace brief_int;
+
+auto make_frustum(glm::mat4 const& view_proj) noexcept -> Frustum {
+    // Gribb-Hartmann: each plane is the last row plus or minus another row.
+    auto const m = glm::transpose(view_proj);
+    auto frustum = Frustum {
+        .planes = {
+            m[3] + m[0], // left.
+            m[3] - m[0], // right.
+            m[3] + m[1], // bottom.
+            m[3] - m[1], // top.
+            m[3] + m[2], // near.
+            m[3] - m[2], // far.
+        },
+    };
+    for (auto& plane : frustum.planes) {
+        plane /= glm::length(glm::vec3{plane});
+    }
+    return frustum;
+}
+
+auto classify(Frustum const& frustum, Sphere const& sphere) noexcept
+    -> Visibility
+{
+    if (sphere.radius < 0.f) {
+        return Visibility::OUTSIDE;
+    }
+
+    auto visibility = Visibility::INSIDE;
+    for (auto const& plane : frustum.planes) {
+        auto const distance
+            = glm::dot(glm::vec3{plane}, sphere.center) + plane.w;
+        if (distance < -sphere.radius) {
+            return Visibility::OUTSIDE;
+        }
+        if (distance < sphere.radius) {
+            visibility = Visibility::PARTIAL;
+        }
+    }
+    return visibility;
+}
+
+auto cull_scene(
+    Scene const& scene,
+    World const& world,
+    Frustum const& frustum,
+    std::vector<Draw>& draws,
+    CullStats& stats
+) noexcept -> void {
+    draws.clear();
+    stats = {};
+
+    auto const num_groups = static_cast<u32>(world.group_parents.size());
+    for (auto group = u32{0}; group < num_groups;) {
+        auto const subtree_end = scene.subtree_ends[group];
+        auto const& world_matrix = scene.world_matrices[group];
+
+        // Groups are depth-first, so a subtree's models are contiguous.
+        auto const subtree_models = Range {
+            .begin = world.group_models[group].begin,
+            .end = world.group_models[subtree_end - 1].end,
+        };
+
+        switch (classify(
+            frustum, transform(scene.group_bounds[group], world_matrix)
+        )) {
+            using enum Visibility;
+
+            case OUTSIDE:
+                stats.groups_culled += subtree_end - group;
+                stats.models_culled += subtree_models.end - subtree_models.begin;
+                group = subtree_end;
+                break;
+
+            case INSIDE:
+                stats.groups_visible += subtree_end - group;
+                stats.models_drawn += subtree_models.end - subtree_models.begin;
+                draws.insert(
+                    draws.end(),
+                    scene.draws.begin() + subtree_models.begin,
+                    scene.draws.begin() + subtree_models.end
+                );
+                group = subtree_end;
+                break;
+
+            case PARTIAL: {
+                stats.groups_visible += 1;
+                auto const [models_begin, models_end]
+                    = world.group_models[group];
+                for (auto model = models_begin; model < models_end; ++model) {
+                    if (classify(frustum, scene.model_bounds[model])
+                        == OUTSIDE
+                    ) {
+                        stats.models_culled += 1;
+                    } else {
+                        stats.models_drawn += 1;
+                        draws.push_back(scene.draws[model]);
+                    }
+                }
+                group += 1;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace engine::render
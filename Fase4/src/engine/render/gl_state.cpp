@@ -0,0 +1,216 @@
+#include "engine/render/gl_state.hpp"
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+// Nothing is assumed about the state the context starts with.
+auto constexpr UNKNOWN = std::numeric_limits<GLuint>::max();
+auto constexpr NUM_BUFFER_TARGETS = 3_uz;
+auto constexpr NUM_TEXTURE_TARGETS = 2_uz;
+auto constexpr NUM_TEXTURE_UNITS = 16_uz;
+auto constexpr NOT_CACHED = std::numeric_limits<usize>::max();
+
+struct Cache {
+    std::array<GLuint, NUM_BUFFER_TARGETS> buffers;
+    GLuint vertex_array;
+    GLuint program;
+    GLuint active_unit;
+    std::array<
+        std::array<GLuint, NUM_TEXTURE_TARGETS>,
+        NUM_TEXTURE_UNITS
+    > textures;
+    std::optional<std::pair<GLenum, GLenum>> polygon_mode; // face and mode.
+    std::optional<float> line_width;
+
+    GlCallStats stats;
+};
+
+auto make_cache() noexcept -> Cache {
+    auto cache = Cache {
+        .buffers = {},
+        .vertex_array = UNKNOWN,
+        .program = UNKNOWN,
+        .active_unit = UNKNOWN,
+        .textures = {},
+        .polygon_mode = std::nullopt,
+        .line_width = std::nullopt,
+        .stats = {0, 0, 0, 0},
+    };
+    cache.buffers.fill(UNKNOWN);
+    for (auto& unit : cache.textures) {
+        unit.fill(UNKNOWN);
+    }
+    return cache;
+}
+
+auto cache = make_cache();
+
+auto buffer_index(GLenum const target) noexcept -> usize {
+    switch (target) {
+        case GL_ARRAY_BUFFER:         return 0;
+        case GL_DRAW_INDIRECT_BUFFER: return 1;
+        case GL_PIXEL_UNPACK_BUFFER:  return 2;
+        default:                      return NOT_CACHED;
+    }
+}
+
+auto texture_index(GLenum const target) noexcept -> usize {
+    switch (target) {
+        case GL_TEXTURE_2D:       return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        default:                  return NOT_CACHED;
+    }
+}
+
+// Whether a call setting `cached` to `value` is needed, updating the cache
+// and the counters.
+template <typename T>
+auto update(T& cached, T const& value) noexcept -> bool {
+    if (cached == value) {
+        cache.stats.skipped += 1;
+        return false;
+    }
+    cached = value;
+    cache.stats.calls += 1;
+    return true;
+}
+
+auto count_bind() noexcept -> void {
+    cache.stats.binds += 1;
+}
+
+auto count_draw() noexcept -> void {
+    cache.stats.calls += 1;
+    cache.stats.draws += 1;
+}
+
+} // namespace
+
+auto bind_buffer(GLenum const target, GLuint const buffer) noexcept -> void {
+    auto const index = buffer_index(target);
+    auto uncached = GLuint{UNKNOWN};
+    auto& cached = index == NOT_CACHED ? uncached : cache.buffers[index];
+    if (update(cached, buffer)) {
+        count_bind();
+        glBindBuffer(target, buffer);
+    }
+}
+
+auto bind_vertex_array(GLuint const vertex_array) noexcept -> void {
+    if (update(cache.vertex_array, vertex_array)) {
+        count_bind();
+        glBindVertexArray(vertex_array);
+    }
+}
+
+auto use_program(GLuint const program) noexcept -> void {
+    if (update(cache.program, program)) {
+        count_bind();
+        glUseProgram(program);
+    }
+}
+
+auto bind_texture(
+    GLuint const unit,
+    GLenum const target,
+    GLuint const texture
+) noexcept -> void {
+    auto const index = texture_index(target);
+    auto uncached = GLuint{UNKNOWN};
+    auto& cached = index == NOT_CACHED or unit >= NUM_TEXTURE_UNITS
+        ? uncached
+        : cache.textures[unit][index];
+    if (cached == texture) {
+        cache.stats.skipped += 1;
+        return;
+    }
+
+    if (update(cache.active_unit, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    update(cached, texture);
+    count_bind();
+    glBindTexture(target, texture);
+}
+
+auto set_polygon_mode(GLenum const face, GLenum const mode) noexcept -> void {
+    if (update(cache.polygon_mode, std::optional{std::pair{face, mode}})) {
+        glPolygonMode(face, mode);
+    }
+}
+
+auto set_line_width(float const width) noexcept -> void {
+    if (update(cache.line_width, std::optional{width})) {
+        glLineWidth(width);
+    }
+}
+
+// Deleting a bound object unbinds it, and its name may be bound again before
+// anything else is, so these go back to unknown.
+auto forget_buffer(GLuint const buffer) noexcept -> void {
+    for (auto& cached : cache.buffers) {
+        if (cached == buffer) {
+            cached = UNKNOWN;
+        }
+    }
+}
+
+auto forget_texture(GLuint const texture) noexcept -> void {
+    for (auto& unit : cache.textures) {
+        for (auto& cached : unit) {
+            if (cached == texture) {
+                cached = UNKNOWN;
+            }
+        }
+    }
+}
+
+auto draw_arrays(GLenum const mode, GLint const first, GLsizei const count)
+    noexcept -> void
+{
+    count_draw();
+    glDrawArrays(mode, first, count);
+}
+
+auto draw_arrays_instanced(
+    GLenum const mode,
+    GLint const first,
+    GLsizei const count,
+    GLsizei const instance_count
+) noexcept -> void {
+    count_draw();
+    glDrawArraysInstanced(mode, first, count, instance_count);
+}
+
+auto multi_draw_arrays_indirect(
+    GLenum const mode,
+    usize const offset,
+    GLsizei const draw_count
+) noexcept -> void {
+    count_draw();
+    glMultiDrawArraysIndirect(
+        mode,
+        reinterpret_cast<void const*>(offset),
+        draw_count,
+        0
+    );
+}
+
+auto gl_call_stats() noexcept -> GlCallStats const& {
+    return cache.stats;
+}
+
+auto reset_gl_call_stats() noexcept -> void {
+    cache.stats = {0, 0, 0, 0};
+}
+
+} // namespace engine::render
@@ -0,0 +1,283 @@
+#include "engine/render/gpu_resources.hpp"
+
+#include "engine/config.hpp"
+#include "engine/render/gl_state.hpp"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+struct Resource {
+    GLuint name; // 0 while evicted.
+    GpuCategory category;
+    bool is_texture;
+    usize size;
+    GpuUpload upload;
+    u64 last_used; // frame number.
+    u32 refs; // 0 when the slot is free.
+};
+
+struct Manager {
+    std::vector<Resource> resources;
+    std::vector<u32> free_slots;
+    GpuMemoryStats stats;
+    usize resident; // bytes, over every category.
+    u64 frame;
+    bool abandoned;
+};
+
+auto manager() noexcept -> Manager& {
+    // Never destroyed, so handles in other static objects can still be
+    // released at exit.
+    auto static& lazy_static = *new Manager{};
+    return lazy_static;
+}
+
+auto add_resident(GpuCategory const category, usize const size) noexcept
+    -> void
+{
+    auto& m = manager();
+    auto const index = static_cast<usize>(category);
+    m.stats.current[index] += size;
+    m.stats.peak[index] = std::max(m.stats.peak[index], m.stats.current[index]);
+    m.resident += size;
+}
+
+auto remove_resident(GpuCategory const category, usize const size) noexcept
+    -> void
+{
+    auto& m = manager();
+    m.stats.current[static_cast<usize>(category)] -= size;
+    m.resident -= size;
+}
+
+auto make_resident(Resource& resource) noexcept -> void {
+    if (resource.is_texture) {
+        glGenTextures(1, &resource.name);
+    } else {
+        glGenBuffers(1, &resource.name);
+    }
+    if (resource.upload) {
+        resource.upload(resource.name);
+    }
+    add_resident(resource.category, resource.size);
+}
+
+auto evict(Resource& resource) noexcept -> void {
+    if (resource.is_texture) {
+        forget_texture(resource.name);
+        glDeleteTextures(1, &resource.name);
+    } else {
+        forget_buffer(resource.name);
+        glDeleteBuffers(1, &resource.name);
+    }
+    resource.name = 0;
+    remove_resident(resource.category, resource.size);
+}
+
+auto retain(u32 const slot) noexcept -> void {
+    manager().resources[slot].refs += 1;
+}
+
+auto release(u32 const slot) noexcept -> void {
+    auto& m = manager();
+    auto& resource = m.resources[slot];
+    resource.refs -= 1;
+    if (resource.refs > 0) {
+        return;
+    }
+
+    if (resource.name != 0 and not m.abandoned) {
+        evict(resource);
+    }
+    resource.upload = {};
+    m.free_slots.push_back(slot);
+}
+
+auto constexpr CATEGORY_NAMES
+    = std::array<std::string_view, NUM_GPU_CATEGORIES>{
+        "geometry",
+        "orbits",
+        "streaming",
+        "textures",
+    };
+
+auto constexpr MIB = 1024.0 * 1024.0;
+
+} // namespace
+
+GpuHandle::GpuHandle(u32 const slot) noexcept : slot{slot} {}
+
+GpuHandle::GpuHandle(GpuHandle const& other) noexcept : slot{other.slot} {
+    if (slot != NO_SLOT) {
+        retain(slot);
+    }
+}
+
+GpuHandle::GpuHandle(GpuHandle&& other) noexcept
+    : slot{std::exchange(other.slot, NO_SLOT)} {}
+
+auto GpuHandle::operator=(GpuHandle const& other) noexcept -> GpuHandle& {
+    auto copy = other;
+    std::swap(slot, copy.slot);
+    return *this;
+}
+
+auto GpuHandle::operator=(GpuHandle&& other) noexcept -> GpuHandle& {
+    auto moved = std::move(other);
+    std::swap(slot, moved.slot);
+    return *this;
+}
+
+GpuHandle::~GpuHandle() {
+    if (slot != NO_SLOT) {
+        release(slot);
+    }
+}
+
+auto GpuHandle::get() const noexcept -> GLuint {
+    if (slot == NO_SLOT) {
+        return 0;
+    }
+
+    auto& m = manager();
+    auto& resource = m.resources[slot];
+    resource.last_used = m.frame;
+    if (resource.name == 0 and not m.abandoned) {
+        make_resident(resource);
+    }
+    return resource.name;
+}
+
+auto GpuHandle::set_size(usize const size) const noexcept -> void {
+    if (slot == NO_SLOT) {
+        return;
+    }
+
+    auto& resource = manager().resources[slot];
+    if (resource.name != 0) {
+        remove_resident(resource.category, resource.size);
+        add_resident(resource.category, size);
+    }
+    resource.size = size;
+}
+
+GpuHandle::operator bool() const noexcept {
+    return slot != NO_SLOT;
+}
+
+auto create_gpu_resource(
+    GpuCategory const category,
+    bool const is_texture,
+    usize const size,
+    GpuUpload upload
+) noexcept -> GpuHandle {
+    auto& m = manager();
+
+    auto slot = u32{0};
+    if (m.free_slots.empty()) {
+        slot = static_cast<u32>(m.resources.size());
+        m.resources.emplace_back();
+    } else {
+        slot = m.free_slots.back();
+        m.free_slots.pop_back();
+    }
+
+    auto& resource = m.resources[slot];
+    resource = {
+        .name = 0,
+        .category = category,
+        .is_texture = is_texture,
+        .size = size,
+        .upload = std::move(upload),
+        .last_used = m.frame,
+        .refs = 1,
+    };
+    make_resident(resource);
+    return GpuHandle{slot};
+}
+
+auto create_gpu_buffer(
+    GpuCategory const category,
+    usize const size,
+    GpuUpload upload
+) noexcept -> GpuHandle {
+    return create_gpu_resource(category, false, size, std::move(upload));
+}
+
+auto create_gpu_texture(
+    GpuCategory const category,
+    usize const size,
+    GpuUpload upload
+) noexcept -> GpuHandle {
+    return create_gpu_resource(category, true, size, std::move(upload));
+}
+
+auto begin_gpu_frame() noexcept -> void {
+    auto& m = manager();
+    m.frame += 1;
+    if (m.resident <= config::GPU_MEMORY_BUDGET) {
+        return;
+    }
+
+    // Only what can be uploaded again, and wasn't needed last frame.
+    auto candidates = std::vector<u32>{};
+    for (auto slot = 0_u32; slot < m.resources.size(); ++slot) {
+        auto const& resource = m.resources[slot];
+        if (resource.refs > 0
+            and resource.name != 0
+            and resource.upload
+            and resource.last_used + 1 < m.frame
+        ) {
+            candidates.push_back(slot);
+        }
+    }
+    std::ranges::sort(candidates, {}, [&](u32 const slot) {
+        return m.resources[slot].last_used;
+    });
+
+    auto num_evicted = 0_uz;
+    for (auto const slot : candidates) {
+        if (m.resident <= config::GPU_MEMORY_BUDGET) {
+            break;
+        }
+        evict(m.resources[slot]);
+        num_evicted += 1;
+    }
+    spdlog::debug(
+        "evicted {} GPU resources, {:.1f} MiB resident.",
+        num_evicted,
+        static_cast<double>(m.resident) / MIB
+    );
+}
+
+auto gpu_memory_stats() noexcept -> GpuMemoryStats const& {
+    return manager().stats;
+}
+
+auto log_gpu_memory_stats() noexcept -> void {
+    auto const& stats = manager().stats;
+    for (auto category = 0_uz; category < NUM_GPU_CATEGORIES; ++category) {
+        spdlog::info(
+            "GPU memory, {}: {:.1f} MiB (peak {:.1f} MiB).",
+            CATEGORY_NAMES[category],
+            static_cast<double>(stats.current[category]) / MIB,
+            static_cast<double>(stats.peak[category]) / MIB
+        );
+    }
+}
+
+auto abandon_gpu_resources() noexcept -> void {
+    manager().abandoned = true;
+}
+
+} // namespace engine::render
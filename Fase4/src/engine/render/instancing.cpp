@@ -0,0 +1,55 @@
+#include "engine/render/instancing.hpp"
+
+#include "engine/render/render_queue.hpp"
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto batch_instances(
+    World const& world,
+    Scene const& scene,
+    std::span<TextureSlot const> const texture_slots,
+    std::span<Draw const> const draws,
+    std::span<u64 const> const keys,
+    std::vector<glm::mat4>& instance_matrices,
+    std::vector<u32>& instance_layers,
+    std::vector<InstanceBatch>& batches,
+    std::vector<u32>& batch_texture_arrays
+) noexcept -> void {
+    auto const& mesh_ranges = scene.mesh_ranges;
+
+    batches.clear();
+    batch_texture_arrays.clear();
+    instance_matrices.resize(draws.size());
+    instance_layers.resize(draws.size());
+    auto previous_mesh = 0_u32;
+    for (auto draw = 0_uz; draw < draws.size(); ++draw) {
+        auto const& [matrix, model] = draws[draw];
+        auto const mesh = world.models[model].mesh;
+        auto const slot
+            = find_texture_slot(texture_slots, world.models[model].texture);
+        // Keys only hold the low bits of the mesh and the array, so those
+        // are compared in full too.
+        if (draw == 0
+            or render_state(keys[draw]) != render_state(keys[draw - 1])
+            or mesh != previous_mesh
+            or slot.array != batch_texture_arrays.back()
+        ) {
+            batches.push_back({
+                .count = mesh_ranges[mesh].count,
+                .instance_count = 0,
+                .first = mesh_ranges[mesh].first,
+                .base_instance = static_cast<u32>(draw),
+            });
+            batch_texture_arrays.push_back(slot.array);
+        }
+        previous_mesh = mesh;
+        instance_matrices[draw] = matrix * scene.mesh_dequantization[mesh];
+        instance_layers[draw] = slot.layer;
+        batches.back().instance_count += 1;
+    }
+}
+
+} // namespace engine::render
@@ -6,22 +6,68 @@
 #include <algorithm>
 #include <cctype>
 #include <intrinsics/branching.hpp>
+#include <spdlog/spdlog.h>
 
 namespace engine::render {
 
 auto key_down(unsigned char const key, int, int) noexcept -> void {
+    if (not state::key_events.try_push({.key = key, .pressed = true})) {
+        spdlog::warn("dropped key down event, input queue is full.");
+    }
+}
+
+auto key_up(unsigned char key, int, int) noexcept -> void {
+    if (std::isalpha(key)) {
+        key = static_cast<unsigned char>(tolower(key));
+    }
+    if (not state::key_events.try_push({.key = key, .pressed = false})) {
+        spdlog::warn("dropped key up event, input queue is full.");
+    }
+}
+
+auto mouse_button(
+    int const button,
+    int const button_state,
+    int const x,
+    int const y
+) noexcept -> void {
+    if (button != GLUT_LEFT_BUTTON or button_state != GLUT_DOWN) {
+        return;
+    }
+
+    auto const width = static_cast<float>(glutGet(GLUT_WINDOW_WIDTH));
+    auto const height = static_cast<float>(glutGet(GLUT_WINDOW_HEIGHT));
+    auto const ndc = glm::vec2 {
+        (static_cast<float>(x) + 0.5f) / width * 2.f - 1.f,
+        1.f - (static_cast<float>(y) + 0.5f) / height * 2.f,
+    };
+    if (not state::click_events.try_push({.ndc = ndc})) {
+        spdlog::warn("dropped mouse click, input queue is full.");
+    }
+}
+
+auto handle_key_event(KeyEvent const event) noexcept -> void {
+    auto const key = event.key;
+    if (not event.pressed) {
+        state::keyboard.release(key);
+        return;
+    }
+
     state::keyboard.press(key);
     switch (key) {
         using enum config::KeyboardKeybinds;
 
         case KEY_TOGGLE_AXIS:
             state::enable_axis = not state::enable_axis;
-            glutPostRedisplay();
             break;
 
         case KEY_TOGGLE_LOOKAT_INDICATOR:
             state::enable_lookat_indicator = not state::enable_lookat_indicator;
-            glutPostRedisplay();
+            break;
+
+        case KEY_TOGGLE_OCCLUSION_CULLING:
+            state::enable_occlusion_culling
+                = not state::enable_occlusion_culling;
             break;
 
         case KEY_NEXT_POLYGON_MODE:
@@ -39,7 +85,6 @@ auto key_down(unsigned char const key, int, int) noexcept -> void {
                 default:
                     intrinsics::unreachable();
             }
-            glutPostRedisplay();
             break;
 
         case KEY_THINNER_LINES:
@@ -47,7 +92,6 @@ auto key_down(unsigned char const key, int, int) noexcept -> void {
                 state::line_width - config::LINE_WIDTH_STEP,
                 config::LINE_WIDTH_MIN
             );
-            glutPostRedisplay();
             break;
 
         case KEY_THICKER_LINES:
@@ -55,26 +99,15 @@ auto key_down(unsigned char const key, int, int) noexcept -> void {
                 state::line_width + config::LINE_WIDTH_STEP,
                 config::LINE_WIDTH_MAX
             );
-            glutPostRedisplay();
             break;
 
         case KEY_FOCUS_NEXT_MODEL:
-            switch (state::camera_mode) {
-                using enum CameraMode;
-
-                case FREE_MODE:
-                    state::camera_mode = FOLLOW_MODE;
-                    break;
-
-                case FOLLOW_MODE:
-                    state::camera_mode = FREE_MODE;
-                    break;
-            }
-            glutPostRedisplay();
-        break;
+            focus_next_model();
+            break;
 
         case KEY_EXIT_FOCUS_MODE:
             state::camera_mode = CameraMode::FREE_MODE;
+            state::focused_model = NO_MODEL;
             break;
 
         default:
@@ -82,11 +115,4 @@ auto key_down(unsigned char const key, int, int) noexcept -> void {
     }
 }
 
-auto key_up(unsigned char key, int, int) noexcept -> void {
-    if (std::isalpha(key)) {
-        key = static_cast<unsigned char>(tolower(key));
-    }
-    state::keyboard.release(key);
-}
-
 } // namespace engine::render
@@ -0,0 +1,247 @@
+#include "engine/render/light_clusters.hpp"
+
+#include "engine/config.hpp"
+#include "engine/jobs/job_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <initializer_list>
+#include <limits>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto static constexpr INF = std::numeric_limits<float>::infinity();
+
+// The view distance where slice `slice` begins.
+auto static slice_depth(float const near, float const far, u32 const slice)
+    noexcept -> float
+{
+    auto const t = static_cast<float>(slice)
+        / static_cast<float>(config::LIGHT_CLUSTERS_Z);
+    return near * std::pow(far / near, t);
+}
+
+auto static sphere_touches_box(
+    glm::vec4 const& sphere,
+    glm::vec3 const& min,
+    glm::vec3 const& max
+) noexcept -> bool {
+    auto const center = glm::vec3{sphere};
+    auto const offset = glm::clamp(center, min, max) - center;
+    return glm::dot(offset, offset) <= sphere.w * sphere.w;
+}
+
+// Where the `index`th of `count` equal parts of [-1, 1] begins.
+auto static ndc_edge(u32 const index, u32 const count) noexcept -> float {
+    return 2.f * static_cast<float>(index) / static_cast<float>(count) - 1.f;
+}
+
+// Every cluster's view space bounds: the box around its corners, at the
+// nearest and farthest depth of its slice.
+auto static compute_cluster_bounds(LightClusterGrid& grid) noexcept -> void {
+    auto const size_x = config::LIGHT_CLUSTERS_X;
+    auto const size_y = config::LIGHT_CLUSTERS_Y;
+    auto const size_z = config::LIGHT_CLUSTERS_Z;
+    auto const near = grid.projection.z;
+    auto const far = grid.projection.w;
+    auto const tan_y = std::tan(grid.projection.x * 0.5f);
+    auto const tan_x = tan_y * grid.projection.y;
+
+    grid.cluster_min.resize(usize{size_x} * size_y * size_z);
+    grid.cluster_max.resize(grid.cluster_min.size());
+    grid.row_min.resize(usize{size_y} * size_z);
+    grid.row_max.resize(grid.row_min.size());
+    for (auto z = 0_u32; z < size_z; ++z) {
+        auto const depth_min = slice_depth(near, far, z);
+        auto const depth_max = slice_depth(near, far, z + 1);
+        for (auto y = 0_u32; y < size_y; ++y) {
+            auto const ndc_y0 = ndc_edge(y, size_y);
+            auto const ndc_y1 = ndc_edge(y + 1, size_y);
+            auto const row = usize{z} * size_y + y;
+            grid.row_min[row] = glm::vec3{INF};
+            grid.row_max[row] = glm::vec3{-INF};
+            for (auto x = 0_u32; x < size_x; ++x) {
+                auto const ndc_x0 = ndc_edge(x, size_x);
+                auto const ndc_x1 = ndc_edge(x + 1, size_x);
+                auto min = glm::vec3{INF};
+                auto max = glm::vec3{-INF};
+                for (auto const depth : {depth_min, depth_max}) {
+                    for (auto const ndc_x : {ndc_x0, ndc_x1}) {
+                        for (auto const ndc_y : {ndc_y0, ndc_y1}) {
+                            auto const corner = glm::vec3 {
+                                ndc_x * tan_x * depth,
+                                ndc_y * tan_y * depth,
+                                -depth,
+                            };
+                            min = glm::min(min, corner);
+                            max = glm::max(max, corner);
+                        }
+                    }
+                }
+                auto const cluster = row * size_x + x;
+                grid.cluster_min[cluster] = min;
+                grid.cluster_max[cluster] = max;
+                grid.row_min[row] = glm::min(grid.row_min[row], min);
+                grid.row_max[row] = glm::max(grid.row_max[row], max);
+            }
+        }
+    }
+}
+
+// Narrows the visible lights down to the slice, then to each of its rows,
+// then tests them against each cluster of the row.
+// Offsets into `indices` are left relative to the slice's own indices.
+auto static bin_slice(
+    LightClusterGrid& grid,
+    u32 const z,
+    float const depth_min,
+    float const depth_max,
+    std::span<glm::uvec2> const ranges
+) noexcept -> void {
+    auto const size_x = config::LIGHT_CLUSTERS_X;
+    auto const size_y = config::LIGHT_CLUSTERS_Y;
+    auto& candidates = grid.slice_candidates[z];
+    auto& row_candidates = grid.row_candidates[z];
+    auto& indices = grid.slice_indices[z];
+    candidates.clear();
+    indices.clear();
+
+    for (auto const light : grid.visible_lights) {
+        auto const& sphere = grid.view_lights[light];
+        auto const depth = -sphere.z;
+        if (depth + sphere.w >= depth_min and depth - sphere.w <= depth_max) {
+            candidates.push_back(light);
+        }
+    }
+
+    for (auto y = 0_u32; y < size_y; ++y) {
+        auto const row = usize{z} * size_y + y;
+        row_candidates.clear();
+        for (auto const light : candidates) {
+            if (sphere_touches_box(
+                grid.view_lights[light], grid.row_min[row], grid.row_max[row]
+            )) {
+                row_candidates.push_back(light);
+            }
+        }
+
+        for (auto x = 0_u32; x < size_x; ++x) {
+            auto const cluster = row * size_x + x;
+            auto const begin = static_cast<u32>(indices.size());
+            for (auto const light : row_candidates) {
+                if (sphere_touches_box(
+                    grid.view_lights[light],
+                    grid.cluster_min[cluster],
+                    grid.cluster_max[cluster]
+                )) {
+                    indices.push_back(light);
+                }
+            }
+            ranges[cluster - usize{z} * size_y * size_x] = {
+                begin,
+                static_cast<u32>(indices.size()) - begin,
+            };
+        }
+    }
+}
+
+auto build_light_clusters(
+    LightClusterGrid& grid,
+    std::span<Light const> const lights,
+    glm::mat4 const& view,
+    float const fov_y,
+    float const aspect,
+    float const near,
+    float const far,
+    LightClusters& clusters,
+    LightClusterStats& stats
+) noexcept -> void {
+    auto const size_x = config::LIGHT_CLUSTERS_X;
+    auto const size_y = config::LIGHT_CLUSTERS_Y;
+    auto const size_z = config::LIGHT_CLUSTERS_Z;
+    auto const slice_size = usize{size_x} * size_y;
+
+    auto const projection = glm::vec4{fov_y, aspect, near, far};
+    if (projection != grid.projection or grid.cluster_min.empty()) {
+        grid.projection = projection;
+        compute_cluster_bounds(grid);
+        grid.slice_candidates.resize(size_z);
+        grid.row_candidates.resize(size_z);
+        grid.slice_indices.resize(size_z);
+    }
+    auto const log_ratio = std::log(far / near);
+    clusters.slice_scale = static_cast<float>(size_z) / log_ratio;
+    clusters.slice_bias = -std::log(near) * clusters.slice_scale;
+
+    clusters.lights.clear();
+    grid.view_lights.clear();
+    grid.visible_lights.clear();
+    for (auto light = 0_u32; light < lights.size(); ++light) {
+        auto const& [type, position, direction, color, range, cutoff]
+            = lights[light];
+        auto const is_directional = type == LightType::DIRECTIONAL;
+        clusters.lights.push_back({
+            .position = {position, is_directional ? INF : range},
+            .color = {color, static_cast<float>(type)},
+            .direction = {direction, std::cos(glm::radians(cutoff))},
+        });
+
+        // Centered on the view, directional lights reach every cluster.
+        auto const sphere = is_directional
+            ? glm::vec4{0.f, 0.f, 0.f, INF}
+            : glm::vec4{glm::vec3{view * glm::vec4{position, 1.f}}, range};
+        grid.view_lights.push_back(sphere);
+        auto const depth = -sphere.z;
+        if (depth + sphere.w >= near and depth - sphere.w <= far) {
+            grid.visible_lights.push_back(light);
+        }
+    }
+
+    clusters.ranges.resize(slice_size * size_z);
+    jobs::get().parallel_for(
+        0,
+        size_z,
+        1,
+        [&](usize const begin, usize const end) {
+            for (auto z = static_cast<u32>(begin); z < end; ++z) {
+                bin_slice(
+                    grid,
+                    z,
+                    slice_depth(near, far, z),
+                    slice_depth(near, far, z + 1),
+                    std::span{clusters.ranges}.subspan(
+                        z * slice_size, slice_size
+                    )
+                );
+            }
+        }
+    );
+
+    // Slices are concatenated in order, their offsets moved along.
+    clusters.indices.clear();
+    stats.max_per_cluster = 0;
+    for (auto z = 0_u32; z < size_z; ++z) {
+        auto const base = static_cast<u32>(clusters.indices.size());
+        auto const& indices = grid.slice_indices[z];
+        clusters.indices.insert(
+            clusters.indices.end(), indices.begin(), indices.end()
+        );
+        for (auto cluster = z * slice_size; cluster < (z + 1) * slice_size;
+            ++cluster
+        ) {
+            clusters.ranges[cluster].x += base;
+            stats.max_per_cluster
+                = std::max(stats.max_per_cluster, clusters.ranges[cluster].y);
+        }
+    }
+    stats.lights = static_cast<u32>(grid.visible_lights.size());
+    stats.indices = static_cast<u32>(clusters.indices.size());
+}
+
+} // namespace engine::render
@@ -0,0 +1,20 @@
+#include "engine/render/mesh_arena.hpp"
+
+namespace engine::render {
+
+using namespace brief_int;
+
+auto layout_mesh_arena(World const& world) -> std::vector<ArenaRange> {
+    auto ranges = std::vector<ArenaRange>{};
+    ranges.reserve(world.meshes.size());
+
+    auto first = u32{0};
+    for (auto const& mesh : world.meshes) {
+        auto const count = static_cast<u32>(mesh.vertices.size());
+        ranges.push_back({.first = first, .count = count});
+        first += count;
+    }
+    return ranges;
+}
+
+} // namespace engine::render
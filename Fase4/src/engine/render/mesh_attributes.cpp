@@ -0,0 +1,457 @@
+#include "engine/render/mesh_attributes.hpp"
+
+#include "engine/config.hpp"
+#include "engine/jobs/job_system.hpp"
+#include "util/cache_file.hpp"
+#include "util/hash.hpp"
+#include "util/mapped_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <brief_int.hpp>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+#include <vector>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+// Bumped whenever generation or the layout change.
+auto constexpr VERSION = 2_u32;
+auto constexpr MAGIC = 0x5254414d_u32; // "MATR".
+auto constexpr CACHE_SUFFIX = ".mesh_cache";
+
+// Followed by the normals, if generated, then the tangents, if any.
+struct FileHeader {
+    util::CacheHeader cache;
+    u64 num_vertices;
+    u32 has_normals;
+    u32 has_tangents;
+};
+
+// Corners, one per vertex of the triangle list, grouped by the position
+// they share once welded.
+struct Adjacency {
+    std::vector<u32> welded; // per corner.
+    std::vector<u32> begin; // per position, into `corners`, and one past.
+    std::vector<u32> corners;
+};
+
+// What's generated depends only on these, so they make up the key.
+auto attributes_key(Mesh const& mesh) noexcept -> u64 {
+    auto hash = util::hash_value(util::FNV_OFFSET_BASIS, VERSION);
+    hash = util::hash_value(hash, config::NORMAL_WELD_TOLERANCE);
+    hash = util::hash_value(hash, config::NORMAL_CREASE_ANGLE);
+    hash = util::hash_bytes(hash, std::as_bytes(std::span{mesh.vertices}));
+    hash = util::hash_bytes(hash, std::as_bytes(std::span{mesh.normals}));
+    return util::hash_bytes(hash, std::as_bytes(std::span{mesh.texcoords}));
+}
+
+auto num_corners(Mesh const& mesh) noexcept -> usize {
+    return mesh.vertices.size() / 3 * 3;
+}
+
+// Each corner joins the first position within the weld tolerance of it,
+// looked up in the cells around it on a grid as fine as the tolerance, so
+// points close to either side of a cell boundary still meet.
+// The grid is relative to the mesh's center so it stays fine far from the
+// origin.
+auto weld(Mesh const& mesh) -> Adjacency {
+    struct CellHash {
+        auto operator()(glm::ivec3 const& cell) const noexcept -> usize {
+            return static_cast<usize>(cell.x) * 73856093_uz
+                ^ static_cast<usize>(cell.y) * 19349663_uz
+                ^ static_cast<usize>(cell.z) * 83492791_uz;
+        }
+    };
+    auto constexpr NO_POSITION = std::numeric_limits<u32>::max();
+
+    auto const size = std::max(
+        mesh.bounds.radius * config::NORMAL_WELD_TOLERANCE,
+        std::numeric_limits<float>::min()
+    );
+    auto const corners = num_corners(mesh);
+    // Each cell's positions, as a list threaded through `next_in_cell`.
+    auto cells = std::unordered_map<glm::ivec3, u32, CellHash>{};
+    cells.reserve(corners);
+    auto positions = std::vector<glm::vec3>{};
+    auto next_in_cell = std::vector<u32>{};
+
+    auto adjacency = Adjacency{};
+    adjacency.welded.resize(corners);
+    for (auto corner = 0_uz; corner < corners; ++corner) {
+        auto const point = mesh.vertices[corner] - mesh.bounds.center;
+        auto const cell = glm::ivec3{glm::floor(point / size)};
+
+        auto found = NO_POSITION;
+        for (auto z = -1; z <= 1 and found == NO_POSITION; ++z) {
+            for (auto y = -1; y <= 1 and found == NO_POSITION; ++y) {
+                for (auto x = -1; x <= 1 and found == NO_POSITION; ++x) {
+                    auto const it = cells.find(cell + glm::ivec3{x, y, z});
+                    if (it == cells.end()) {
+                        continue;
+                    }
+                    for (auto position = it->second;
+                        position != NO_POSITION;
+                        position = next_in_cell[position]
+                    ) {
+                        if (glm::distance(positions[position], point)
+                            <= size
+                        ) {
+                            found = position;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (found == NO_POSITION) {
+            found = static_cast<u32>(positions.size());
+            auto const [it, inserted] = cells.try_emplace(cell, NO_POSITION);
+            positions.push_back(point);
+            next_in_cell.push_back(it->second);
+            it->second = found;
+        }
+        adjacency.welded[corner] = found;
+    }
+
+    // Counting sort of the corners by position.
+    adjacency.begin.assign(positions.size() + 1, 0);
+    for (auto const position : adjacency.welded) {
+        adjacency.begin[position + 1] += 1;
+    }
+    for (auto position = 0_uz; position < positions.size(); ++position) {
+        adjacency.begin[position + 1] += adjacency.begin[position];
+    }
+    adjacency.corners.resize(corners);
+    auto next = std::vector<u32>{
+        adjacency.begin.begin(), adjacency.begin.end() - 1
+    };
+    for (auto corner = 0_u32; corner < corners; ++corner) {
+        adjacency.corners[next[adjacency.welded[corner]]++] = corner;
+    }
+    return adjacency;
+}
+
+// Each corner's angle, in radians.
+auto corner_angles(Mesh const& mesh) -> std::vector<float> {
+    auto angles = std::vector<float>(num_corners(mesh));
+    for (auto corner = 0_uz; corner < angles.size(); ++corner) {
+        auto const first = corner / 3 * 3;
+        auto const& vertex = mesh.vertices[corner];
+        auto const a = mesh.vertices[first + (corner + 1) % 3] - vertex;
+        auto const b = mesh.vertices[first + (corner + 2) % 3] - vertex;
+        auto const lengths = glm::length(a) * glm::length(b);
+        angles[corner] = lengths > 0.f
+            ? std::acos(std::clamp(glm::dot(a, b) / lengths, -1.f, 1.f))
+            : 0.f;
+    }
+    return angles;
+}
+
+// Normals that don't point anywhere are as good as none.
+auto is_degenerate(glm::vec3 const& normal) noexcept -> bool {
+    return glm::dot(normal, normal) == 0.f;
+}
+
+// Only fills in the normals that are missing or degenerate, authored ones
+// are kept.
+auto generate_normals(
+    Mesh& mesh,
+    Adjacency const& adjacency,
+    std::span<float const> const angles
+) -> void {
+    auto const corners = num_corners(mesh);
+    // Unnormalized, so their length weighs in each face's area.
+    auto faces = std::vector<glm::vec3>(corners / 3);
+    auto unit_faces = std::vector<glm::vec3>(faces.size());
+    for (auto face = 0_uz; face < faces.size(); ++face) {
+        auto const* const vertices = mesh.vertices.data() + 3 * face;
+        faces[face] = glm::cross(
+            vertices[1] - vertices[0], vertices[2] - vertices[0]
+        );
+        auto const length = glm::length(faces[face]);
+        unit_faces[face] = length > 0.f ? faces[face] / length : glm::vec3{};
+    }
+
+    auto const min_cos = std::cos(glm::radians(config::NORMAL_CREASE_ANGLE));
+    // Any trailing vertices that don't make a triangle stay unlit.
+    if (mesh.normals.size() != mesh.vertices.size()) {
+        mesh.normals.assign(mesh.vertices.size(), glm::vec3{0.f});
+    }
+    for (auto corner = 0_uz; corner < corners; ++corner) {
+        if (not is_degenerate(mesh.normals[corner])) {
+            continue;
+        }
+        auto const& unit_face = unit_faces[corner / 3];
+        auto const position = adjacency.welded[corner];
+        auto sum = glm::vec3{0.f};
+        for (auto i = adjacency.begin[position];
+            i < adjacency.begin[position + 1];
+            ++i
+        ) {
+            auto const other = adjacency.corners[i];
+            if (glm::dot(unit_face, unit_faces[other / 3]) >= min_cos) {
+                sum += faces[other / 3] * angles[other];
+            }
+        }
+        auto const length = glm::length(sum);
+        mesh.normals[corner] = length > 0.f ? sum / length : unit_face;
+    }
+}
+
+// Any unit vector perpendicular to `normal`.
+auto perpendicular(glm::vec3 const& normal) noexcept -> glm::vec3 {
+    auto const axis = std::abs(normal.x) < 0.9f
+        ? glm::vec3{1.f, 0.f, 0.f}
+        : glm::vec3{0.f, 1.f, 0.f};
+    return glm::normalize(glm::cross(normal, axis));
+}
+
+// Like MikkTSpace: each face's tangent, projected onto the plane of each
+// corner's normal, is averaged by angle with the corners sharing its
+// position, normal, texcoord and texture orientation, then made orthogonal
+// to the normal.
+auto generate_tangents(
+    Mesh& mesh,
+    Adjacency const& adjacency,
+    std::span<float const> const angles
+) -> void {
+    auto const corners = num_corners(mesh);
+    auto faces = std::vector<glm::vec3>(corners / 3);
+    // Whether the texture is mirrored on the face.
+    auto mirrored = std::vector<bool>(faces.size());
+    for (auto face = 0_uz; face < faces.size(); ++face) {
+        auto const* const vertices = mesh.vertices.data() + 3 * face;
+        auto const* const texcoords = mesh.texcoords.data() + 3 * face;
+        auto const edge1 = vertices[1] - vertices[0];
+        auto const edge2 = vertices[2] - vertices[0];
+        auto const delta1 = texcoords[1] - texcoords[0];
+        auto const delta2 = texcoords[2] - texcoords[0];
+        auto const area = delta1.x * delta2.y - delta2.x * delta1.y;
+        mirrored[face] = area < 0.f;
+        faces[face] = area != 0.f
+            ? (edge1 * delta2.y - edge2 * delta1.y) / area
+            : glm::vec3{0.f};
+    }
+
+    mesh.tangents.assign(mesh.vertices.size(), glm::vec4{0.f});
+    for (auto corner = 0_uz; corner < corners; ++corner) {
+        auto const& normal = mesh.normals[corner];
+        if (is_degenerate(normal)) {
+            continue;
+        }
+        auto const face = corner / 3;
+        auto const position = adjacency.welded[corner];
+        auto sum = glm::vec3{0.f};
+        for (auto i = adjacency.begin[position];
+            i < adjacency.begin[position + 1];
+            ++i
+        ) {
+            auto const other = adjacency.corners[i];
+            auto const& other_normal = mesh.normals[other];
+            if (glm::dot(normal, other_normal) < 0.9999f
+                or mesh.texcoords[other] != mesh.texcoords[corner]
+                or mirrored[other / 3] != mirrored[face]
+            ) {
+                continue;
+            }
+            auto const& tangent = faces[other / 3];
+            auto const projected
+                = tangent - other_normal * glm::dot(other_normal, tangent);
+            auto const length = glm::length(projected);
+            if (length > 0.f) {
+                sum += projected / length * angles[other];
+            }
+        }
+
+        auto tangent = sum - normal * glm::dot(normal, sum);
+        auto const length = glm::length(tangent);
+        tangent = length > 0.f ? tangent / length : perpendicular(normal);
+        mesh.tangents[corner]
+            = glm::vec4{tangent, mirrored[face] ? -1.f : 1.f};
+    }
+}
+
+auto cache_path(std::string const& file) -> std::filesystem::path {
+    auto path = std::filesystem::path{file};
+    path += CACHE_SUFFIX;
+    return path;
+}
+
+// Whether `mesh` got everything it needed from the cache.
+auto read_cached_attributes(
+    Mesh& mesh,
+    std::string const& file,
+    u64 const key,
+    bool const needs_normals,
+    bool const needs_tangents
+) noexcept -> bool
+try {
+    auto const mapping = util::MappedFile::open(cache_path(file).string());
+    if (not mapping.has_value()) {
+        return false;
+    }
+    auto const bytes = mapping->bytes();
+
+    auto header = FileHeader{};
+    if (bytes.size() < sizeof(header)
+        or not util::matches_cache_header(bytes, {MAGIC, VERSION, key})
+    ) {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    auto const num_vertices = mesh.vertices.size();
+    auto const normals_size = header.has_normals != 0
+        ? sizeof(glm::vec3) * num_vertices
+        : 0;
+    auto const tangents_size = header.has_tangents != 0
+        ? sizeof(glm::vec4) * num_vertices
+        : 0;
+    if (header.num_vertices != num_vertices
+        or (header.has_normals != 0) != needs_normals
+        or (header.has_tangents != 0) != needs_tangents
+        or bytes.size() != sizeof(header) + normals_size + tangents_size
+    ) {
+        return false;
+    }
+
+    auto const* data = bytes.data() + sizeof(header);
+    if (needs_normals) {
+        mesh.normals.resize(num_vertices);
+        std::memcpy(mesh.normals.data(), data, normals_size);
+        data += normals_size;
+    }
+    if (needs_tangents) {
+        mesh.tangents.resize(num_vertices);
+        std::memcpy(mesh.tangents.data(), data, tangents_size);
+    }
+    return true;
+
+} catch (...) {
+    return false;
+}
+
+// Best effort, failures are only logged.
+auto write_cached_attributes(
+    Mesh const& mesh,
+    std::string const& file,
+    u64 const key,
+    bool const has_normals
+) noexcept -> void
+try {
+    auto const header = FileHeader {
+        .cache = {.magic = MAGIC, .version = VERSION, .key = key},
+        .num_vertices = mesh.vertices.size(),
+        .has_normals = has_normals,
+        .has_tangents = not mesh.tangents.empty(),
+    };
+    auto const chunks = std::array {
+        std::as_bytes(std::span{&header, 1}),
+        has_normals
+            ? std::as_bytes(std::span{mesh.normals})
+            : std::span<std::byte const>{},
+        std::as_bytes(std::span{mesh.tangents}),
+    };
+    if (not util::write_file_atomically(cache_path(file), chunks)) {
+        spdlog::debug("couldn't cache attributes of {}.", file);
+    }
+
+} catch (std::exception const& e) {
+    spdlog::debug("couldn't cache attributes of {}: {}.", file, e.what());
+}
+
+enum class Outcome {
+    COMPLETE,
+    CACHED,
+    GENERATED,
+};
+
+auto prepare_mesh(Mesh& mesh, std::string const& file) -> Outcome {
+    auto const needs_normals = mesh.normals.size() != mesh.vertices.size()
+        or std::ranges::any_of(mesh.normals, is_degenerate);
+    auto const needs_tangents = not mesh.texcoords.empty();
+    if (not needs_normals and not needs_tangents) {
+        return Outcome::COMPLETE;
+    }
+
+    auto const key = attributes_key(mesh);
+    if (read_cached_attributes(
+        mesh, file, key, needs_normals, needs_tangents
+    )) {
+        return Outcome::CACHED;
+    }
+
+    auto const adjacency = weld(mesh);
+    auto const angles = corner_angles(mesh);
+    if (needs_normals) {
+        generate_normals(mesh, adjacency, angles);
+    }
+    if (needs_tangents) {
+        generate_tangents(mesh, adjacency, angles);
+    }
+    write_cached_attributes(mesh, file, key, needs_normals);
+    return Outcome::GENERATED;
+}
+
+} // namespace
+
+auto generate_mesh_attributes(
+    std::span<Mesh> const meshes,
+    std::span<std::string const> const files
+) noexcept -> void {
+    auto cached = std::atomic<usize>{0};
+    auto generated = std::atomic<usize>{0};
+    jobs::get().parallel_for(
+        0,
+        meshes.size(),
+        1,
+        [&](usize const begin, usize const end) {
+            for (auto mesh = begin; mesh < end; ++mesh) {
+                try {
+                    switch (prepare_mesh(meshes[mesh], files[mesh])) {
+                        case Outcome::COMPLETE:
+                            break;
+                        case Outcome::CACHED:
+                            cached.fetch_add(1, std::memory_order_relaxed);
+                            break;
+                        case Outcome::GENERATED:
+                            generated.fetch_add(1, std::memory_order_relaxed);
+                            break;
+                    }
+                } catch (std::exception const& e) {
+                    spdlog::warn(
+                        "no normals or tangents for {}: {}.",
+                        files[mesh],
+                        e.what()
+                    );
+                }
+            }
+        }
+    );
+    spdlog::info(
+        "mesh attributes: {} generated, {} cached, out of {} meshes.",
+        generated.load(std::memory_order_relaxed),
+        cached.load(std::memory_order_relaxed),
+        meshes.size()
+    );
+}
+
+} // namespace engine::render
@@ -0,0 +1,382 @@
+#include "engine/render/occlusion.hpp"
+
+#include "engine/config.hpp"
+#include "engine/jobs/job_system.hpp"
+#include "util/downsample.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <span>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto static constexpr FAR_DEPTH = 1.f;
+auto static constexpr BAND_ROWS = 8_u32;
+auto static constexpr TEST_GRAIN = 64_uz;
+
+auto static init_levels(OcclusionBuffer& buffer) noexcept -> void {
+    auto width = config::OCCLUSION_BUFFER_WIDTH;
+    auto height = config::OCCLUSION_BUFFER_HEIGHT;
+    while (true) {
+        buffer.level_widths.push_back(width);
+        buffer.level_heights.push_back(height);
+        buffer.levels.emplace_back(usize{width} * height, FAR_DEPTH);
+        if (width == 1 and height == 1) {
+            break;
+        }
+        width = std::max(width / 2, 1_u32);
+        height = std::max(height / 2, 1_u32);
+    }
+}
+
+// The draws covering the most of the screen, within the triangle budget.
+auto static select_occluders(
+    OcclusionBuffer& buffer,
+    World const& world,
+    std::span<Sphere const> const model_bounds,
+    glm::mat4 const& view,
+    std::span<Draw const> const draws
+) noexcept -> void {
+    auto& occluders = buffer.occluders;
+    occluders.clear();
+    for (auto draw = 0_u32; draw < draws.size(); ++draw) {
+        auto const& mesh = world.meshes[world.models[draws[draw].model].mesh];
+        auto const num_vertices = mesh.vertices.size();
+        if (num_vertices != 0
+            and num_vertices / 3 <= config::OCCLUSION_MAX_OCCLUDER_TRIANGLES
+        ) {
+            occluders.push_back(draw);
+        }
+    }
+
+    auto const screen_size = [&](u32 const draw) {
+        auto const& bounds = model_bounds[draws[draw].model];
+        auto const distance = -(view * glm::vec4{bounds.center, 1.f}).z;
+        return bounds.radius / std::max(distance, 1e-3f);
+    };
+    auto const num_occluders
+        = std::min(occluders.size(), config::OCCLUSION_MAX_OCCLUDERS);
+    std::ranges::partial_sort(
+        occluders,
+        occluders.begin() + static_cast<std::ptrdiff_t>(num_occluders),
+        std::ranges::greater{},
+        screen_size
+    );
+    occluders.resize(num_occluders);
+}
+
+// Transforms the occluders' vertices to screen space, one job per occluder.
+auto static transform_occluders(
+    OcclusionBuffer& buffer,
+    World const& world,
+    glm::mat4 const& view_proj,
+    std::span<Draw const> const draws
+) noexcept -> void {
+    auto const& occluders = buffer.occluders;
+    auto& vertices_begin = buffer.occluder_vertices_begin;
+    vertices_begin.resize(occluders.size() + 1);
+    vertices_begin[0] = 0;
+    for (auto i = 0_uz; i < occluders.size(); ++i) {
+        auto const model = draws[occluders[i]].model;
+        auto const& mesh = world.meshes[world.models[model].mesh];
+        // Whole triangles only, so they never straddle two occluders.
+        vertices_begin[i + 1] = vertices_begin[i]
+            + static_cast<u32>(mesh.vertices.size() / 3 * 3);
+    }
+    buffer.vertices.resize(vertices_begin.back());
+
+    auto const width = static_cast<float>(buffer.level_widths[0]);
+    auto const height = static_cast<float>(buffer.level_heights[0]);
+    jobs::get().parallel_for(
+        0,
+        occluders.size(),
+        1,
+        [&](usize const begin, usize const end) {
+            for (auto i = begin; i < end; ++i) {
+                auto const& [matrix, model] = draws[occluders[i]];
+                auto const mvp = view_proj * matrix;
+                auto* out = buffer.vertices.data() + vertices_begin[i];
+                auto const& mesh = world.meshes[world.models[model].mesh];
+                auto const vertices = std::span{mesh.vertices}
+                    .first(vertices_begin[i + 1] - vertices_begin[i]);
+                for (auto const& vertex : vertices) {
+                    auto const clip = mvp * glm::vec4{vertex, 1.f};
+                    // Nearer than the near plane, or behind the eye, its
+                    // triangles are left out rather than clipped, which
+                    // only ever occludes less.
+                    if (clip.w < 1e-5f or clip.z < -clip.w) {
+                        *out++ = glm::vec3{
+                            std::numeric_limits<float>::quiet_NaN()
+                        };
+                        continue;
+                    }
+                    auto const ndc = glm::vec3{clip} / clip.w;
+                    *out++ = {
+                        (ndc.x * 0.5f + 0.5f) * width,
+                        (ndc.y * 0.5f + 0.5f) * height,
+                        ndc.z * 0.5f + 0.5f,
+                    };
+                }
+            }
+        }
+    );
+}
+
+// Writes the closest depth of every front facing triangle in [row_begin,
+// row_end).
+auto static rasterize_band(
+    OcclusionBuffer& buffer,
+    u32 const row_begin,
+    u32 const row_end
+) noexcept -> void {
+    auto const width = buffer.level_widths[0];
+    auto* const depth = buffer.levels[0].data();
+    std::fill(
+        depth + usize{row_begin} * width,
+        depth + usize{row_end} * width,
+        FAR_DEPTH
+    );
+
+    auto const& vertices = buffer.vertices;
+    for (auto i = 0_uz; i + 2 < vertices.size(); i += 3) {
+        auto const& v0 = vertices[i];
+        auto const& v1 = vertices[i + 1];
+        auto const& v2 = vertices[i + 2];
+
+        // Also false for NaNs, so clipped triangles are skipped.
+        auto const area
+            = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (not (area > 0.f)) {
+            continue;
+        }
+
+        auto const min = glm::min(glm::min(v0, v1), v2);
+        auto const max = glm::max(glm::max(v0, v1), v2);
+        auto const x_begin = static_cast<u32>(std::max(min.x, 0.f));
+        auto const x_end = static_cast<u32>(std::clamp(
+            std::ceil(max.x), 0.f, static_cast<float>(width)
+        ));
+        auto const y_begin = std::max(
+            static_cast<u32>(std::max(min.y, 0.f)), row_begin
+        );
+        auto const y_end = std::min(
+            static_cast<u32>(std::max(std::ceil(max.y), 0.f)), row_end
+        );
+        if (x_begin >= x_end or y_begin >= y_end or min.z > FAR_DEPTH) {
+            continue;
+        }
+
+        // Edge functions a*x + b*y + c, positive inside, and the depth plane.
+        auto const edge = [](glm::vec3 const& from, glm::vec3 const& to) {
+            auto const a = from.y - to.y;
+            auto const b = to.x - from.x;
+            return glm::vec3{a, b, -(a * from.x + b * from.y)};
+        };
+        auto const e12 = edge(v1, v2);
+        auto const e20 = edge(v2, v0);
+        auto const e01 = edge(v0, v1);
+        auto const dz1 = (v1.z - v0.z) / area;
+        auto const dz2 = (v2.z - v0.z) / area;
+        auto const z_plane = glm::vec3{0.f, 0.f, v0.z} + e20 * dz1 + e01 * dz2;
+
+        for (auto y = y_begin; y < y_end; ++y) {
+            auto const py = static_cast<float>(y) + 0.5f;
+            auto const row_e12 = e12.y * py + e12.z;
+            auto const row_e20 = e20.y * py + e20.z;
+            auto const row_e01 = e01.y * py + e01.z;
+            auto const row_z = z_plane.y * py + z_plane.z;
+            auto* const row = depth + usize{y} * width;
+
+            // Branch free, so it's vectorized.
+            for (auto x = x_begin; x < x_end; ++x) {
+                auto const px = static_cast<float>(x) + 0.5f;
+                auto const inside = (row_e12 + e12.x * px >= 0.f)
+                    & (row_e20 + e20.x * px >= 0.f)
+                    & (row_e01 + e01.x * px >= 0.f);
+                auto const z = row_z + z_plane.x * px;
+                row[x] = inside ? std::min(row[x], z) : row[x];
+            }
+        }
+    }
+}
+
+// Each texel keeps the farthest depth under it, the last row and column
+// taking in the leftover ones of odd sized levels.
+auto static build_pyramid(OcclusionBuffer& buffer) noexcept -> void {
+    for (auto level = 1_uz; level < buffer.levels.size(); ++level) {
+        auto const& below = buffer.levels[level - 1];
+        auto const below_width = buffer.level_widths[level - 1];
+        auto const below_height = buffer.level_heights[level - 1];
+        auto& current = buffer.levels[level];
+        auto const width = buffer.level_widths[level];
+        auto const height = buffer.level_heights[level];
+
+        for (auto y = 0_u32; y < height; ++y) {
+            auto const [y_begin, y_end]
+                = util::downsample_footprint(y, height, below_height);
+            for (auto x = 0_u32; x < width; ++x) {
+                auto const [x_begin, x_end]
+                    = util::downsample_footprint(x, width, below_width);
+                auto farthest = std::numeric_limits<float>::lowest();
+                for (auto below_y = y_begin; below_y < y_end; ++below_y) {
+                    auto const row = usize{below_y} * below_width;
+                    for (auto below_x = x_begin; below_x < x_end; ++below_x) {
+                        farthest = std::max(farthest, below[row + below_x]);
+                    }
+                }
+                current[usize{y} * width + x] = farthest;
+            }
+        }
+    }
+}
+
+// Whether everything in `bounds` is behind what's already in the buffer.
+[[nodiscard]]
+auto static occluded(
+    OcclusionBuffer const& buffer,
+    Sphere const& bounds,
+    glm::mat4 const& view,
+    glm::mat4 const& proj
+) noexcept -> bool {
+    auto const center = glm::vec3{view * glm::vec4{bounds.center, 1.f}};
+    auto const nearest_z = center.z + bounds.radius;
+    // Too close to the camera to tell.
+    if (-nearest_z < 1e-3f) {
+        return false;
+    }
+    auto const nearest_clip = proj * glm::vec4{0.f, 0.f, nearest_z, 1.f};
+    auto const nearest_depth = nearest_clip.z / nearest_clip.w * 0.5f + 0.5f;
+
+    // Screen rectangle of the box around the sphere.
+    auto rect_min = glm::vec2{std::numeric_limits<float>::max()};
+    auto rect_max = glm::vec2{std::numeric_limits<float>::lowest()};
+    for (auto corner = 0; corner < 8; ++corner) {
+        auto const offset = glm::vec3 {
+            (corner & 1) != 0 ? bounds.radius : -bounds.radius,
+            (corner & 2) != 0 ? bounds.radius : -bounds.radius,
+            (corner & 4) != 0 ? bounds.radius : -bounds.radius,
+        };
+        auto const clip = proj * glm::vec4{center + offset, 1.f};
+        auto const ndc = glm::vec2{clip} / clip.w;
+        rect_min = glm::min(rect_min, ndc);
+        rect_max = glm::max(rect_max, ndc);
+    }
+
+    auto const width = static_cast<float>(buffer.level_widths[0]);
+    auto const height = static_cast<float>(buffer.level_heights[0]);
+    auto const x_begin = static_cast<u32>(std::clamp(
+        (rect_min.x * 0.5f + 0.5f) * width, 0.f, width - 1.f
+    ));
+    auto const x_last = static_cast<u32>(std::clamp(
+        (rect_max.x * 0.5f + 0.5f) * width, 0.f, width - 1.f
+    ));
+    auto const y_begin = static_cast<u32>(std::clamp(
+        (rect_min.y * 0.5f + 0.5f) * height, 0.f, height - 1.f
+    ));
+    auto const y_last = static_cast<u32>(std::clamp(
+        (rect_max.y * 0.5f + 0.5f) * height, 0.f, height - 1.f
+    ));
+
+    // Coarse enough that the rectangle covers at most 3x3 texels.
+    auto const extent = std::max(x_last - x_begin, y_last - y_begin);
+    auto const level = std::min(
+        static_cast<usize>(std::bit_width(extent / 2)),
+        buffer.levels.size() - 1
+    );
+    auto const& depth = buffer.levels[level];
+    auto const level_width = buffer.level_widths[level];
+    auto const level_height = buffer.level_heights[level];
+
+    // Texels past the last one of an odd sized level were folded into it.
+    auto const level_y_begin = std::min(y_begin >> level, level_height - 1);
+    auto const level_y_last = std::min(y_last >> level, level_height - 1);
+    auto const level_x_begin = std::min(x_begin >> level, level_width - 1);
+    auto const level_x_last = std::min(x_last >> level, level_width - 1);
+    for (auto y = level_y_begin; y <= level_y_last; ++y) {
+        for (auto x = level_x_begin; x <= level_x_last; ++x) {
+            if (nearest_depth <= depth[usize{y} * level_width + x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto cull_occluded(
+    OcclusionBuffer& buffer,
+    World const& world,
+    std::span<Sphere const> const model_bounds,
+    glm::mat4 const& view,
+    glm::mat4 const& proj,
+    std::vector<Draw>& draws,
+    OcclusionStats& stats
+) noexcept -> void {
+    stats = {};
+    if (buffer.levels.empty()) {
+        init_levels(buffer);
+    }
+
+    auto& job_system = jobs::get();
+
+    select_occluders(buffer, world, model_bounds, view, draws);
+    transform_occluders(buffer, world, proj * view, draws);
+
+    auto const height = buffer.level_heights[0];
+    job_system.parallel_for(
+        0,
+        (height + BAND_ROWS - 1) / BAND_ROWS,
+        1,
+        [&](usize const begin, usize const end) {
+            for (auto band = begin; band < end; ++band) {
+                auto const row_begin = static_cast<u32>(band) * BAND_ROWS;
+                rasterize_band(
+                    buffer, row_begin, std::min(row_begin + BAND_ROWS, height)
+                );
+            }
+        }
+    );
+    build_pyramid(buffer);
+
+    // Occluders are always drawn.
+    auto& visible = buffer.visible;
+    visible.assign(draws.size(), 0);
+    for (auto const occluder : buffer.occluders) {
+        visible[occluder] = 1;
+    }
+
+    job_system.parallel_for(
+        0,
+        draws.size(),
+        TEST_GRAIN,
+        [&](usize const begin, usize const end) {
+            for (auto draw = begin; draw < end; ++draw) {
+                if (visible[draw] == 0) {
+                    visible[draw] = not occluded(
+                        buffer, model_bounds[draws[draw].model], view, proj
+                    );
+                }
+            }
+        }
+    );
+
+    auto kept = 0_uz;
+    for (auto draw = 0_uz; draw < draws.size(); ++draw) {
+        if (visible[draw] != 0) {
+            draws[kept++] = draws[draw];
+        }
+    }
+
+    stats.occluders = static_cast<u32>(buffer.occluders.size());
+    stats.tested = static_cast<u32>(draws.size() - buffer.occluders.size());
+    stats.occluded = static_cast<u32>(draws.size() - kept);
+    draws.resize(kept);
+}
+
+} // namespace engine::render
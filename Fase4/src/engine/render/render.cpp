@@ -4,60 +4,90 @@
 #include "engine/render/render.hpp"
 
 #include "engine/config.hpp"
-#include "engine/render/layout/world/group/group.hpp"
-#include "engine/render/layout/world/group/model.hpp"
-#include "engine/render/layout/world/group/transform/transform.hpp"
-#include "engine/render/layout/world/group/transform/rotate.hpp"
+#include "engine/render/culling.hpp"
+#include "engine/render/frame.hpp"
+#include "engine/render/gl_state.hpp"
+#include "engine/render/gpu_resources.hpp"
 #include "engine/render/state.hpp"
-#include "generator/primitives/box.hpp"
-
+#include "engine/render/texture_loader.hpp"
+
+#include <atomic>
+#include <brief_int.hpp>
+#include <fmt/core.h>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/trigonometric.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <vector>
 
-#include "util/overload.hpp"
+namespace engine::render {
 
-int iii = 0;
+using namespace brief_int::literals;
 
-namespace engine::render {
+// Matrices of the frame being drawn.
+struct ViewMatrices {
+    glm::mat4 view;
+    glm::mat4 view_proj;
+};
 
-auto static render_axis() noexcept -> void;
-auto static render_lookat_indicator() noexcept -> void;
-auto static render_group(Group const& root) noexcept -> void;
+auto static render_axis(ViewMatrices const& matrices) noexcept -> void;
+auto static render_lookat_indicator(
+    ViewMatrices const& matrices,
+    glm::vec3 const& lookat
+) noexcept -> void;
+auto static render_world(Frame const& frame, ViewMatrices const& matrices)
+    noexcept -> void;
+auto static update_window_title(
+    Frame const& frame,
+    GlCallStats const& gl_stats
+) noexcept -> void;
 
 
 auto render() noexcept -> void {
-    auto const& camera = *state::camera_ptr;
+    // The simulation thread is already producing the next frame while this
+    // one is drawn.
+    auto const& frame = state::frames.acquire();
+    auto const& camera = frame.camera;
+    begin_gpu_frame();
+    reset_gl_call_stats();
+    stream_textures(frame.texture_array_sizes, state::viewport_height);
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-    glLoadIdentity();
-
-    // TODO: Use glm transforms instead of GLUT to avoid casting.
-
-    // glMultMatrixf(
-    //     glm::value_ptr(
-    //         glm::lookAt(camera.pos, camera.lookat, camera.up)
-    //     )
-    // );
-    // glTranslatef(-camera.pos.x, -camera.pos.y, -camera.pos.z);
-
-#   define DBL(x) static_cast<double>(x)
-    gluLookAt(
-        DBL(camera.pos.x),    DBL(camera.pos.y),    DBL(camera.pos.z),
-        DBL(camera.lookat.x), DBL(camera.lookat.y), DBL(camera.lookat.z),
-        DBL(camera.up.x),     DBL(camera.up.y),     DBL(camera.up.z)
+
+    auto const proj = glm::perspective(
+        glm::radians(camera.projection[0]),
+        state::aspect_ratio.load(std::memory_order_relaxed),
+        camera.projection[1],
+        camera.projection[2]
     );
-#   undef DBL
+    auto const view = glm::lookAt(camera.pos, camera.lookat, camera.up);
+    auto const matrices = ViewMatrices {
+        .view = view,
+        .view_proj = proj * view,
+    };
+    if (state::core_profile) {
+        // Front only polygon modes are gone from the core profile, back
+        // faces are culled anyway.
+        set_polygon_mode(GL_FRONT_AND_BACK, frame.polygon_mode);
+    } else {
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(glm::value_ptr(proj));
+        glMatrixMode(GL_MODELVIEW);
+        set_polygon_mode(GL_FRONT, frame.polygon_mode);
+    }
 
-    glPolygonMode(GL_FRONT, state::polygon_mode);
-    glLineWidth(state::line_width);
-    if (state::enable_axis) {
-        render_axis();
+    set_line_width(frame.line_width);
+    if (frame.enable_axis) {
+        render_axis(matrices);
     }
-    if (state::enable_lookat_indicator) {
-        render_lookat_indicator();
+    if (frame.enable_lookat_indicator) {
+        render_lookat_indicator(matrices, camera.lookat);
     }
-    render_group(state::world_ptr->root);
-    iii = 0;
+    render_world(frame, matrices);
     glutSwapBuffers();
+    update_window_title(frame, gl_call_stats());
 }
 
 auto resize(int const width, int height) noexcept -> void {
@@ -66,216 +96,395 @@ auto resize(int const width, int height) noexcept -> void {
         height = 1;
     }
 
-    auto const& camera_proj = state::camera_ptr->projection;
-
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glViewport(0, 0, width, height);
-    gluPerspective(
-        static_cast<double>(camera_proj[0]),
-        static_cast<double>(width) / static_cast<double>(height),
-        static_cast<double>(camera_proj[1]),
-        static_cast<double>(camera_proj[2])
+    // The projection itself is computed every frame.
+    state::aspect_ratio.store(
+        static_cast<float>(width) / static_cast<float>(height),
+        std::memory_order_relaxed
     );
-    glMatrixMode(GL_MODELVIEW);
-}
-
-auto static render_axis() noexcept -> void {
-    glBegin(GL_LINES);
-
-    // x axis.
-    glColor3fv(glm::value_ptr(config::AXIS_COLOR[0]));
-    glVertex3f(-config::X_AXIS_HALF_LEN, 0.f, 0.f);
-    glVertex3f(config::X_AXIS_HALF_LEN, 0.f, 0.f);
-
-    // y axis.
-    glColor3fv(glm::value_ptr(config::AXIS_COLOR[1]));
-    glVertex3f(0.f, -config::Y_AXIS_HALF_LEN, 0.f);
-    glVertex3f(0.f, config::Y_AXIS_HALF_LEN, 0.f);
-
-    // z axis.
-    glColor3fv(glm::value_ptr(config::AXIS_COLOR[2]));
-    glVertex3f(0.f, 0.f, -config::Z_AXIS_HALF_LEN);
-    glVertex3f(0.f, 0.f, config::Z_AXIS_HALF_LEN);
-
-    glEnd();
-
-    glColor3fv(glm::value_ptr(config::DEFAULT_FG_COLOR));
+    state::viewport_height = static_cast<float>(height);
+    glViewport(0, 0, width, height);
 }
 
-auto static render_lookat_indicator() noexcept -> void {
-    auto static const lookat_model = ::generator::generate_box(0.5f, 1).value();
-    glColor3fv(glm::value_ptr(config::LOOKAT_INDICATOR_COLOR));
-    auto const& translate = state::camera_ptr->lookat;
-    glPushMatrix();
-    glTranslatef(translate.x, translate.y, translate.z);
-    glBegin(GL_TRIANGLES);
-    for (auto const& vertex : lookat_model) {
-        glVertex3fv(glm::value_ptr(vertex));
+// Draws plain float positions out of `buffer` in a single color, through
+// whichever path is in use.
+auto static draw_simple(
+    ViewMatrices const& matrices,
+    glm::mat4 const& model,
+    glm::vec4 const& color,
+    GLuint const buffer,
+    GLenum const mode,
+    GLint const first,
+    GLsizei const count
+) noexcept -> void {
+    if (state::core_profile) {
+        use_program(state::simple_program);
+        glUniformMatrix4fv(
+            state::simple_mvp_location,
+            1,
+            GL_FALSE,
+            glm::value_ptr(matrices.view_proj * model)
+        );
+        glUniform4fv(state::simple_color_location, 1, glm::value_ptr(color));
+        bind_vertex_array(state::simple_vao);
+        bind_buffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        draw_arrays(mode, first, count);
+    } else {
+        glLoadMatrixf(glm::value_ptr(matrices.view * model));
+        glColor4fv(glm::value_ptr(color));
+        bind_buffer(GL_ARRAY_BUFFER, buffer);
+        glVertexPointer(3, GL_FLOAT, 0, nullptr);
+        draw_arrays(mode, first, count);
+        glColor4fv(glm::value_ptr(config::DEFAULT_FG_COLOR));
     }
-    glEnd();
-    glPopMatrix();
-    glColor3fv(glm::value_ptr(config::DEFAULT_FG_COLOR));
 }
 
-void buildRotMatrix(float *x, float *y, float *z, float *m) {
-
-    m[0] = x[0]; m[1] = x[1]; m[2] = x[2]; m[3] = 0;
-    m[4] = y[0]; m[5] = y[1]; m[6] = y[2]; m[7] = 0;
-    m[8] = z[0]; m[9] = z[1]; m[10] = z[2]; m[11] = 0;
-    m[12] = 0; m[13] = 0; m[14] = 0; m[15] = 1;
+auto static render_axis(ViewMatrices const& matrices) noexcept -> void {
+    // One line per axis: x, y and z.
+    auto const buffer = state::axis_buffer.get();
+    for (auto axis = 0_uz; axis < config::AXIS_COLOR.size(); ++axis) {
+        draw_simple(
+            matrices,
+            glm::mat4{1.f},
+            glm::vec4{config::AXIS_COLOR[axis], 1.f},
+            buffer,
+            GL_LINES,
+            static_cast<GLint>(2 * axis),
+            2
+        );
+    }
 }
 
-void cross(float *a, float *b, float *res) {
-
-    res[0] = a[1]*b[2] - a[2]*b[1];
-    res[1] = a[2]*b[0] - a[0]*b[2];
-    res[2] = a[0]*b[1] - a[1]*b[0];
+auto static render_lookat_indicator(
+    ViewMatrices const& matrices,
+    glm::vec3 const& lookat
+) noexcept -> void {
+    draw_simple(
+        matrices,
+        glm::translate(glm::mat4{1.f}, lookat),
+        glm::vec4{config::LOOKAT_INDICATOR_COLOR, 1.f},
+        state::lookat_indicator_buffer.get(),
+        GL_TRIANGLES,
+        0,
+        static_cast<GLsizei>(state::lookat_indicator_num_vertices)
+    );
 }
 
-void normalize(float *a) {
+// Streams the frame's light clusters and points the buffer textures at
+// them. Returns whether there are any lights at all.
+auto static bind_light_clusters(Frame const& frame) noexcept -> bool {
+    auto const& clusters = frame.light_clusters;
+    if (clusters.lights.empty()) {
+        return false;
+    }
 
-    float l = sqrt(a[0]*a[0] + a[1] * a[1] + a[2] * a[2]);
-    a[0] = a[0]/l;
-    a[1] = a[1]/l;
-    a[2] = a[2]/l;
-}
+    // Each part stays aligned to its own texel size.
+    auto& ring = state::light_ring;
+    auto const lights_size = sizeof(GpuLight) * clusters.lights.size();
+    auto const ranges_size = sizeof(glm::uvec2) * clusters.ranges.size();
+    auto const indices_size
+        = sizeof(brief_int::u32) * clusters.indices.size();
+    auto const region = begin_stream_frame(
+        ring, lights_size + ranges_size + indices_size
+    );
+    stream_write(ring, 0, clusters.lights.data(), lights_size);
+    stream_write(ring, lights_size, clusters.ranges.data(), ranges_size);
+    stream_write(
+        ring,
+        lights_size + ranges_size,
+        clusters.indices.data(),
+        indices_size
+    );
 
-void multMatrixVector(float *m, float *v, float *res) {
-    for (int j = 0; j < 4; ++j) {
-        res[j] = 0;
-        for (int k = 0; k < 4; ++k) {
-            res[j] += v[k] * m[j * 4 + k];
-        }
-    }
-}
+    auto const buffer = ring.buffer.get();
+    auto const attach = [&](
+        GLuint const unit,
+        GpuHandle const& texture,
+        GLenum const format
+    ) {
+        bind_texture(unit, GL_TEXTURE_BUFFER, texture.get());
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    };
+    attach(1, state::light_texture, GL_RGBA32F);
+    attach(2, state::light_range_texture, GL_RG32UI);
+    attach(3, state::light_index_texture, GL_R32UI);
+    glUniform3i(
+        state::instanced_light_bases_location,
+        static_cast<GLint>(region / sizeof(glm::vec4)),
+        static_cast<GLint>((region + lights_size) / sizeof(glm::uvec2)),
+        static_cast<GLint>(
+            (region + lights_size + ranges_size) / sizeof(brief_int::u32)
+        )
+    );
 
-void getCatmullRomPoint(float t, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float *pos, float *deriv) {
-    // catmull-rom matrix
-    float m[4][4] = {    {-0.5f,  1.5f, -1.5f,  0.5f},
-                        { 1.0f, -2.5f,  2.0f, -0.5f},
-                        {-0.5f,  0.0f,  0.5f,  0.0f},
-                        { 0.0f,  1.0f,  0.0f,  0.0f}};
-            
-    // Compute A = M * P
-    float A[3][4];
-    for (int i = 0; i < 3; i++) {
-        float pp[4] = { p0[i],p1[i],p2[i],p3[i] };
-        multMatrixVector(*m, pp, A[i]);
-    
-    // Compute pos = T * A
-        pos[i] = t * t * t * A[i][0] + t * t * A[i][1] + t * A[i][2] + A[i][3];
-
-    // compute deriv = T' * A
-        deriv[i] = 3 * t * t * A[i][0] + 2 * t * A[i][1] + A[i][2];
-    }
+    auto const grid = glm::ivec3 {
+        config::LIGHT_CLUSTERS_X,
+        config::LIGHT_CLUSTERS_Y,
+        config::LIGHT_CLUSTERS_Z,
+    };
+    auto const viewport = glm::vec2 {
+        state::viewport_height
+            * state::aspect_ratio.load(std::memory_order_relaxed),
+        state::viewport_height,
+    };
+    glUniform3iv(
+        state::instanced_cluster_grid_location, 1, glm::value_ptr(grid)
+    );
+    glUniform2fv(
+        state::instanced_cluster_scale_location,
+        1,
+        glm::value_ptr(glm::vec2{grid} / viewport)
+    );
+    glUniform2f(
+        state::instanced_slice_params_location,
+        clusters.slice_scale,
+        clusters.slice_bias
+    );
+    glUniform1f(state::instanced_ambient_location, config::AMBIENT_LIGHT);
+    return true;
 }
 
-// given  global t, returns the point in the curve
-void getGlobalCatmullRomPoint(float gt,std::vector<glm::vec3> p, float *pos, float *deriv) {
-    float t = gt * p.size(); // this is the real global t
-    int index = floor(t);  // which segment
-    t = t - index; // where within  the segment
+// One multi-draw per texture array, or one call per batch without it, with
+// the models' matrices and texture layers as per-instance attributes.
+auto static render_instanced(Frame const& frame, ViewMatrices const& matrices)
+    noexcept -> void
+{
+    auto static constexpr MATRIX_ATTRIB = 1_u32; // 4 columns from here on.
+    auto static constexpr TEXCOORD_ATTRIB = 5_u32;
+    auto static constexpr LAYER_ATTRIB = 6_u32;
+    auto static constexpr NORMAL_ATTRIB = 7_u32;
+
+    use_program(state::instanced_program);
+    glUniformMatrix4fv(
+        state::instanced_view_proj_location,
+        1,
+        GL_FALSE,
+        glm::value_ptr(matrices.view_proj)
+    );
+    glUniformMatrix4fv(
+        state::instanced_view_location,
+        1,
+        GL_FALSE,
+        glm::value_ptr(matrices.view)
+    );
+    glUniform4fv(
+        state::instanced_color_location,
+        1,
+        glm::value_ptr(config::DEFAULT_FG_COLOR)
+    );
 
-    // indices store the points
-    int indices[4]; 
-    indices[0] = (index + p.size()-1)%p.size();    
-    indices[1] = (indices[0]+1)%p.size();
-    indices[2] = (indices[1]+1)%p.size(); 
-    indices[3] = (indices[2]+1)%p.size();
+    // Buffers may have been evicted and uploaded again under another name,
+    // so the pointers are set again every frame.
+    bind_vertex_array(state::mesh_vao);
+    auto const& layout = state::vertex_layout;
+    glEnableVertexAttribArray(0);
+    bind_buffer(GL_ARRAY_BUFFER, state::mesh_arena.get());
+    glVertexAttribPointer(
+        0,
+        3,
+        layout.position_format == PositionFormat::HALF
+            ? GL_HALF_FLOAT
+            : GL_FLOAT,
+        GL_FALSE,
+        static_cast<GLsizei>(layout.stride),
+        nullptr
+    );
 
-    getCatmullRomPoint(t, p[indices[0]], p[indices[1]], p[indices[2]], p[indices[3]], pos, deriv);
-}
+    // Meshes without texcoords sample a single texel.
+    auto const normalized = layout.texcoord_format == TexcoordFormat::UNORM16;
+    if (layout.has_texcoords) {
+        glEnableVertexAttribArray(TEXCOORD_ATTRIB);
+        glVertexAttribPointer(
+            TEXCOORD_ATTRIB,
+            2,
+            normalized ? GL_UNSIGNED_SHORT : GL_FLOAT,
+            normalized ? GL_TRUE : GL_FALSE,
+            static_cast<GLsizei>(layout.stride),
+            reinterpret_cast<void const*>(
+                static_cast<brief_int::usize>(layout.texcoord_offset)
+            )
+        );
+    } else {
+        glDisableVertexAttribArray(TEXCOORD_ATTRIB);
+        glVertexAttrib2f(TEXCOORD_ATTRIB, 0.f, 0.f);
+    }
+    glUniform2fv(
+        state::instanced_texcoord_min_location,
+        1,
+        glm::value_ptr(normalized ? layout.texcoord_min : glm::vec2{0.f})
+    );
+    glUniform2fv(
+        state::instanced_texcoord_scale_location,
+        1,
+        glm::value_ptr(normalized ? layout.texcoord_scale : glm::vec2{1.f})
+    );
 
-void renderCatmullRomCurve(std::vector<glm::vec3> points) {
-    float pos[3];
-    float deriv[3];
-// draw curve using line segments with GL_LINE_LOOP
-    glBegin(GL_LINE_LOOP);
-    for (int i = 0; i <= 100; i += 1) {
-        getGlobalCatmullRomPoint(i*0.01,points,pos, deriv);
-        glVertex3f(pos[0], pos[1], pos[2]);
+    // Zero normals, and meshes without any, are left unlit.
+    auto const octahedral = layout.normal_format == NormalFormat::OCTAHEDRAL;
+    if (layout.has_normals) {
+        glEnableVertexAttribArray(NORMAL_ATTRIB);
+        glVertexAttribPointer(
+            NORMAL_ATTRIB,
+            octahedral ? 2 : 4,
+            octahedral ? GL_SHORT : GL_INT_2_10_10_10_REV,
+            GL_TRUE,
+            static_cast<GLsizei>(layout.stride),
+            reinterpret_cast<void const*>(
+                static_cast<brief_int::usize>(layout.normal_offset)
+            )
+        );
+    } else {
+        glDisableVertexAttribArray(NORMAL_ATTRIB);
+        glVertexAttrib4f(NORMAL_ATTRIB, 0.f, 0.f, 0.f, 0.f);
+    }
+    glUniform1i(state::instanced_octahedral_normals_location, octahedral);
+    // Without lights, the scene looks as it always has.
+    auto const lit = layout.has_normals and bind_light_clusters(frame);
+    glUniform1i(state::instanced_enable_lighting_location, lit);
+
+    // Everything per object goes out in one linear copy.
+    auto& ring = state::stream_ring;
+    auto const matrices_size
+        = sizeof(glm::mat4) * frame.instance_matrices.size();
+    auto const layers_size
+        = sizeof(brief_int::u32) * frame.instance_layers.size();
+    auto const commands_offset = matrices_size + layers_size;
+    auto const commands_size = state::enable_multi_draw
+        ? sizeof(InstanceBatch) * frame.batches.size()
+        : 0;
+    auto const region
+        = begin_stream_frame(ring, commands_offset + commands_size);
+    stream_write(ring, 0, frame.instance_matrices.data(), matrices_size);
+    stream_write(
+        ring, matrices_size, frame.instance_layers.data(), layers_size
+    );
+    stream_write(ring, commands_offset, frame.batches.data(), commands_size);
+
+    bind_buffer(GL_ARRAY_BUFFER, ring.buffer.get());
+    auto const set_instance_pointers = [&](brief_int::usize const first) {
+        for (auto column = 0_u32; column < 4; ++column) {
+            auto const offset = region
+                + sizeof(glm::mat4) * first
+                + sizeof(glm::vec4) * column;
+            glVertexAttribPointer(
+                MATRIX_ATTRIB + column,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(glm::mat4),
+                reinterpret_cast<void const*>(offset)
+            );
+        }
+        glVertexAttribIPointer(
+            LAYER_ATTRIB,
+            1,
+            GL_UNSIGNED_INT,
+            sizeof(brief_int::u32),
+            reinterpret_cast<void const*>(
+                region + matrices_size + sizeof(brief_int::u32) * first
+            )
+        );
+    };
+    for (auto column = 0_u32; column < 4; ++column) {
+        glEnableVertexAttribArray(MATRIX_ATTRIB + column);
+        glVertexAttribDivisor(MATRIX_ATTRIB + column, 1);
+    }
+    glEnableVertexAttribArray(LAYER_ATTRIB);
+    glVertexAttribDivisor(LAYER_ATTRIB, 1);
+
+    auto const& batches = frame.batches;
+    auto const& arrays = frame.batch_texture_arrays;
+    if (state::enable_multi_draw) {
+        // Each batch's base instance already offsets into the instance data.
+        set_instance_pointers(0);
+        bind_buffer(GL_DRAW_INDIRECT_BUFFER, ring.buffer.get());
+        // Batches are sorted by texture array, so each one is a single run.
+        auto end = 0_uz;
+        for (auto begin = 0_uz; begin < batches.size(); begin = end) {
+            end = begin + 1;
+            while (end < batches.size() and arrays[end] == arrays[begin]) {
+                end += 1;
+            }
+            bind_texture(
+                0, GL_TEXTURE_2D_ARRAY, texture_array_name(arrays[begin])
+            );
+            multi_draw_arrays_indirect(
+                GL_TRIANGLES,
+                region + commands_offset + sizeof(InstanceBatch) * begin,
+                static_cast<GLsizei>(end - begin)
+            );
+        }
+    } else {
+        for (auto batch_index = 0_uz; batch_index < batches.size();
+            ++batch_index
+        ) {
+            auto const& batch = batches[batch_index];
+            bind_texture(
+                0, GL_TEXTURE_2D_ARRAY, texture_array_name(arrays[batch_index])
+            );
+            set_instance_pointers(batch.base_instance);
+            draw_arrays_instanced(
+                GL_TRIANGLES,
+                static_cast<GLint>(batch.first),
+                static_cast<GLsizei>(batch.count),
+                static_cast<GLsizei>(batch.instance_count)
+            );
+        }
+    }
+    end_stream_frame(ring);
+    if (lit) {
+        end_stream_frame(state::light_ring);
     }
-    glEnd();
 }
 
-// TODO: Implement non-recursively.
-auto static render_group(Group const& root) noexcept -> void {
-    glPushMatrix();
-
-    for (auto const& transform : root.transforms) {
-        std::visit(util::overload {
-            [](Translate const& translate) {
-                std::visit(util::overload {
-                    [](StaticTranslate const& static_translate) {
-                        glTranslatef(
-                            static_translate.xyz.x,
-                            static_translate.xyz.y,
-                            static_translate.xyz.z
-                        );
-                    },
-                    [](DynamicTranslate const& dynamic_translate) {
-                        float pos[3];
-                        float deriv[3];
-                        static float yo[3] = { 0, 1, 0 };
-                        float z[3];
-                        float m[16];
-
-                        float gt = glutGet(GLUT_ELAPSED_TIME);
-                        float timer = dynamic_translate.time;
-                        float realt = gt / (timer * 1000);
-
-                        renderCatmullRomCurve(dynamic_translate.points);
-                        getGlobalCatmullRomPoint(realt,dynamic_translate.points, pos, deriv);
-
-                        glTranslatef(pos[0], pos[1], pos[2]);
-                        if(dynamic_translate.align){ // if assign = True 
-                            normalize(deriv);
-                            cross(deriv, yo, z);
-                            normalize(z);
-                            cross(z, deriv, yo);
-                            normalize(yo);
-                            buildRotMatrix(deriv, yo, z, m);
-                            glMultMatrixf(m);
-                        }
-                    }
-                }, translate);
-            },
-            [](Rotate const& rotate) {
-                switch (rotate.kind) {
-                    using enum Rotate::Kind;
-
-                    case Angle:
-                        glRotatef(
-                            rotate.rotate[0],
-                            rotate.rotate[1],
-                            rotate.rotate[2],
-                            rotate.rotate[3]
-                        );
-                        break;
-                    case Time: {
-                        auto const gt = glutGet(GLUT_ELAPSED_TIME);
-                        auto const timer = rotate.rotate[0];
-                        auto const realt = gt / (timer * 1000);
-                        glRotatef(
-                            360 * realt,
-                            rotate.rotate[1],
-                            rotate.rotate[2],
-                            rotate.rotate[3]
-                        );
-                        break;
-                    }
-                }
-            },
-            [](Scale const& scale) {
-                glScalef(scale.x, scale.y, scale.z);
-            }
-        }, transform);
+// Legacy path, one fixed function draw per model, and a texture bind per
+// batch.
+auto static render_draws(Frame const& frame, glm::mat4 const& view)
+    noexcept -> void
+{
+    auto const& world = *state::world_ptr;
+    auto const& mesh_ranges = state::scene.mesh_ranges;
+    auto const& layout = state::vertex_layout;
+    bind_buffer(GL_ARRAY_BUFFER, state::mesh_arena.get());
+    // Always full floats on this path.
+    glVertexPointer(3, GL_FLOAT, static_cast<GLsizei>(layout.stride), 0);
+    if (layout.has_texcoords) {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(
+            2,
+            GL_FLOAT,
+            static_cast<GLsizei>(layout.stride),
+            reinterpret_cast<void const*>(
+                static_cast<brief_int::usize>(layout.texcoord_offset)
+            )
+        );
     }
+    // Only for models, the rest of the scene is drawn untextured.
+    glEnable(GL_TEXTURE_2D);
+
+    auto batch = 0_uz;
+    for (auto draw = 0_uz; draw < frame.draws.size(); ++draw) {
+        // Every texture is an array of its own on this path.
+        if (draw == frame.batches[batch].base_instance
+            + frame.batches[batch].instance_count
+        ) {
+            batch += 1;
+        }
+        if (draw == frame.batches[batch].base_instance) {
+            bind_texture(
+                0,
+                GL_TEXTURE_2D,
+                texture_array_name(frame.batch_texture_arrays[batch])
+            );
+        }
 
-    for (auto const& model : root.models) {
+        auto const& [matrix, model] = frame.draws[draw];
+        auto const mesh = world.models[model].mesh;
+        auto const [first, count] = mesh_ranges[mesh];
+        glLoadMatrixf(glm::value_ptr(
+            view * matrix * state::scene.mesh_dequantization[mesh]
+        ));
 
-        //glBindTexture(GL_TEXTURE_2D,ID DA TEXT DO MODEL);
         /*
         glMaterialfv(GL_FRONT, GL_AMBIENT, model->ambient);
         glMaterialfv(GL_FRONT, GL_DIFFUSE, model->difuse);
@@ -286,28 +495,110 @@ auto static render_group(Group const& root) noexcept -> void {
         */
 
 
-        glBindBuffer(GL_ARRAY_BUFFER, state::bind[0][iii]);
-        glVertexPointer(3,GL_FLOAT,0,0);
-
         //Normal
-        //glBindBuffer(GL_ARRAY_BUFFER, state::bind[1][iii]);
         //glNormalPointer(GL_FLOAT,0,0);
 
-        //Textura
-        //if(modelo tem textura){
-        //      glBindBuffer(GL_ARRAY_BUFFER, state::bind[2][iii]);
-        //      glTexCoordPointer(2,GL_FLOAT,0,0);}
 
+        draw_arrays(
+            GL_TRIANGLES,
+            static_cast<GLint>(first),
+            static_cast<GLsizei>(count)
+        );
+    }
 
-        glDrawArrays(GL_TRIANGLES,0,state::buffers[iii].size()/3);
-        iii++;
-        //glBindTexture(GL_TEXTURE_2D,0);
+    glDisable(GL_TEXTURE_2D);
+    if (layout.has_texcoords) {
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     }
-    for (auto const& child_node : root.children) {
-        render_group(child_node);
+}
+
+auto static render_world(
+    Frame const& frame,
+    ViewMatrices const& matrices
+) noexcept -> void {
+    for (auto curve = 0_uz; curve < frame.orbit_matrices.size(); ++curve) {
+        draw_simple(
+            matrices,
+            frame.orbit_matrices[curve],
+            config::DEFAULT_FG_COLOR,
+            state::orbit_buffers[curve].get(),
+            GL_LINE_LOOP,
+            0,
+            static_cast<GLsizei>(config::ORBIT_NUM_POINTS)
+        );
     }
 
-    glPopMatrix();
+    if (state::core_profile) {
+        render_instanced(frame, matrices);
+    } else {
+        render_draws(frame, matrices.view);
+    }
+}
+
+// Once per second, with the framerate and the last frame's culling results
+// and GL calls.
+auto static update_window_title(
+    Frame const& frame,
+    GlCallStats const& gl_stats
+) noexcept -> void {
+    auto static num_frames = 0;
+    auto static last_update = 0;
+
+    num_frames += 1;
+    auto const now = glutGet(GLUT_ELAPSED_TIME);
+    if (now - last_update < 1000) {
+        return;
+    }
+
+    // Peaks of each category, not necessarily reached at the same time.
+    auto const& gpu_stats = gpu_memory_stats();
+    auto gpu_memory = 0_uz;
+    auto peak_gpu_memory = 0_uz;
+    for (auto category = 0_uz; category < NUM_GPU_CATEGORIES; ++category) {
+        gpu_memory += gpu_stats.current[category];
+        peak_gpu_memory += gpu_stats.peak[category];
+    }
+    auto constexpr MIB = 1024.0 * 1024.0;
+    auto const textures = texture_stats();
+
+    try {
+        auto const title = fmt::format(
+            "{} | {:.1f} fps | groups: {} drawn, {} culled"
+                " | models: {} drawn, {} culled, {} occluded"
+                " | draw calls: {}, GL calls: {} ({} redundant skipped)"
+                " | binds: {}"
+                " | state changes: {} ({} avoided)"
+                " | GPU memory: {:.1f} MiB (peak {:.1f} MiB)"
+                " | textures: {}/{} loaded ({:.1f} MiB)"
+                " | lights: {} visible, up to {} per cluster",
+            config::WIN_TITLE,
+            static_cast<double>(num_frames) * 1000.0
+                / static_cast<double>(now - last_update),
+            frame.cull_stats.groups_visible,
+            frame.cull_stats.groups_culled,
+            static_cast<brief_int::usize>(frame.draws.size()),
+            frame.cull_stats.models_culled,
+            frame.occlusion_stats.occluded,
+            gl_stats.draws,
+            gl_stats.calls,
+            gl_stats.skipped,
+            gl_stats.binds,
+            frame.render_queue_stats.state_changes,
+            frame.render_queue_stats.state_changes_avoided,
+            static_cast<double>(gpu_memory) / MIB,
+            static_cast<double>(peak_gpu_memory) / MIB,
+            textures.resident,
+            textures.requested,
+            static_cast<double>(textures.resident_size) / MIB,
+            frame.light_cluster_stats.lights,
+            frame.light_cluster_stats.max_per_cluster
+        );
+        glutSetWindowTitle(title.c_str());
+    } catch (...) {
+        // Not worth failing over.
+    }
+    num_frames = 0;
+    last_update = now;
 }
 
 } // namespace engine::render
@@ -0,0 +1,170 @@
+#include "engine/render/render_queue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <glm/geometric.hpp>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+auto constexpr DEPTH_BITS = 20_u32;
+auto constexpr MESH_BITS = 16_u32;
+auto constexpr MATERIAL_BITS = 10_u32;
+auto constexpr TEXTURE_BITS = 12_u32;
+auto constexpr PROGRAM_BITS = 4_u32;
+auto constexpr PASS_BITS = 2_u32;
+static_assert(
+    DEPTH_BITS + MESH_BITS + MATERIAL_BITS + TEXTURE_BITS + PROGRAM_BITS
+        + PASS_BITS
+    == 64
+);
+
+auto constexpr RADIX_BITS = 8_u32;
+auto constexpr RADIX_SIZE = 1_uz << RADIX_BITS;
+
+auto field(u64 const value, u32 const bits) noexcept -> u64 {
+    return value & ((u64{1} << bits) - 1);
+}
+
+// Number of times consecutive keys need different state, counting the
+// first.
+auto count_state_changes(std::span<u64 const> const keys) noexcept -> u32 {
+    auto changes = 0_u32;
+    for (auto key = 0_uz; key < keys.size(); ++key) {
+        if (key == 0
+            or render_state(keys[key]) != render_state(keys[key - 1])
+        ) {
+            changes += 1;
+        }
+    }
+    return changes;
+}
+
+// Past these, unrelated draws share key bits and end up interleaved, which
+// costs batches but not correctness, since batching compares the real
+// values.
+auto warn_if_fields_overflow(World const& world, usize const num_textures)
+    noexcept -> void
+{
+    auto static warned = false;
+    if (warned) {
+        return;
+    }
+    // Never more arrays than textures, plus one for untextured draws.
+    if (world.meshes.size() > (1_uz << MESH_BITS)
+        or num_textures + 1 > (1_uz << TEXTURE_BITS)
+    ) {
+        spdlog::warn(
+            "{} meshes and {} textures overflow the render keys, sorting"
+                " will batch less.",
+            world.meshes.size(),
+            num_textures
+        );
+        warned = true;
+    }
+}
+
+} // namespace
+
+auto make_render_key(RenderKeyFields const& fields) noexcept -> u64 {
+    auto const max_depth = static_cast<float>((1_u32 << DEPTH_BITS) - 1);
+    auto const depth = static_cast<u64>(
+        std::clamp(fields.depth, 0.f, 1.f) * max_depth
+    );
+
+    auto key = field(static_cast<u64>(fields.pass), PASS_BITS);
+    key = key << PROGRAM_BITS | field(fields.program, PROGRAM_BITS);
+    key = key << TEXTURE_BITS | field(fields.texture, TEXTURE_BITS);
+    key = key << MATERIAL_BITS | field(fields.material, MATERIAL_BITS);
+    key = key << MESH_BITS | field(fields.mesh, MESH_BITS);
+    return key << DEPTH_BITS | depth;
+}
+
+auto render_state(u64 const key) noexcept -> u64 {
+    return key >> DEPTH_BITS;
+}
+
+// Least significant digit first, skipping digits every key shares.
+auto sort_render_queue(RenderQueue& queue) noexcept -> void {
+    auto const size = queue.keys.size();
+    queue.sorted_keys.resize(size);
+    queue.sorted_payloads.resize(size);
+
+    for (auto shift = 0_u32; shift < 64; shift += RADIX_BITS) {
+        auto counts = std::array<usize, RADIX_SIZE>{};
+        for (auto const key : queue.keys) {
+            counts[field(key >> shift, RADIX_BITS)] += 1;
+        }
+        if (std::ranges::find(counts, size) != counts.end()) {
+            continue;
+        }
+
+        auto offset = 0_uz;
+        for (auto& count : counts) {
+            offset += std::exchange(count, offset);
+        }
+        for (auto entry = 0_uz; entry < size; ++entry) {
+            auto const key = queue.keys[entry];
+            auto const slot = counts[field(key >> shift, RADIX_BITS)]++;
+            queue.sorted_keys[slot] = key;
+            queue.sorted_payloads[slot] = queue.payloads[entry];
+        }
+        std::swap(queue.keys, queue.sorted_keys);
+        std::swap(queue.payloads, queue.sorted_payloads);
+    }
+}
+
+auto sort_draws(
+    RenderQueue& queue,
+    World const& world,
+    Scene const& scene,
+    std::span<TextureSlot const> const texture_slots,
+    glm::vec3 const& eye,
+    float const far,
+    std::vector<Draw>& draws,
+    RenderQueueStats& stats
+) noexcept -> void {
+    warn_if_fields_overflow(world, texture_slots.size());
+
+    auto const num_draws = draws.size();
+    queue.keys.resize(num_draws);
+    queue.payloads.resize(num_draws);
+    for (auto draw = 0_uz; draw < num_draws; ++draw) {
+        auto const model = draws[draw].model;
+        auto const& bounds = scene.model_bounds[model];
+        auto const distance
+            = glm::distance(eye, bounds.center) - bounds.radius;
+        auto const array = find_texture_slot(
+            texture_slots, world.models[model].texture
+        ).array;
+        // Neither materials exist yet, nor a second program.
+        queue.keys[draw] = make_render_key({
+            .pass = RenderPass::SOLID,
+            .program = 0,
+            .texture = array == NO_TEXTURE ? 0 : array + 1,
+            .material = 0,
+            .mesh = world.models[model].mesh,
+            .depth = far > 0.f ? distance / far : 0.f,
+        });
+        queue.payloads[draw] = static_cast<u32>(draw);
+    }
+
+    auto const unsorted_changes = count_state_changes(queue.keys);
+    sort_render_queue(queue);
+    stats.state_changes = count_state_changes(queue.keys);
+    stats.state_changes_avoided = unsorted_changes - stats.state_changes;
+
+    queue.sorted_draws.resize(num_draws);
+    for (auto entry = 0_uz; entry < num_draws; ++entry) {
+        queue.sorted_draws[entry] = draws[queue.payloads[entry]];
+    }
+    std::swap(draws, queue.sorted_draws);
+}
+
+} // namespace engine::render
@@ -3,10 +3,19 @@
 #include "engine/render/renderer.hpp"
 
 #include "engine/config.hpp"
+#include "engine/render/gl_state.hpp"
+#include "engine/render/gpu_resources.hpp"
 #include "engine/render/io_events.hpp"
 #include "engine/render/render.hpp"
+#include "engine/render/shader.hpp"
+#include "engine/render/simulation.hpp"
 #include "engine/render/state.hpp"
+#include "engine/render/static_batching.hpp"
+#include "engine/render/texture_loader.hpp"
+#include "engine/render/vertex_format.hpp"
+#include "generator/primitives/box.hpp"
 
+#include <brief_int.hpp>
 #include <spdlog/spdlog.h>
 
 
@@ -14,7 +23,12 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/vec3.hpp>
 #include <glm/gtx/string_cast.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <utility>
 #include <vector>
 
 double frames = 0;
@@ -23,9 +37,19 @@ double fps;
 
 namespace engine::render {
 
+using namespace brief_int;
+using namespace brief_int::literals;
+
 auto framerate () -> void; 
 
 auto static display_info() -> void;
+auto static idle() noexcept -> void;
+
+bool static requested_core_profile = config::ENABLE_CORE_PROFILE;
+
+auto set_legacy(bool const legacy) noexcept -> void {
+    requested_core_profile = not legacy;
+}
 
 auto get() -> Renderer& {
     auto static lazy_static = Renderer{};
@@ -35,18 +59,358 @@ auto get() -> Renderer& {
 
 
 
-auto static bufferVBOs(Group const& root) noexcept -> void {
-    for (auto const& model : root.models) {
-        std::vector<float> BufferModel;
-        for (auto const& vertex : model.vertices) {
-            BufferModel.push_back(vertex[0]);
-            BufferModel.push_back(vertex[1]);
-            BufferModel.push_back(vertex[2]);
+// A single buffer for every mesh, so drawing never has to switch buffers.
+auto static buffer_meshes(World const& world, Scene const& scene) noexcept
+    -> void
+{
+    // Fixed function vertex pointers can't take half floats, nor map
+    // texcoords back from a normalized range.
+    state::vertex_layout = choose_vertex_layout(
+        world,
+        state::core_profile
+            ? config::VERTEX_POSITION_FORMAT
+            : PositionFormat::FLOAT,
+        config::VERTEX_NORMAL_FORMAT,
+        state::core_profile
+            ? config::VERTEX_TEXCOORD_FORMAT
+            : TexcoordFormat::FLOAT
+    );
+
+    auto const& ranges = scene.mesh_ranges;
+    auto const num_vertices = ranges.empty()
+        ? 0_uz
+        : static_cast<usize>(ranges.back().first) + ranges.back().count;
+    auto const size = state::vertex_layout.stride * num_vertices;
+
+    // The world outlives its buffers, which are replaced along with it.
+    state::mesh_arena = create_gpu_buffer(
+        GpuCategory::GEOMETRY,
+        size,
+        [&world, layout = state::vertex_layout](GLuint const buffer) {
+            // Meshes are packed in order, matching Scene::mesh_ranges.
+            auto packed = std::vector<std::byte>{};
+            for (auto const& mesh : world.meshes) {
+                pack_vertices(mesh, layout, packed);
+            }
+
+            bind_buffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(
+                GL_ARRAY_BUFFER,
+                static_cast<GLsizeiptr>(packed.size()),
+                packed.data(),
+                GL_STATIC_DRAW
+            );
+        }
+    );
+}
+
+auto static constexpr INSTANCED_VERTEX_SHADER = R"(
+#version 330
+
+uniform mat4 view_proj;
+uniform mat4 view;
+// Maps stored texcoords back to their original range.
+uniform vec2 texcoord_min;
+uniform vec2 texcoord_scale;
+// Normals are either 3 signed normalized components, or 2 octahedral ones.
+uniform bool octahedral_normals;
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in mat4 model; // per instance.
+layout(location = 5) in vec2 texcoord;
+layout(location = 6) in uint layer; // per instance.
+layout(location = 7) in vec4 packed_normal;
+
+out vec2 frag_texcoord;
+flat out float frag_layer;
+out vec3 frag_position; // world space.
+out vec3 frag_normal; // world space, zero when unlit.
+out float frag_depth; // along the view direction.
+
+vec3 decode_normal() {
+    if (!octahedral_normals) {
+        return packed_normal.xyz;
+    }
+    vec3 normal = vec3(
+        packed_normal.xy,
+        1.0 - abs(packed_normal.x) - abs(packed_normal.y)
+    );
+    float fold = max(-normal.z, 0.0);
+    normal.xy += mix(
+        vec2(fold), vec2(-fold), greaterThanEqual(normal.xy, vec2(0.0))
+    );
+    return normal;
+}
+
+void main() {
+    vec4 world_position = model * vec4(position, 1.0);
+    gl_Position = view_proj * world_position;
+    frag_texcoord = texcoord * texcoord_scale + texcoord_min;
+    frag_layer = float(layer);
+    frag_position = world_position.xyz;
+    // The cofactor matrix keeps normals perpendicular through any scale,
+    // without an inverse per vertex.
+    mat3 m = mat3(model);
+    frag_normal = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1]))
+        * decode_normal();
+    frag_depth = -(view * world_position).z;
+}
+)";
+
+// Lights come from the cluster under each fragment, see LightClusters.
+// Samplers are bound to units once, tex to 0 and the light buffers to 1-3.
+auto static constexpr INSTANCED_FRAGMENT_SHADER = R"(
+#version 330
+
+const float SPOT = 1.0;
+const float DIRECTIONAL = 2.0;
+
+uniform vec4 color;
+uniform sampler2DArray tex;
+
+uniform bool enable_lighting;
+uniform float ambient;
+uniform samplerBuffer lights; // 3 texels each.
+uniform usamplerBuffer light_ranges; // {offset, count} per cluster.
+uniform usamplerBuffer light_indices;
+// Where this frame's lights, ranges and indices begin in their buffers.
+uniform ivec3 light_bases;
+uniform ivec3 cluster_grid;
+uniform vec2 cluster_scale; // clusters per pixel.
+uniform vec2 slice_params; // slice = log(depth) * x + y.
+
+in vec2 frag_texcoord;
+flat in float frag_layer;
+in vec3 frag_position;
+in vec3 frag_normal;
+in float frag_depth;
+
+out vec4 frag_color;
+
+vec3 light_at(vec3 normal) {
+    ivec2 tile = min(
+        ivec2(gl_FragCoord.xy * cluster_scale), cluster_grid.xy - 1
+    );
+    int slice = clamp(
+        int(log(frag_depth) * slice_params.x + slice_params.y),
+        0,
+        cluster_grid.z - 1
+    );
+    int cluster = (slice * cluster_grid.y + tile.y) * cluster_grid.x + tile.x;
+    uvec2 range = texelFetch(light_ranges, light_bases.y + cluster).xy;
+
+    vec3 light = vec3(ambient);
+    for (uint i = 0u; i < range.y; ++i) {
+        int index = int(
+            texelFetch(light_indices, light_bases.z + int(range.x + i)).x
+        );
+        int texel = light_bases.x + 3 * index;
+        vec4 position = texelFetch(lights, texel);
+        vec4 light_color = texelFetch(lights, texel + 1);
+        vec4 direction = texelFetch(lights, texel + 2);
+
+        vec3 to_light = direction.xyz;
+        float attenuation = 1.0;
+        if (light_color.w != DIRECTIONAL) {
+            to_light = position.xyz - frag_position;
+            float distance = length(to_light);
+            to_light /= max(distance, 1e-4);
+            float falloff = max(1.0 - distance / position.w, 0.0);
+            attenuation = falloff * falloff;
+            if (light_color.w == SPOT) {
+                attenuation *= smoothstep(
+                    direction.w,
+                    mix(direction.w, 1.0, 0.1),
+                    dot(-to_light, direction.xyz)
+                );
+            }
         }
-        state::buffers.push_back(BufferModel);
+        light += light_color.rgb * attenuation
+            * max(dot(normal, to_light), 0.0);
+    }
+    return light;
+}
+
+void main() {
+    vec4 base = color * texture(tex, vec3(frag_texcoord, frag_layer));
+    if (!enable_lighting || dot(frag_normal, frag_normal) == 0.0) {
+        frag_color = base;
+        return;
+    }
+    frag_color = vec4(base.rgb * light_at(normalize(frag_normal)), base.a);
+}
+)";
+
+// For orbits, the axis and the lookat indicator.
+auto static constexpr SIMPLE_VERTEX_SHADER = R"(
+#version 330
+
+uniform mat4 mvp;
+
+layout(location = 0) in vec3 position;
+
+void main() {
+    gl_Position = mvp * vec4(position, 1.0);
+}
+)";
+
+auto static constexpr SIMPLE_FRAGMENT_SHADER = R"(
+#version 330
+
+uniform vec4 color;
+
+out vec4 frag_color;
+
+void main() {
+    frag_color = color;
+}
+)";
+
+[[nodiscard]]
+auto static compile_or_abort(
+    char const* const vertex_src,
+    char const* const fragment_src
+) noexcept -> GLuint {
+    auto const program = compile_program(vertex_src, fragment_src);
+    if (not program.has_value()) {
+        // Nothing can be drawn in a core context without them.
+        spdlog::critical("aborting.");
+        std::exit(EXIT_FAILURE);
+    }
+    return *program;
+}
+
+auto static init_core_profile() noexcept -> void {
+    auto const instanced_program = compile_or_abort(
+        INSTANCED_VERTEX_SHADER, INSTANCED_FRAGMENT_SHADER
+    );
+    state::instanced_program = instanced_program;
+    state::instanced_view_proj_location
+        = glGetUniformLocation(instanced_program, "view_proj");
+    state::instanced_color_location
+        = glGetUniformLocation(instanced_program, "color");
+    state::instanced_texcoord_min_location
+        = glGetUniformLocation(instanced_program, "texcoord_min");
+    state::instanced_texcoord_scale_location
+        = glGetUniformLocation(instanced_program, "texcoord_scale");
+    state::instanced_view_location
+        = glGetUniformLocation(instanced_program, "view");
+    state::instanced_octahedral_normals_location
+        = glGetUniformLocation(instanced_program, "octahedral_normals");
+    state::instanced_enable_lighting_location
+        = glGetUniformLocation(instanced_program, "enable_lighting");
+    state::instanced_ambient_location
+        = glGetUniformLocation(instanced_program, "ambient");
+    state::instanced_light_bases_location
+        = glGetUniformLocation(instanced_program, "light_bases");
+    state::instanced_cluster_grid_location
+        = glGetUniformLocation(instanced_program, "cluster_grid");
+    state::instanced_cluster_scale_location
+        = glGetUniformLocation(instanced_program, "cluster_scale");
+    state::instanced_slice_params_location
+        = glGetUniformLocation(instanced_program, "slice_params");
+    // Units never change, only what's bound to them.
+    use_program(instanced_program);
+    glUniform1i(glGetUniformLocation(instanced_program, "lights"), 1);
+    glUniform1i(glGetUniformLocation(instanced_program, "light_ranges"), 2);
+    glUniform1i(glGetUniformLocation(instanced_program, "light_indices"), 3);
+
+    auto const simple_program = compile_or_abort(
+        SIMPLE_VERTEX_SHADER, SIMPLE_FRAGMENT_SHADER
+    );
+    state::simple_program = simple_program;
+    state::simple_mvp_location = glGetUniformLocation(simple_program, "mvp");
+    state::simple_color_location
+        = glGetUniformLocation(simple_program, "color");
+
+    // One per vertex format: the mesh arena's, and plain float positions.
+    glGenVertexArrays(1, &state::mesh_vao);
+    glGenVertexArrays(1, &state::simple_vao);
+    bind_vertex_array(state::simple_vao);
+    glEnableVertexAttribArray(0);
+    bind_vertex_array(0);
+
+    init_stream_ring(state::stream_ring, config::STREAM_RING_REGION_SIZE);
+    init_stream_ring(state::light_ring, config::STREAM_RING_REGION_SIZE);
+    // Attached to the light ring every frame, which may be recreated.
+    state::light_texture = create_gpu_texture(GpuCategory::STREAMING, 0);
+    state::light_range_texture
+        = create_gpu_texture(GpuCategory::STREAMING, 0);
+    state::light_index_texture
+        = create_gpu_texture(GpuCategory::STREAMING, 0);
+
+    // Indirect draws with a base instance, so every batch goes out at once.
+    if (GLEW_VERSION_4_3) {
+        state::enable_multi_draw = true;
+    } else {
+        spdlog::warn("OpenGL 4.3 unavailable, one draw call per mesh.");
     }
-    for (auto const& child_node : root.children) {
-        bufferVBOs(child_node);
+}
+
+[[nodiscard]]
+auto static buffer_vertices(std::vector<glm::vec3> vertices) noexcept
+    -> GpuHandle
+{
+    auto const size = sizeof(glm::vec3) * vertices.size();
+    return create_gpu_buffer(
+        GpuCategory::GEOMETRY,
+        size,
+        [vertices = std::move(vertices), size](GLuint const buffer) {
+            bind_buffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(
+                GL_ARRAY_BUFFER,
+                static_cast<GLsizeiptr>(size),
+                vertices.data(),
+                GL_STATIC_DRAW
+            );
+        }
+    );
+}
+
+// Geometry of the axis and the lookat indicator, drawn out of buffers like
+// everything else.
+auto static buffer_helpers() noexcept -> void {
+    state::axis_buffer = buffer_vertices({
+        {-config::X_AXIS_HALF_LEN, 0.f, 0.f},
+        {config::X_AXIS_HALF_LEN, 0.f, 0.f},
+        {0.f, -config::Y_AXIS_HALF_LEN, 0.f},
+        {0.f, config::Y_AXIS_HALF_LEN, 0.f},
+        {0.f, 0.f, -config::Z_AXIS_HALF_LEN},
+        {0.f, 0.f, config::Z_AXIS_HALF_LEN},
+    });
+
+    auto lookat_indicator = ::generator::generate_box(0.5f, 1).value();
+    state::lookat_indicator_num_vertices
+        = static_cast<u32>(lookat_indicator.size());
+    state::lookat_indicator_buffer
+        = buffer_vertices(std::move(lookat_indicator));
+}
+
+// Orbits never change shape, so their polylines are uploaded only once.
+auto static buffer_orbits(Scene const& scene) noexcept -> void {
+    auto& orbit_buffers = state::orbit_buffers;
+    orbit_buffers.clear();
+
+    auto const num_curves = scene.animations.curve_freqs.size();
+    for (auto curve = 0_uz; curve < num_curves; ++curve) {
+        auto polyline = catmull_rom_polyline(
+            curve_segments(scene.animations, static_cast<u32>(curve)),
+            config::ORBIT_NUM_POINTS
+        );
+        auto const size = sizeof(glm::vec3) * polyline.size();
+        orbit_buffers.push_back(create_gpu_buffer(
+            GpuCategory::ORBITS,
+            size,
+            [polyline = std::move(polyline), size](GLuint const buffer) {
+                bind_buffer(GL_ARRAY_BUFFER, buffer);
+                glBufferData(
+                    GL_ARRAY_BUFFER,
+                    static_cast<GLsizeiptr>(size),
+                    polyline.data(),
+                    GL_STATIC_DRAW
+                );
+            }
+        ));
     }
 }
 
@@ -61,6 +425,11 @@ Renderer::Renderer() {
     glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
     glutInitWindowPosition(config::WIN_POS_X, config::WIN_POS_Y);
     glutInitWindowSize(config::WIN_WIDTH, config::WIN_HEIGHT);
+    state::core_profile = requested_core_profile;
+    if (state::core_profile) {
+        glutInitContextVersion(3, 3);
+        glutInitContextProfile(GLUT_CORE_PROFILE);
+    }
     glutCreateWindow(config::WIN_TITLE);
     glutSetOption(
         GLUT_ACTION_ON_WINDOW_CLOSE,
@@ -69,17 +438,27 @@ Renderer::Renderer() {
     glutSetKeyRepeat(GLUT_KEY_REPEAT_OFF);
     glutDisplayFunc(render);
     glutReshapeFunc(resize);
-    glutTimerFunc(config::RENDER_TICK_MILLIS, [](int) { update_camera(); }, 0);
+    glutIdleFunc(idle);
     glutKeyboardFunc(key_down);
     glutKeyboardUpFunc(key_up);
+    glutMouseFunc(mouse_button);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
 
+    // Core contexts need GLEW to look functions up past the extension
+    // string, which has a harmless error left behind.
+    glewExperimental = GL_TRUE;
     glewInit();
-    //glEnable(GL_LIGHTING);
-    //glEnable(GL_LIGHT0);
-	//glEnable(GL_RESCALE_NORMAL);
-    glEnableClientState(GL_VERTEX_ARRAY);
+    glGetError();
+    if (state::core_profile) {
+        init_core_profile();
+    } else {
+        //glEnable(GL_LIGHTING);
+        //glEnable(GL_LIGHT0);
+        //glEnable(GL_RESCALE_NORMAL);
+        glEnableClientState(GL_VERTEX_ARRAY);
+    }
+    buffer_helpers();
 
     glClearColor(
         config::DEFAULT_BG_COLOR.r,
@@ -87,8 +466,7 @@ Renderer::Renderer() {
         config::DEFAULT_BG_COLOR.b,
         config::DEFAULT_BG_COLOR.a
     );
-    glPolygonMode(GL_FRONT, config::DEFAULT_POLYGON_MODE);
-    glLineWidth(config::DEFAULT_LINE_WIDTH);
+    set_line_width(config::DEFAULT_LINE_WIDTH);
     framerate();
     display_info();
 }
@@ -98,11 +476,16 @@ auto Renderer::set_world(World& world) -> Renderer& {
         world_ptr != state::world_ptr
     ) {
         state::world_ptr = world_ptr;
-        bufferVBOs(state::world_ptr->root);
-
-        int i = 0;
+        if (config::ENABLE_STATIC_BATCHING) {
+            batch_static_models(world);
+        }
+        state::scene = compile_scene(world);
+        buffer_orbits(state::scene);
+        buffer_meshes(world, state::scene);
+        // The fixed function path can't sample arrays.
+        load_textures(world.textures, state::core_profile);
+        log_gpu_memory_stats();
 
-        glEnableClientState(GL_VERTEX_ARRAY);
         //glEnableClientState(GL_NORMAL_ARRAY);
         //glEnableClientState(GL_TEXTURE_COORD_ARRAY);
         //glEnable(GL_TEXTURE_2D);
@@ -111,23 +494,6 @@ auto Renderer::set_world(World& world) -> Renderer& {
 
         //float amb[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
 	    //glLightModelfv(GL_LIGHT_MODEL_AMBIENT, amb);
-        
-        glGenBuffers(500,state::bind[0]);
-        int tamanho = static_cast<int> (state::buffers.size());
-
-        for(int i = 0; i < tamanho;i++){
-            glBindBuffer(GL_ARRAY_BUFFER, state::bind[0][i]);
-            glBufferData(GL_ARRAY_BUFFER,sizeof(float) * state::buffers[i].size(),state::buffers[i].data(),GL_STATIC_DRAW);
-
-            //glGenBuffers(500,state::bind[1]);
-            //glBindBuffer(GL_ARRAY_BUFFER, state::bind[1][i]);
-            //glBufferData(GL_ARRAY_BUFFER,sizeof(float) * NORMAL DO MODELO.size(), NORMAL DO MODELO.data() ,GL_STATIC_DRAW);
-
-            //glGenBuffers(500,state::bind[2]);
-            //glBindBuffer(GL_ARRAY_BUFFER, state::bind[2][i]);
-            //glBufferData(GL_ARRAY_BUFFER,sizeof(float) * TEXT DO MODELO.size(), TEXT DO MODELO.data() ,GL_STATIC_DRAW);
-        }
-
     }
     return *this;
 }
@@ -160,7 +526,12 @@ auto Renderer::set_lights(Lights& l) -> Renderer& {
 */
 
 auto Renderer::run() noexcept -> void {
+    start_simulation();
     glutMainLoop();
+    stop_simulation();
+    stop_texture_loader();
+    // The window, and its context, are gone by now.
+    abandon_gpu_resources();
 }
 
 auto framerate () -> void {
@@ -183,6 +554,17 @@ auto framerate () -> void {
     );
 }
 
+// Frames are produced by the simulation thread, so there's only something
+// new to draw once it has published one. Until then, backs off briefly
+// instead of spinning, still handling window events in between.
+auto static idle() noexcept -> void {
+    if (state::frames.fresh()) {
+        glutPostRedisplay();
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+}
+
 auto static display_info() -> void {
     // reinterpret_cast is needed to silence some fmt + unsigned char warnings.
     spdlog::info(
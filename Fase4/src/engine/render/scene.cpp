@@ -0,0 +1,464 @@
+#include "engine/render/scene.hpp"
+
+#include "engine/jobs/job_system.hpp"
+#include "engine/render/vertex_format.hpp"
+#include "util/overload.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <variant>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto is_time_based(Transform const& transform) noexcept -> bool {
+    return std::visit(util::overload {
+        [](Translate const& translate) {
+            return std::holds_alternative<DynamicTranslate>(translate);
+        },
+        [](Rotate const& rotate) {
+            return rotate.kind == Rotate::Kind::Time;
+        },
+        [](Scale const&) {
+            return false;
+        }
+    }, transform);
+}
+
+auto static_transform_matrix(Transform const& transform) noexcept
+    -> glm::mat4
+{
+    return std::visit(util::overload {
+        [](Translate const& translate) {
+            return glm::translate(
+                glm::mat4{1.f}, std::get<StaticTranslate>(translate).xyz
+            );
+        },
+        [](Rotate const& rotate) {
+            return glm::rotate(
+                glm::mat4{1.f},
+                glm::radians(rotate.rotate[0]),
+                glm::vec3{rotate.rotate[1], rotate.rotate[2], rotate.rotate[3]}
+            );
+        },
+        [](Scale const& scale) {
+            return glm::scale(glm::mat4{1.f}, scale);
+        }
+    }, transform);
+}
+
+// Registers `transform` with the scene's animations if it is time based.
+[[nodiscard]]
+auto static compile_dynamic_transform(
+    Scene& scene,
+    Transform const& transform
+) -> std::optional<TransformOp> {
+    return std::visit(util::overload {
+        [&](Translate const& translate) -> std::optional<TransformOp> {
+            auto const* const dynamic_translate
+                = std::get_if<DynamicTranslate>(&translate);
+            if (dynamic_translate == nullptr) {
+                return {};
+            }
+            return TransformOp {
+                .kind = TransformOp::Kind::Curve,
+                .index = add_curve(scene.animations, *dynamic_translate),
+            };
+        },
+        [&](Rotate const& rotate) -> std::optional<TransformOp> {
+            if (rotate.kind != Rotate::Kind::Time) {
+                return {};
+            }
+            return TransformOp {
+                .kind = TransformOp::Kind::Rotation,
+                .index = add_rotation(scene.animations, rotate),
+            };
+        },
+        [](Scale const&) -> std::optional<TransformOp> {
+            return {};
+        }
+    }, transform);
+}
+
+// Bounds of a model in its group's space.
+[[nodiscard]]
+auto static model_bounds(World const& world, u32 const model) noexcept
+    -> Sphere
+{
+    auto const matrix = world.models[model].matrix;
+    auto const& bounds = world.meshes[world.models[model].mesh].bounds;
+    return matrix == NO_MATRIX
+        ? bounds
+        : transform(bounds, world.model_matrices[matrix]);
+}
+
+// Bounds of `sphere` in the parent's space, as moved by `group`'s transforms
+// over the whole range of their animations.
+[[nodiscard]]
+auto static sweep_bounds(
+    Scene const& scene,
+    u32 const group,
+    Sphere sphere
+) noexcept -> Sphere {
+    if (sphere.radius < 0.f) {
+        return sphere;
+    }
+
+    auto const& animations = scene.animations;
+    auto const [begin, end] = scene.group_ops[group];
+    for (auto op = end; op > begin; --op) {
+        auto const [kind, index] = scene.ops[op - 1];
+        switch (kind) {
+            using enum TransformOp::Kind;
+
+            case Static:
+                sphere = transform(sphere, scene.static_matrices[index]);
+                break;
+
+            case Rotation: {
+                // The center circles around the axis, which goes through the
+                // origin.
+                auto const axis = glm::vec3 {
+                    animations.rotation_axis_x[index],
+                    animations.rotation_axis_y[index],
+                    animations.rotation_axis_z[index],
+                };
+                auto const on_axis = axis * glm::dot(axis, sphere.center);
+                sphere = {
+                    .center = on_axis,
+                    .radius = glm::length(sphere.center - on_axis)
+                        + sphere.radius,
+                };
+                break;
+            }
+
+            case Curve: {
+                auto const curve
+                    = bounding_sphere(curve_segments(animations, index));
+                sphere = animations.curve_align[index] != 0
+                    // Oriented along the curve, so any rotation is possible.
+                    ? Sphere {
+                        .center = curve.center,
+                        .radius = curve.radius
+                            + glm::length(sphere.center)
+                            + sphere.radius,
+                    }
+                    : Sphere {
+                        .center = curve.center + sphere.center,
+                        .radius = curve.radius + sphere.radius,
+                    };
+                break;
+            }
+        }
+    }
+    return sphere;
+}
+
+// Draws and world space bounds of a group's models, from its world matrix.
+auto static update_models(
+    Scene& scene,
+    World const& world,
+    usize const group
+) noexcept -> void {
+    auto const [models_begin, models_end] = world.group_models[group];
+    for (auto model = models_begin; model < models_end; ++model) {
+        auto const mesh = world.models[model].mesh;
+        auto const local_matrix = world.models[model].matrix;
+        auto const matrix = local_matrix == NO_MATRIX
+            ? scene.world_matrices[group]
+            : scene.world_matrices[group]
+                * world.model_matrices[local_matrix];
+        scene.draws[model] = {
+            .matrix = matrix,
+            .model = model,
+        };
+        scene.model_bounds[model]
+            = transform(world.meshes[mesh].bounds, matrix);
+    }
+}
+
+auto compile_scene(World const& world) -> Scene {
+    auto const num_groups = world.group_parents.size();
+
+    auto scene = Scene{};
+    scene.mesh_ranges = layout_mesh_arena(world);
+    scene.mesh_dequantization.reserve(world.meshes.size());
+    for (auto const& mesh : world.meshes) {
+        scene.mesh_dequantization.push_back(dequantization_matrix(mesh.bounds));
+    }
+    scene.group_ops.reserve(num_groups);
+    scene.world_matrices.resize(num_groups);
+
+    auto group_dynamic = std::vector<bool>(num_groups);
+    auto group_depths = std::vector<u32>(num_groups);
+
+    for (auto group = 0_uz; group < num_groups; ++group) {
+        auto const parent = world.group_parents[group];
+        auto const ops_begin = static_cast<u32>(scene.ops.size());
+        auto dynamic = parent != NO_PARENT and group_dynamic[parent];
+
+        auto folded = glm::mat4{1.f};
+        auto has_folded = false;
+        auto const flush_folded = [&] {
+            if (has_folded) {
+                scene.ops.push_back({
+                    .kind = TransformOp::Kind::Static,
+                    .index = static_cast<u32>(scene.static_matrices.size()),
+                });
+                scene.static_matrices.push_back(folded);
+                folded = glm::mat4{1.f};
+                has_folded = false;
+            }
+        };
+
+        auto const [begin, end] = world.group_transforms[group];
+        for (auto transform = begin; transform < end; ++transform) {
+            auto const& world_transform = world.transforms[transform];
+            if (auto const op
+                    = compile_dynamic_transform(scene, world_transform);
+                op.has_value()
+            ) {
+                flush_folded();
+                scene.ops.push_back(*op);
+                dynamic = true;
+            } else {
+                folded *= static_transform_matrix(world_transform);
+                has_folded = true;
+            }
+        }
+        flush_folded();
+
+        scene.group_ops.push_back({
+            .begin = ops_begin,
+            .end = static_cast<u32>(scene.ops.size()),
+        });
+        group_dynamic[group] = dynamic;
+        group_depths[group] = parent == NO_PARENT
+            ? 0
+            : group_depths[parent] + 1;
+
+        if (dynamic) {
+            scene.dynamic_groups.push_back(static_cast<u32>(group));
+        } else {
+            // Static groups only have static ancestors and a single folded
+            // op at most, so their world matrix is final.
+            auto matrix = parent == NO_PARENT
+                ? glm::mat4{1.f}
+                : scene.world_matrices[parent];
+            if (ops_begin != scene.ops.size()) {
+                matrix *= scene.static_matrices[scene.ops[ops_begin].index];
+            }
+            scene.world_matrices[group] = matrix;
+        }
+    }
+
+    // Stable, so groups stay in depth-first order within a level.
+    std::ranges::stable_sort(
+        scene.dynamic_groups,
+        std::ranges::less{},
+        [&](u32 const group) { return group_depths[group]; }
+    );
+    for (auto begin = 0_uz; begin < scene.dynamic_groups.size();) {
+        auto const depth = group_depths[scene.dynamic_groups[begin]];
+        auto end = begin;
+        while (end < scene.dynamic_groups.size()
+            and group_depths[scene.dynamic_groups[end]] == depth
+        ) {
+            ++end;
+        }
+        scene.dynamic_levels.push_back({
+            .begin = static_cast<u32>(begin),
+            .end = static_cast<u32>(end),
+        });
+        begin = end;
+    }
+
+    // Children come after their parent, so walking backwards finishes every
+    // subtree before its root.
+    scene.subtree_ends.resize(num_groups);
+    scene.group_bounds.resize(num_groups, EMPTY_SPHERE);
+    for (auto group = num_groups; group-- > 0;) {
+        scene.subtree_ends[group] = std::max(
+            scene.subtree_ends[group], static_cast<u32>(group + 1)
+        );
+
+        auto& bounds = scene.group_bounds[group];
+        auto const [models_begin, models_end] = world.group_models[group];
+        for (auto model = models_begin; model < models_end; ++model) {
+            bounds = merge(bounds, model_bounds(world, model));
+        }
+
+        if (auto const parent = world.group_parents[group];
+            parent != NO_PARENT
+        ) {
+            scene.subtree_ends[parent] = std::max(
+                scene.subtree_ends[parent], scene.subtree_ends[group]
+            );
+            scene.group_bounds[parent] = merge(
+                scene.group_bounds[parent],
+                sweep_bounds(scene, static_cast<u32>(group), bounds)
+            );
+        }
+    }
+
+    scene.orbit_matrices.resize(scene.animations.curve_freqs.size());
+    scene.draws.resize(world.models.size());
+    scene.model_bounds.resize(world.models.size());
+    // Never updated again, only models of dynamic groups move.
+    for (auto group = 0_uz; group < num_groups; ++group) {
+        if (not group_dynamic[group]) {
+            update_models(scene, world, group);
+        }
+    }
+
+    return scene;
+}
+
+auto static update_world_matrix(
+    Scene& scene,
+    World const& world,
+    u32 const group
+) noexcept -> void {
+    auto const parent = world.group_parents[group];
+    auto matrix = parent == NO_PARENT
+        ? glm::mat4{1.f}
+        : scene.world_matrices[parent];
+
+    auto const [begin, end] = scene.group_ops[group];
+    for (auto op = begin; op < end; ++op) {
+        auto const [kind, index] = scene.ops[op];
+        switch (kind) {
+            using enum TransformOp::Kind;
+
+            case Static:
+                matrix *= scene.static_matrices[index];
+                break;
+            case Rotation:
+                matrix *= scene.animations.rotation_matrices[index];
+                break;
+            case Curve:
+                scene.orbit_matrices[index] = matrix;
+                matrix *= scene.animations.curve_matrices[index];
+                break;
+        }
+    }
+    scene.world_matrices[group] = matrix;
+}
+
+namespace {
+
+// What the next update is about, read by the tasks of its graph.
+struct SceneUpdate {
+    Scene* scene;
+    World const* world;
+    float time_ms;
+};
+
+// Built once, every update runs the same tasks.
+auto make_update_graph(SceneUpdate const& update) -> jobs::TaskGraph {
+    auto static constexpr ANIMATION_GRAIN = 256_uz;
+    auto static constexpr GROUP_GRAIN = 256_uz;
+
+    auto graph = jobs::TaskGraph{};
+
+    auto const rotations = graph.add([&update] {
+        auto& animations = update.scene->animations;
+        jobs::get().parallel_for(
+            0,
+            animations.rotation_freqs.size(),
+            ANIMATION_GRAIN,
+            [&](usize const begin, usize const end) {
+                animate_rotations(animations, update.time_ms, begin, end);
+            }
+        );
+    });
+
+    auto const curves = graph.add([&update] {
+        auto& animations = update.scene->animations;
+        jobs::get().parallel_for(
+            0,
+            animations.curve_freqs.size(),
+            ANIMATION_GRAIN,
+            [&](usize const begin, usize const end) {
+                animate_curves(animations, update.time_ms, begin, end);
+            }
+        );
+    });
+
+    // A level only depends on the ones above it.
+    auto const world_matrices = graph.add([&update] {
+        auto& scene = *update.scene;
+        for (auto const [level_begin, level_end] : scene.dynamic_levels) {
+            jobs::get().parallel_for(
+                level_begin,
+                level_end,
+                GROUP_GRAIN,
+                [&](usize const begin, usize const end) {
+                    for (auto i = begin; i < end; ++i) {
+                        update_world_matrix(
+                            scene, *update.world, scene.dynamic_groups[i]
+                        );
+                    }
+                }
+            );
+        }
+    });
+
+    // Static models were placed once and for all by compile_scene.
+    auto const draws = graph.add([&update] {
+        auto& scene = *update.scene;
+        jobs::get().parallel_for(
+            0,
+            scene.dynamic_groups.size(),
+            GROUP_GRAIN,
+            [&](usize const begin, usize const end) {
+                for (auto i = begin; i < end; ++i) {
+                    update_models(
+                        scene, *update.world, scene.dynamic_groups[i]
+                    );
+                }
+            }
+        );
+    });
+
+    // Built on the first update, afterwards only moving models need it.
+    auto const bvh = graph.add([&update] {
+        auto& scene = *update.scene;
+        if (scene.bvh.nodes.empty() or not scene.dynamic_groups.empty()) {
+            refit_bvh(scene.bvh, scene.model_bounds);
+        }
+    });
+
+    graph.precede(rotations, world_matrices);
+    graph.precede(curves, world_matrices);
+    graph.precede(world_matrices, draws);
+    graph.precede(draws, bvh);
+    return graph;
+}
+
+} // namespace
+
+auto update_scene(
+    Scene& scene,
+    World const& world,
+    float const time_ms
+) noexcept -> void {
+    auto static update = SceneUpdate{};
+    auto static graph = make_update_graph(update);
+
+    update = {
+        .scene = &scene,
+        .world = &world,
+        .time_ms = time_ms,
+    };
+    jobs::get().run(graph);
+}
+
+} // namespace engine::render
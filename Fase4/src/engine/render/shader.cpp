@@ -0,0 +1,66 @@
+#include "engine/render/shader.hpp"
+
+#include <array>
+#include <spdlog/spdlog.h>
+
+namespace engine::render {
+
+[[nodiscard]]
+auto static compile_shader(GLenum const type, char const* const src) noexcept
+    -> std::optional<GLuint>
+{
+    auto const shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    auto status = GLint{GL_FALSE};
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        auto log = std::array<char, 1024>{};
+        glGetShaderInfoLog(
+            shader, static_cast<GLsizei>(log.size()), nullptr, log.data()
+        );
+        spdlog::error("shader compilation failed: {}", log.data());
+        glDeleteShader(shader);
+        return {};
+    }
+    return shader;
+}
+
+auto compile_program(
+    char const* const vertex_src,
+    char const* const fragment_src
+) noexcept -> std::optional<GLuint> {
+    auto const vertex = compile_shader(GL_VERTEX_SHADER, vertex_src);
+    if (not vertex.has_value()) {
+        return {};
+    }
+    auto const fragment = compile_shader(GL_FRAGMENT_SHADER, fragment_src);
+    if (not fragment.has_value()) {
+        glDeleteShader(*vertex);
+        return {};
+    }
+
+    auto const program = glCreateProgram();
+    glAttachShader(program, *vertex);
+    glAttachShader(program, *fragment);
+    glLinkProgram(program);
+    // Only actually deleted along with the program.
+    glDeleteShader(*vertex);
+    glDeleteShader(*fragment);
+
+    auto status = GLint{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        auto log = std::array<char, 1024>{};
+        glGetProgramInfoLog(
+            program, static_cast<GLsizei>(log.size()), nullptr, log.data()
+        );
+        spdlog::error("shader linking failed: {}", log.data());
+        glDeleteProgram(program);
+        return {};
+    }
+    return program;
+}
+
+} // namespace engine::render
@@ -0,0 +1,188 @@
+#include "engine/render/simulation.hpp"
+
+#include "engine/config.hpp"
+#include "engine/render/camera.hpp"
+#include "engine/render/culling.hpp"
+#include "engine/render/instancing.hpp"
+#include "engine/render/io_events.hpp"
+#include "engine/render/light_clusters.hpp"
+#include "engine/render/occlusion.hpp"
+#include "engine/render/render_queue.hpp"
+#include "engine/render/scene.hpp"
+#include "engine/render/state.hpp"
+#include "engine/render/texture_loader.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec4.hpp>
+#include <glm/trigonometric.hpp>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace engine::render {
+
+using clock = std::chrono::steady_clock;
+
+auto static simulation_thread = std::jthread{};
+auto static start_time = clock::time_point{};
+auto static next_tick = clock::time_point{};
+auto static occlusion_buffer = OcclusionBuffer{};
+auto static render_queue = RenderQueue{};
+auto static texture_slots = std::vector<TextureSlot>{};
+auto static light_cluster_grid = LightClusterGrid{};
+
+// Produces the frame at time `now` into the back slot and publishes it.
+auto static simulate(clock::time_point const now) noexcept -> void {
+    while (auto const event = state::key_events.try_pop()) {
+        handle_key_event(*event);
+    }
+
+    // The camera moves a fixed amount per tick, so it's stepped at a fixed
+    // rate regardless of how fast frames are produced.
+    auto const tick = std::chrono::milliseconds{config::RENDER_TICK_MILLIS};
+    while (next_tick <= now) {
+        update_camera();
+        next_tick += tick;
+    }
+
+    auto& scene = state::scene;
+    update_scene(
+        scene,
+        *state::world_ptr,
+        std::chrono::duration<float, std::milli>{now - start_time}.count()
+    );
+
+    auto const& camera = *state::camera_ptr;
+    auto const proj = glm::perspective(
+        glm::radians(camera.projection[0]),
+        state::aspect_ratio.load(std::memory_order_relaxed),
+        camera.projection[1],
+        camera.projection[2]
+    );
+
+    // Picked against what was on screen when clicked, near enough.
+    while (auto const event = state::click_events.try_pop()) {
+        auto const inv_view_proj = glm::inverse(
+            proj * glm::lookAt(camera.pos, camera.lookat, camera.up)
+        );
+        auto const unproject = [&](float const z) {
+            auto const point = inv_view_proj * glm::vec4{event->ndc, z, 1.f};
+            return glm::vec3{point} / point.w;
+        };
+        auto const near = unproject(-1.f);
+        focus_model_at(near, unproject(1.f) - near);
+    }
+    track_focused_model();
+
+    auto& frame = state::frames.back();
+    frame.camera = camera;
+    frame.enable_axis = state::enable_axis;
+    frame.enable_lookat_indicator = state::enable_lookat_indicator;
+    frame.polygon_mode = state::polygon_mode;
+    frame.line_width = state::line_width;
+    // Assignment reuses the slot's capacity, so this doesn't allocate after
+    // the first few frames.
+    frame.orbit_matrices = scene.orbit_matrices;
+
+    auto const view = glm::lookAt(camera.pos, camera.lookat, camera.up);
+    cull_scene(
+        scene,
+        *state::world_ptr,
+        make_frustum(proj * view),
+        frame.draws,
+        frame.cull_stats
+    );
+    // Hidden surfaces still show through wireframes.
+    frame.occlusion_stats = {};
+    if (state::enable_occlusion_culling and state::polygon_mode == GL_FILL) {
+        cull_occluded(
+            occlusion_buffer,
+            *state::world_ptr,
+            scene.model_bounds,
+            view,
+            proj,
+            frame.draws,
+            frame.occlusion_stats
+        );
+    }
+    // Taken once, so sorting and batching agree even if textures get packed
+    // in between.
+    read_texture_slots(texture_slots);
+    sort_draws(
+        render_queue,
+        *state::world_ptr,
+        scene,
+        texture_slots,
+        camera.pos,
+        camera.projection[2],
+        frame.draws,
+        frame.render_queue_stats
+    );
+    batch_instances(
+        *state::world_ptr,
+        scene,
+        texture_slots,
+        frame.draws,
+        render_queue.keys,
+        frame.instance_matrices,
+        frame.instance_layers,
+        frame.batches,
+        frame.batch_texture_arrays
+    );
+    measure_texture_arrays(
+        *state::world_ptr,
+        scene,
+        texture_slots,
+        frame.draws,
+        camera.pos,
+        glm::radians(camera.projection[0]),
+        frame.texture_array_sizes
+    );
+    // The fixed function path has no use for them.
+    frame.light_cluster_stats = {};
+    if (state::core_profile) {
+        build_light_clusters(
+            light_cluster_grid,
+            state::world_ptr->lights,
+            view,
+            glm::radians(camera.projection[0]),
+            state::aspect_ratio.load(std::memory_order_relaxed),
+            camera.projection[1],
+            camera.projection[2],
+            frame.light_clusters,
+            frame.light_cluster_stats
+        );
+    }
+    state::frames.publish();
+}
+
+auto start_simulation() -> void {
+    start_time = clock::now();
+    next_tick = start_time;
+    simulate(start_time);
+
+    simulation_thread = std::jthread{[](std::stop_token const stop) {
+        while (not stop.stop_requested()) {
+            // Only one frame ahead of the render thread, producing more would
+            // just be thrown away.
+            state::frames.wait_consumed();
+            if (stop.stop_requested()) {
+                break;
+            }
+            simulate(clock::now());
+        }
+    }};
+}
+
+auto stop_simulation() noexcept -> void {
+    simulation_thread.request_stop();
+    // Unblocks the simulation thread if it's waiting for the render thread.
+    (void) state::frames.acquire();
+    simulation_thread = std::jthread{};
+}
+
+} // namespace engine::render
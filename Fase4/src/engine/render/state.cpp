@@ -1,12 +1,12 @@
 #include "engine/render/state.hpp"
 
 #include "engine/config.hpp"
-#include "engine/render/layout/world/group/group.hpp"
 
 namespace engine::render::state {
 
 bool enable_axis = config::ENABLE_AXIS;
 bool enable_lookat_indicator = config::ENABLE_LOOKAT_INDICATOR;
+bool enable_occlusion_culling = config::ENABLE_OCCLUSION_CULLING;
 
 GLenum polygon_mode = config::DEFAULT_POLYGON_MODE;
 float line_width = config::DEFAULT_LINE_WIDTH;
@@ -19,9 +19,49 @@ ptr::nonnull_ptr<World> world_ptr = ptr::nonnull_ptr_to(default_world_mut);
 Camera default_camera_mut = config::DEFAULT_CAMERA;
 ptr::nonnull_ptr<Camera> camera_ptr = ptr::nonnull_ptr_to(default_camera_mut);
 enum CameraMode camera_mode;
+brief_int::u32 focused_model = NO_MODEL;
 
-std::vector<std::vector<float>> buffers;
+Scene scene = {};
+std::vector<GpuHandle> orbit_buffers;
+GpuHandle axis_buffer;
+GpuHandle lookat_indicator_buffer;
+brief_int::u32 lookat_indicator_num_vertices = 0;
 
-GLuint bind[3][500];
+std::atomic<float> aspect_ratio = static_cast<float>(config::ASPECT_RATIO);
+float viewport_height = static_cast<float>(config::WIN_HEIGHT);
+
+util::TripleBuffer<Frame> frames;
+util::SpscQueue<KeyEvent, 256> key_events;
+util::SpscQueue<ClickEvent, 64> click_events;
+
+GpuHandle mesh_arena;
+VertexLayout vertex_layout = {};
+
+bool core_profile = false;
+
+GLuint mesh_vao = 0;
+GLuint simple_vao = 0;
+GLuint simple_program = 0;
+GLint simple_mvp_location = -1;
+GLint simple_color_location = -1;
+GLuint instanced_program = 0;
+GLint instanced_view_proj_location = -1;
+GLint instanced_color_location = -1;
+GLint instanced_texcoord_min_location = -1;
+GLint instanced_texcoord_scale_location = -1;
+GLint instanced_view_location = -1;
+GLint instanced_octahedral_normals_location = -1;
+GLint instanced_enable_lighting_location = -1;
+GLint instanced_ambient_location = -1;
+GLint instanced_light_bases_location = -1;
+GLint instanced_cluster_grid_location = -1;
+GLint instanced_cluster_scale_location = -1;
+GLint instanced_slice_params_location = -1;
+bool enable_multi_draw = false;
+StreamRing stream_ring = {};
+StreamRing light_ring = {};
+GpuHandle light_texture;
+GpuHandle light_range_texture;
+GpuHandle light_index_texture;
 
 } // namespace engine::render::state
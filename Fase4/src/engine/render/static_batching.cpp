@@ -0,0 +1,290 @@
+#include "engine/render/static_batching.hpp"
+
+#include "engine/config.hpp"
+#include "engine/render/bounds.hpp"
+#include "engine/render/scene.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/matrix.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <iterator>
+#include <limits>
+#include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+// Matrix a model's vertices are drawn with, relative to its group.
+[[nodiscard]]
+auto static model_matrix(World const& world, Model const& model) noexcept
+    -> glm::mat4
+{
+    return model.matrix == NO_MATRIX
+        ? glm::mat4{1.f}
+        : world.model_matrices[model.matrix];
+}
+
+// Meshes without normals, texcoords or tangents get zeroed ones if merged
+// with meshes that have them.
+auto static append_mesh(Mesh& dst, Mesh const& src, glm::mat4 const& matrix)
+    -> void
+{
+    auto const num_vertices = dst.vertices.size();
+    for (auto const& vertex : src.vertices) {
+        dst.vertices.emplace_back(matrix * glm::vec4{vertex, 1.f});
+    }
+
+    if (not src.normals.empty() or not dst.normals.empty()) {
+        dst.normals.resize(num_vertices);
+        auto const normal_matrix = glm::inverseTranspose(glm::mat3{matrix});
+        for (auto const& normal : src.normals) {
+            dst.normals.push_back(glm::normalize(normal_matrix * normal));
+        }
+        dst.normals.resize(dst.vertices.size());
+    }
+
+    if (not src.texcoords.empty() or not dst.texcoords.empty()) {
+        dst.texcoords.resize(num_vertices);
+        dst.texcoords.insert(
+            dst.texcoords.end(), src.texcoords.begin(), src.texcoords.end()
+        );
+        dst.texcoords.resize(dst.vertices.size());
+    }
+
+    if (not src.tangents.empty() or not dst.tangents.empty()) {
+        dst.tangents.resize(num_vertices);
+        auto const tangent_matrix = glm::mat3{matrix};
+        // Mirroring flips the bitangent along with the winding.
+        auto const sign = glm::determinant(tangent_matrix) < 0.f ? -1.f : 1.f;
+        for (auto const& tangent : src.tangents) {
+            auto const direction = tangent_matrix * glm::vec3{tangent};
+            auto const length = glm::length(direction);
+            dst.tangents.emplace_back(
+                length > 0.f ? direction / length : direction,
+                tangent.w * sign
+            );
+        }
+        dst.tangents.resize(dst.vertices.size());
+    }
+}
+
+auto batch_static_models(World& world) -> void {
+    auto const num_groups = static_cast<u32>(world.group_parents.size());
+
+    // Groups are depth-first, so parents are always visited first.
+    auto group_dynamic = std::vector<bool>(num_groups);
+    for (auto group = 0_u32; group < num_groups; ++group) {
+        auto const parent = world.group_parents[group];
+        auto dynamic = parent != NO_PARENT and group_dynamic[parent];
+        auto const [begin, end] = world.group_transforms[group];
+        for (auto transform = begin; transform < end; ++transform) {
+            dynamic = dynamic or is_time_based(world.transforms[transform]);
+        }
+        group_dynamic[group] = dynamic;
+    }
+
+    // Whether nothing at or below a group ever moves.
+    auto subtree_static = std::vector<bool>(num_groups);
+    for (auto group = 0_u32; group < num_groups; ++group) {
+        subtree_static[group] = not group_dynamic[group];
+    }
+    for (auto group = num_groups; group > 0; --group) {
+        auto const parent = world.group_parents[group - 1];
+        if (not subtree_static[group - 1] and parent != NO_PARENT) {
+            subtree_static[parent] = false;
+        }
+    }
+
+    // The group each static group's models are merged into, and the matrix
+    // from the static group's space to its root's.
+    auto batch_roots = std::vector<u32>(num_groups, NO_PARENT);
+    auto root_matrices = std::vector<glm::mat4>(num_groups, glm::mat4{1.f});
+    for (auto group = 0_u32; group < num_groups; ++group) {
+        if (group_dynamic[group]) {
+            continue;
+        }
+        auto const parent = world.group_parents[group];
+        if (not subtree_static[group]
+            or parent == NO_PARENT
+            or not subtree_static[parent]
+        ) {
+            batch_roots[group] = group;
+            continue;
+        }
+
+        auto local = glm::mat4{1.f};
+        auto const [begin, end] = world.group_transforms[group];
+        for (auto transform = begin; transform < end; ++transform) {
+            local *= static_transform_matrix(world.transforms[transform]);
+        }
+        batch_roots[group] = batch_roots[parent];
+        root_matrices[group] = root_matrices[parent] * local;
+    }
+
+    // Instances already share a single draw, merging them would only copy
+    // their mesh once per instance.
+    auto const is_mergeable = [&](u32 const model) {
+        return world.models[model].matrix == NO_MATRIX;
+    };
+
+    auto batch_sizes = std::vector<u32>(num_groups);
+    for (auto group = 0_u32; group < num_groups; ++group) {
+        if (batch_roots[group] != NO_PARENT) {
+            auto const [begin, end] = world.group_models[group];
+            for (auto model = begin; model < end; ++model) {
+                batch_sizes[batch_roots[group]] += is_mergeable(model);
+            }
+        }
+    }
+    auto const is_batched = [&](u32 const group) {
+        auto const root = batch_roots[group];
+        return root != NO_PARENT
+            and batch_sizes[root] >= config::STATIC_BATCH_MIN_MODELS;
+    };
+
+    auto models = std::vector<Model>{};
+    auto model_matrices = std::vector<glm::mat4>{};
+    auto num_merged = 0_uz;
+    auto num_batches = 0_uz;
+
+    // Kept apart until every batch is built, as growing `world.meshes`
+    // would move the meshes being merged.
+    auto merged_meshes = std::vector<Mesh>{};
+    auto merged = Mesh{};
+    auto merged_texture = NO_TEXTURE;
+    auto const flush_merged = [&] {
+        if (merged.vertices.empty()) {
+            return;
+        }
+        merged.bounds = bounding_sphere(merged.vertices);
+        models.push_back({
+            .mesh = static_cast<u32>(
+                world.meshes.size() + merged_meshes.size()
+            ),
+            .matrix = NO_MATRIX,
+            .texture = merged_texture,
+        });
+        merged_meshes.push_back(std::exchange(merged, Mesh{}));
+        num_batches += 1;
+    };
+
+    // Models of a batch, as {member group, model}.
+    auto batch_models = std::vector<std::pair<u32, u32>>{};
+
+    for (auto group = 0_u32; group < num_groups; ++group) {
+        auto const models_begin = static_cast<u32>(models.size());
+        auto const root = batch_roots[group];
+
+        if (not is_batched(group)) {
+            auto const [begin, end] = world.group_models[group];
+            for (auto model = begin; model < end; ++model) {
+                auto [mesh, matrix, texture] = world.models[model];
+                if (matrix != NO_MATRIX) {
+                    model_matrices.push_back(world.model_matrices[matrix]);
+                    matrix = static_cast<u32>(model_matrices.size() - 1);
+                }
+                models.push_back({
+                    .mesh = mesh,
+                    .matrix = matrix,
+                    .texture = texture,
+                });
+            }
+        } else if (root == group) {
+            // Descendants come right after their ancestors, so the whole
+            // batch is this run of groups. They're all drawn by the root.
+            batch_models.clear();
+            for (
+                auto member = group;
+                member < num_groups and batch_roots[member] == root;
+                ++member
+            ) {
+                auto const [begin, end] = world.group_models[member];
+                for (auto model = begin; model < end; ++model) {
+                    if (is_mergeable(model)) {
+                        batch_models.emplace_back(member, model);
+                        continue;
+                    }
+                    // Kept instanced, moved into the root's space.
+                    auto const& [mesh, matrix, texture] = world.models[model];
+                    model_matrices.push_back(
+                        root_matrices[member] * world.model_matrices[matrix]
+                    );
+                    models.push_back({
+                        .mesh = mesh,
+                        .matrix = static_cast<u32>(model_matrices.size() - 1),
+                        .texture = texture,
+                    });
+                }
+            }
+            // Only models sharing a texture can share a mesh.
+            std::ranges::stable_sort(batch_models, {}, [&](auto const& entry) {
+                return world.models[entry.second].texture;
+            });
+
+            for (auto const& [member, model] : batch_models) {
+                auto const& mesh = world.meshes[world.models[model].mesh];
+                auto const texture = world.models[model].texture;
+                if (texture != merged_texture
+                    or merged.vertices.size() + mesh.vertices.size()
+                        > config::STATIC_BATCH_MAX_VERTICES
+                ) {
+                    flush_merged();
+                    merged_texture = texture;
+                }
+                append_mesh(
+                    merged,
+                    mesh,
+                    root_matrices[member]
+                        * model_matrix(world, world.models[model])
+                );
+            }
+            num_merged += batch_models.size();
+            flush_merged();
+        }
+
+        world.group_models[group] = {
+            .begin = models_begin,
+            .end = static_cast<u32>(models.size()),
+        };
+    }
+
+    world.meshes.insert(
+        world.meshes.end(),
+        std::make_move_iterator(merged_meshes.begin()),
+        std::make_move_iterator(merged_meshes.end())
+    );
+
+    // Meshes only used by merged models aren't needed anymore.
+    auto constexpr NO_MESH = std::numeric_limits<u32>::max();
+    auto mesh_remap = std::vector<u32>(world.meshes.size(), NO_MESH);
+    auto meshes = std::vector<Mesh>{};
+    for (auto& model : models) {
+        if (mesh_remap[model.mesh] == NO_MESH) {
+            mesh_remap[model.mesh] = static_cast<u32>(meshes.size());
+            meshes.push_back(std::move(world.meshes[model.mesh]));
+        }
+        model.mesh = mesh_remap[model.mesh];
+    }
+
+    spdlog::info(
+        "merged {} static models into {} batches, {} models left.",
+        num_merged,
+        num_batches,
+        models.size()
+    );
+    world.models = std::move(models);
+    world.model_matrices = std::move(model_matrices);
+    world.meshes = std::move(meshes);
+}
+
+} // namespace engine::render
@@ -0,0 +1,122 @@
+#include "engine/render/stream_ring.hpp"
+
+#include "engine/render/gl_state.hpp"
+
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+// Keeps every region's offset aligned for any attribute or command.
+auto static constexpr REGION_ALIGNMENT = 256_uz;
+
+auto static wait_fence(GLsync& fence) noexcept -> void {
+    if (fence == nullptr) {
+        return;
+    }
+
+    auto constexpr TIMEOUT_NS = GLuint64{1'000'000'000};
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, TIMEOUT_NS)
+        == GL_TIMEOUT_EXPIRED
+    ) {
+        spdlog::warn("still waiting on the GPU for a stream region.");
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+auto static create_storage(StreamRing& ring) noexcept -> void {
+    for (auto& fence : ring.fences) {
+        wait_fence(fence);
+    }
+
+    auto const size = ring.region_size * StreamRing::NUM_REGIONS;
+    ring.buffer = create_gpu_buffer(GpuCategory::STREAMING, size);
+    ring.mapped = nullptr;
+    bind_buffer(GL_ARRAY_BUFFER, ring.buffer.get());
+
+    if (GLEW_ARB_buffer_storage) {
+        auto constexpr flags = GLbitfield{
+            GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
+        };
+        glBufferStorage(
+            GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags
+        );
+        ring.mapped = static_cast<std::byte*>(glMapBufferRange(
+            GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(size), flags
+        ));
+    } else {
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            static_cast<GLsizeiptr>(size),
+            nullptr,
+            GL_STREAM_DRAW
+        );
+    }
+}
+
+auto init_stream_ring(StreamRing& ring, usize const region_size) noexcept
+    -> void
+{
+    ring.region_size = (region_size + REGION_ALIGNMENT - 1)
+        / REGION_ALIGNMENT * REGION_ALIGNMENT;
+    ring.region = 0;
+    ring.fences = {};
+    create_storage(ring);
+    if (ring.mapped == nullptr) {
+        spdlog::warn("buffer storage unavailable, streaming with copies.");
+    }
+}
+
+auto begin_stream_frame(StreamRing& ring, usize const size) noexcept
+    -> usize
+{
+    if (size > ring.region_size) {
+        auto region_size = ring.region_size;
+        while (region_size < size) {
+            region_size *= 2;
+        }
+        ring.region_size = region_size;
+        create_storage(ring);
+    }
+
+    ring.region = (ring.region + 1) % StreamRing::NUM_REGIONS;
+    wait_fence(ring.fences[ring.region]);
+    return ring.region * ring.region_size;
+}
+
+auto stream_write(
+    StreamRing& ring,
+    usize const offset,
+    void const* const data,
+    usize const size
+) noexcept -> void {
+    if (size == 0) {
+        return;
+    }
+
+    auto const buffer_offset = ring.region * ring.region_size + offset;
+    if (ring.mapped != nullptr) {
+        std::memcpy(ring.mapped + buffer_offset, data, size);
+    } else {
+        bind_buffer(GL_ARRAY_BUFFER, ring.buffer.get());
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            static_cast<GLintptr>(buffer_offset),
+            static_cast<GLsizeiptr>(size),
+            data
+        );
+    }
+}
+
+auto end_stream_frame(StreamRing& ring) noexcept -> void {
+    if (ring.mapped != nullptr) {
+        ring.fences[ring.region]
+            = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+} // namespace engine::render
@@ -0,0 +1,338 @@
+#include "engine/render/texture_cache.hpp"
+
+#include "engine/config.hpp"
+#include "util/cache_file.hpp"
+#include "util/hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+#include <exception>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+// Bumped whenever decoding, mipmapping, compression or the layout change.
+auto constexpr VERSION = 1_u32;
+auto constexpr MAGIC = 0x43584554_u32; // "TEXC".
+auto constexpr MAX_LEVELS = 32_u32;
+auto constexpr DATA_ALIGNMENT = 16_uz;
+
+// Followed by the levels, then the texel data at `data_offset`.
+struct FileHeader {
+    util::CacheHeader cache;
+    u32 format;
+    u32 num_levels;
+};
+
+struct FileLevel {
+    u32 width;
+    u32 height;
+    u64 offset; // from the start of the texel data.
+    u64 size;
+};
+
+auto data_offset(usize const num_levels) noexcept -> usize {
+    auto const end = sizeof(FileHeader) + sizeof(FileLevel) * num_levels;
+    return (end + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+}
+
+auto cache_path(u64 const key) -> std::filesystem::path {
+    return std::filesystem::path{config::TEXTURE_CACHE_DIR}
+        / fmt::format("{:016x}.tex", key);
+}
+
+using Color = std::array<i32, 3>;
+
+auto to_rgb565(Color const& color) noexcept -> u16 {
+    return static_cast<u16>(
+        (color[0] >> 3) << 11 | (color[1] >> 2) << 5 | color[2] >> 3
+    );
+}
+
+// Low bits repeat the high ones, so 0 and 255 stay exact.
+auto from_rgb565(u16 const packed) noexcept -> Color {
+    auto const r = packed >> 11 & 31;
+    auto const g = packed >> 5 & 63;
+    auto const b = packed & 31;
+    return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+}
+
+auto distance_squared(Color const& a, Color const& b) noexcept -> i32 {
+    auto const dr = a[0] - b[0];
+    auto const dg = a[1] - b[1];
+    auto const db = a[2] - b[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+// Endpoints at the corners of the block's bounding box, pulled slightly
+// inwards, then every texel snapped to the nearest of the 4 colors.
+auto encode_block(std::array<Color, 16> const& texels, std::byte* const out)
+    noexcept -> void
+{
+    auto low = Color{255, 255, 255};
+    auto high = Color{0, 0, 0};
+    for (auto const& texel : texels) {
+        for (auto channel = 0_uz; channel < 3; ++channel) {
+            low[channel] = std::min(low[channel], texel[channel]);
+            high[channel] = std::max(high[channel], texel[channel]);
+        }
+    }
+    for (auto channel = 0_uz; channel < 3; ++channel) {
+        auto const inset = (high[channel] - low[channel]) / 16;
+        low[channel] += inset;
+        high[channel] -= inset;
+    }
+
+    auto color0 = to_rgb565(high);
+    auto color1 = to_rgb565(low);
+    // color0 > color1 selects the 4 color mode.
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+
+    auto indices = 0_u32;
+    if (color0 != color1) {
+        auto const c0 = from_rgb565(color0);
+        auto const c1 = from_rgb565(color1);
+        auto palette = std::array<Color, 4>{c0, c1, Color{}, Color{}};
+        for (auto channel = 0_uz; channel < 3; ++channel) {
+            palette[2][channel] = (2 * c0[channel] + c1[channel]) / 3;
+            palette[3][channel] = (c0[channel] + 2 * c1[channel]) / 3;
+        }
+
+        for (auto texel = 0_u32; texel < 16; ++texel) {
+            auto best = 0_u32;
+            for (auto index = 1_u32; index < 4; ++index) {
+                if (distance_squared(texels[texel], palette[index])
+                    < distance_squared(texels[texel], palette[best])
+                ) {
+                    best = index;
+                }
+            }
+            indices |= best << (2 * texel);
+        }
+    }
+
+    std::memcpy(out, &color0, sizeof(color0));
+    std::memcpy(out + 2, &color1, sizeof(color1));
+    std::memcpy(out + 4, &indices, sizeof(indices));
+}
+
+auto bc1_size(u32 const width, u32 const height) noexcept -> usize {
+    auto constexpr BLOCK_SIZE = 8_uz;
+    return BLOCK_SIZE * ((width + 3) / 4) * ((height + 3) / 4);
+}
+
+// In bytes, of a level `width` by `height` texels.
+auto level_size(TexelFormat const format, u32 const width, u32 const height)
+    noexcept -> usize
+{
+    switch (format) {
+        case TexelFormat::RGBA8:
+            return 4_uz * width * height;
+        case TexelFormat::BC1:
+            return bc1_size(width, height);
+    }
+    return 0;
+}
+
+} // namespace
+
+auto TextureData::bytes() const noexcept -> std::span<std::byte const> {
+    return pixels.empty() ? mapping.bytes() : std::span{pixels};
+}
+
+auto texture_cache_key(std::span<char const> const source, bool const compress)
+    noexcept -> u64
+{
+    auto hash = util::hash_bytes(
+        util::FNV_OFFSET_BASIS, std::as_bytes(source)
+    );
+    hash = util::hash_value(hash, VERSION);
+    return util::hash_value(hash, compress);
+}
+
+auto read_cached_texture(u64 const key) noexcept -> std::optional<TextureData>
+try {
+    auto mapping = util::MappedFile::open(cache_path(key).string());
+    if (not mapping.has_value()) {
+        return std::nullopt;
+    }
+    auto const bytes = mapping->bytes();
+
+    auto header = FileHeader{};
+    if (bytes.size() < sizeof(header)
+        or not util::matches_cache_header(bytes, {MAGIC, VERSION, key})
+    ) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.format > static_cast<u32>(TexelFormat::BC1)
+        or header.num_levels == 0
+        or header.num_levels > MAX_LEVELS
+    ) {
+        return std::nullopt;
+    }
+
+    auto const begin = data_offset(header.num_levels);
+    if (bytes.size() < begin) {
+        return std::nullopt;
+    }
+    auto data = TextureData {
+        .format = static_cast<TexelFormat>(header.format),
+        .levels = {},
+        .pixels = {},
+        .mapping = {},
+    };
+    for (auto level = 0_u32; level < header.num_levels; ++level) {
+        auto file_level = FileLevel{};
+        std::memcpy(
+            &file_level,
+            bytes.data() + sizeof(header) + sizeof(file_level) * level,
+            sizeof(file_level)
+        );
+        // Anything pointing past the end, or levels that don't halve down
+        // from the finest one, mean a truncated or foreign file.
+        auto const available = bytes.size() - begin;
+        if (file_level.offset > available
+            or file_level.size > available - file_level.offset
+        ) {
+            return std::nullopt;
+        }
+        if (level == 0
+            ? file_level.width == 0 or file_level.height == 0
+            : file_level.width
+                    != std::max(data.levels.back().width / 2, 1_u32)
+                or file_level.height
+                    != std::max(data.levels.back().height / 2, 1_u32)
+        ) {
+            return std::nullopt;
+        }
+        if (file_level.size
+            != level_size(data.format, file_level.width, file_level.height)
+        ) {
+            return std::nullopt;
+        }
+        data.levels.push_back({
+            .width = file_level.width,
+            .height = file_level.height,
+            .offset = begin + file_level.offset,
+            .size = file_level.size,
+        });
+    }
+    data.mapping = std::move(*mapping);
+    return data;
+
+} catch (...) {
+    return std::nullopt;
+}
+
+auto write_cached_texture(u64 const key, TextureData const& data) noexcept
+    -> void
+try {
+    auto const bytes = data.bytes();
+    auto const begin = data.levels.front().offset;
+    auto const header = FileHeader {
+        .cache = {.magic = MAGIC, .version = VERSION, .key = key},
+        .format = static_cast<u32>(data.format),
+        .num_levels = static_cast<u32>(data.levels.size()),
+    };
+    auto levels = std::vector<FileLevel>{};
+    for (auto const& level : data.levels) {
+        levels.push_back({
+            .width = level.width,
+            .height = level.height,
+            .offset = level.offset - begin,
+            .size = level.size,
+        });
+    }
+    auto constexpr ZEROS = std::array<std::byte, DATA_ALIGNMENT>{};
+    auto const padding = data_offset(data.levels.size())
+        - sizeof(header)
+        - sizeof(FileLevel) * data.levels.size();
+
+    auto const chunks = std::array {
+        std::as_bytes(std::span{&header, 1}),
+        std::as_bytes(std::span{levels}),
+        std::span{ZEROS}.first(padding),
+        bytes.subspan(begin),
+    };
+    auto const path = cache_path(key);
+    if (not util::write_file_atomically(path, chunks)) {
+        spdlog::debug("couldn't cache {}.", path.string());
+    }
+
+} catch (std::exception const& e) {
+    spdlog::debug("couldn't cache texture {:016x}: {}.", key, e.what());
+}
+
+auto compress_bc1(TextureData& data) -> bool {
+    if (data.format != TexelFormat::RGBA8) {
+        return false;
+    }
+    auto const src = data.bytes();
+    auto const& finest = data.levels.front();
+    for (auto texel = 0_uz; texel < finest.size / 4; ++texel) {
+        if (src[finest.offset + 4 * texel + 3] != std::byte{255}) {
+            return false;
+        }
+    }
+
+    auto levels = std::vector<MipLevel>{};
+    auto size = 0_uz;
+    for (auto const& level : data.levels) {
+        levels.push_back({
+            .width = level.width,
+            .height = level.height,
+            .offset = size,
+            .size = bc1_size(level.width, level.height),
+        });
+        size += levels.back().size;
+    }
+
+    auto pixels = std::vector<std::byte>(size);
+    for (auto index = 0_uz; index < levels.size(); ++index) {
+        auto const& level = data.levels[index];
+        auto* out = pixels.data() + levels[index].offset;
+        // Edge blocks repeat the last row and column.
+        for (auto block_y = 0_u32; block_y < level.height; block_y += 4) {
+            for (auto block_x = 0_u32; block_x < level.width; block_x += 4) {
+                auto texels = std::array<Color, 16>{};
+                for (auto texel = 0_u32; texel < 16; ++texel) {
+                    auto const x
+                        = std::min(block_x + texel % 4, level.width - 1);
+                    auto const y
+                        = std::min(block_y + texel / 4, level.height - 1);
+                    auto const* const rgba = src.data() + level.offset
+                        + 4 * (static_cast<usize>(y) * level.width + x);
+                    texels[texel] = {
+                        static_cast<i32>(rgba[0]),
+                        static_cast<i32>(rgba[1]),
+                        static_cast<i32>(rgba[2]),
+                    };
+                }
+                encode_block(texels, out);
+                out += 8;
+            }
+        }
+    }
+
+    data.format = TexelFormat::BC1;
+    data.levels = std::move(levels);
+    data.pixels = std::move(pixels);
+    data.mapping = {};
+    return true;
+}
+
+} // namespace engine::render
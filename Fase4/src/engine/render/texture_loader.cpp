@@ -0,0 +1,948 @@
+#include "engine/render/texture_loader.hpp"
+
+#include "engine/config.hpp"
+#include "engine/render/gl_state.hpp"
+#include "engine/render/gpu_resources.hpp"
+#include "engine/render/stream_ring.hpp"
+#include "engine/render/texture_cache.hpp"
+#include "util/downsample.hpp"
+
+#include <IL/il.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <glm/geometric.hpp>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+auto constexpr BYTES_PER_PIXEL = 4_uz; // RGBA8.
+
+// Packs an array and a layer into one atomic.
+auto constexpr LAYER_BITS = 16_u32;
+auto constexpr NO_SLOT = std::numeric_limits<u32>::max();
+
+// Decoded by a loader thread, waiting to be packed.
+struct Image {
+    u32 texture;
+    u32 generation;
+    std::string file;
+    bool failed;
+    TextureData data;
+};
+
+struct Request {
+    u32 texture;
+    u32 generation;
+    std::string file;
+    bool compress; // to BC1, decided on the render thread.
+};
+
+enum class TextureState : u8 {
+    LOADING,
+    UPLOADING,
+    RESIDENT,
+    FAILED,
+};
+
+// Same sized textures, one per layer, bound and sampled as a whole.
+// Without arrays, a plain 2D texture holding a single one.
+// Levels are streamed in from the coarsest and dropped from the finest, so
+// the resident ones always run from `base` to the last.
+struct TextureArray {
+    GpuHandle handle;
+    std::vector<u32> textures; // by layer.
+    std::vector<TextureData> layers; // kept to stream levels in again.
+    u32 num_levels;
+    u32 tail; // levels from here on are never dropped.
+    u32 base; // finest level fully uploaded, num_levels while none are.
+    u32 next_layer; // of level `base - 1`, if partially uploaded.
+    usize size; // of the levels with storage, in bytes.
+};
+
+struct Loader {
+    // Shared with the loader threads.
+    std::mutex mutex;
+    std::condition_variable_any wake_up;
+    std::deque<Request> requests;
+    std::vector<Image> decoded;
+    u32 generation; // of the current textures, older images are dropped.
+
+    // DevIL keeps its state in globals, so only one thread decodes at once.
+    // Reading files and building mipmaps still happen in parallel.
+    std::mutex devil_mutex;
+    std::vector<std::jthread> threads;
+
+    // Written by the render thread, read by the simulation thread.
+    // Sized before either starts drawing.
+    std::vector<std::atomic<u32>> slots;
+
+    // Render thread only.
+    std::vector<TextureState> states;
+    GLenum target; // GL_TEXTURE_2D_ARRAY, or GL_TEXTURE_2D without arrays.
+    std::vector<Image> unpacked; // decoded since the last frame.
+    usize num_packed;
+    usize num_failed;
+    std::vector<TextureArray> arrays;
+    usize resident_size; // over every array, in bytes.
+    GpuHandle placeholder;
+    GLenum placeholder_target;
+    StreamRing ring;
+    bool ring_ready;
+};
+
+auto loader() noexcept -> Loader& {
+    // Never destroyed, since its handles must outlive the GL context.
+    auto static& lazy_static = *new Loader{};
+    return lazy_static;
+}
+
+// Down to 1x1, every level half the size of the one before, rounded down.
+auto layout_levels(u32 width, u32 height, std::vector<MipLevel>& levels)
+    -> usize
+{
+    auto offset = 0_uz;
+    while (true) {
+        levels.push_back({
+            .width = width,
+            .height = height,
+            .offset = offset,
+            .size = BYTES_PER_PIXEL * width * height,
+        });
+        offset += levels.back().size;
+        if (width == 1 and height == 1) {
+            return offset;
+        }
+        width = std::max(width / 2, 1_u32);
+        height = std::max(height / 2, 1_u32);
+    }
+}
+
+// Box filter over the 2x2 texels under each, widened to 3 at the last row
+// and column of odd sized levels so none of them are left out.
+auto build_mipmaps(TextureData& data) noexcept -> void {
+    auto* const pixels = reinterpret_cast<u8*>(data.pixels.data());
+    for (auto level = 1_uz; level < data.levels.size(); ++level) {
+        auto const& src = data.levels[level - 1];
+        auto const& dst = data.levels[level];
+        for (auto y = 0_u32; y < dst.height; ++y) {
+            auto const [y_begin, y_end]
+                = util::downsample_footprint(y, dst.height, src.height);
+            for (auto x = 0_u32; x < dst.width; ++x) {
+                auto const [x_begin, x_end]
+                    = util::downsample_footprint(x, dst.width, src.width);
+                auto const count = (y_end - y_begin) * (x_end - x_begin);
+                auto sums = std::array<u32, BYTES_PER_PIXEL>{};
+                for (auto sy = y_begin; sy < y_end; ++sy) {
+                    auto const row = static_cast<usize>(sy) * src.width;
+                    for (auto sx = x_begin; sx < x_end; ++sx) {
+                        auto const* const texel = pixels + src.offset
+                            + BYTES_PER_PIXEL * (row + sx);
+                        for (auto c = 0_uz; c < BYTES_PER_PIXEL; ++c) {
+                            sums[c] += texel[c];
+                        }
+                    }
+                }
+
+                auto const row = static_cast<usize>(y) * dst.width;
+                auto* const out
+                    = pixels + dst.offset + BYTES_PER_PIXEL * (row + x);
+                for (auto c = 0_uz; c < BYTES_PER_PIXEL; ++c) {
+                    out[c] = static_cast<u8>((sums[c] + count / 2) / count);
+                }
+            }
+        }
+    }
+}
+
+// Leaves `image` with its finest level filled in.
+auto decode(std::vector<char> const& data, TextureData& image) -> bool {
+    auto& l = loader();
+    auto const lock = std::scoped_lock{l.devil_mutex};
+
+    auto name = ILuint{0};
+    ilGenImages(1, &name);
+    ilBindImage(name);
+    auto const size = static_cast<ILuint>(data.size());
+    auto const decoded = ilLoadL(IL_TYPE_UNKNOWN, data.data(), size)
+        and ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+    if (decoded) {
+        auto const width = static_cast<u32>(ilGetInteger(IL_IMAGE_WIDTH));
+        auto const height = static_cast<u32>(ilGetInteger(IL_IMAGE_HEIGHT));
+        image.pixels.resize(layout_levels(width, height, image.levels));
+        std::memcpy(image.pixels.data(), ilGetData(), image.levels[0].size);
+    }
+    ilDeleteImages(1, &name);
+    return decoded;
+}
+
+auto load_image(Request request) noexcept -> Image {
+    auto image = Image {
+        .texture = request.texture,
+        .generation = request.generation,
+        .file = std::move(request.file),
+        .failed = true,
+        .data = {},
+    };
+
+    try {
+        auto file = std::ifstream{image.file, std::ios::binary};
+        if (not file) {
+            return image;
+        }
+        auto const data = std::vector<char> {
+            std::istreambuf_iterator<char>{file},
+            std::istreambuf_iterator<char>{},
+        };
+        if (file.bad()) {
+            return image;
+        }
+
+        auto const key = texture_cache_key(data, request.compress);
+        if (auto cached = read_cached_texture(key)) {
+            image.data = std::move(*cached);
+            image.failed = false;
+            return image;
+        }
+
+        image.data.format = TexelFormat::RGBA8;
+        if (not decode(data, image.data)) {
+            return image;
+        }
+        build_mipmaps(image.data);
+        if (request.compress) {
+            compress_bc1(image.data);
+        }
+        write_cached_texture(key, image.data);
+        image.failed = false;
+    } catch (std::bad_alloc const&) {
+        image.data = {};
+    } catch (std::length_error const&) {
+        image.data = {};
+    }
+    return image;
+}
+
+auto run_loader_thread(std::stop_token const stop) noexcept -> void {
+    auto& l = loader();
+    while (true) {
+        auto request = Request{};
+        {
+            auto lock = std::unique_lock{l.mutex};
+            if (not l.wake_up.wait(lock, stop, [&] {
+                return not l.requests.empty();
+            })) {
+                return;
+            }
+            request = std::move(l.requests.front());
+            l.requests.pop_front();
+        }
+
+        auto image = load_image(std::move(request));
+        auto const lock = std::scoped_lock{l.mutex};
+        if (image.generation == l.generation) {
+            l.decoded.push_back(std::move(image));
+        }
+    }
+}
+
+auto is_array(GLenum const target) noexcept -> bool {
+    return target == GL_TEXTURE_2D_ARRAY;
+}
+
+// Of every layer together.
+auto level_size(TextureArray const& array, u32 const level) noexcept
+    -> usize
+{
+    return array.layers.front().levels[level].size * array.layers.size();
+}
+
+auto set_base_level(
+    GLenum const target,
+    TextureArray& array,
+    u32 const base
+) noexcept -> void {
+    array.base = base;
+    bind_texture(0, target, array.handle.get());
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(base));
+}
+
+// Storage for `level` of every layer, left undefined until uploaded.
+auto allocate_level(Loader& l, TextureArray& array, u32 const level)
+    noexcept -> void
+{
+    auto const target = l.target;
+    auto const& first = array.layers.front();
+    auto const& mip = first.levels[level];
+    auto const gl_level = static_cast<GLint>(level);
+    auto const width = static_cast<GLsizei>(mip.width);
+    auto const height = static_cast<GLsizei>(mip.height);
+    auto const layers = static_cast<GLsizei>(array.layers.size());
+    auto const compressed = first.format == TexelFormat::BC1;
+
+    bind_texture(0, target, array.handle.get());
+    if (is_array(target) and compressed) {
+        glCompressedTexImage3D(
+            target,
+            gl_level,
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+            width,
+            height,
+            layers,
+            0,
+            static_cast<GLsizei>(level_size(array, level)),
+            nullptr
+        );
+    } else if (is_array(target)) {
+        glTexImage3D(
+            target,
+            gl_level,
+            GL_RGBA8,
+            width,
+            height,
+            layers,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            nullptr
+        );
+    } else if (compressed) {
+        glCompressedTexImage2D(
+            target,
+            gl_level,
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+            width,
+            height,
+            0,
+            static_cast<GLsizei>(mip.size),
+            nullptr
+        );
+    } else {
+        glTexImage2D(
+            target,
+            gl_level,
+            GL_RGBA8,
+            width,
+            height,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            nullptr
+        );
+    }
+
+    array.size += level_size(array, level);
+    array.handle.set_size(array.size);
+    l.resident_size += level_size(array, level);
+}
+
+// Frees `level` by shrinking it to nothing.
+// Levels below the base don't count towards completeness, whatever their
+// format.
+auto free_level(Loader& l, TextureArray& array, u32 const level) noexcept
+    -> void
+{
+    auto const target = l.target;
+    bind_texture(0, target, array.handle.get());
+    if (is_array(target)) {
+        glTexImage3D(
+            target,
+            static_cast<GLint>(level),
+            GL_RGBA8,
+            0,
+            0,
+            0,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            nullptr
+        );
+    } else {
+        glTexImage2D(
+            target,
+            static_cast<GLint>(level),
+            GL_RGBA8,
+            0,
+            0,
+            0,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            nullptr
+        );
+    }
+
+    array.size -= level_size(array, level);
+    array.handle.set_size(array.size);
+    l.resident_size -= level_size(array, level);
+}
+
+// Stops sampling the finest level, then frees it.
+auto drop_level(Loader& l, TextureArray& array) noexcept -> void {
+    auto const level = array.base;
+    set_base_level(l.target, array, level + 1);
+    free_level(l, array, level);
+}
+
+// Gives up on the partially uploaded level, which was never sampled, so it
+// starts over from its first layer if it's wanted again.
+auto abandon_level(Loader& l, TextureArray& array) noexcept -> void {
+    free_level(l, array, array.base - 1);
+    array.next_layer = 0;
+}
+
+// One level of one layer, from the bound pixel buffer.
+auto upload_level(
+    GLenum const target,
+    TextureArray const& array,
+    u32 const level,
+    u32 const layer,
+    void const* const pixels
+) noexcept -> void {
+    auto const& data = array.layers[layer];
+    auto const& mip = data.levels[level];
+    auto const gl_level = static_cast<GLint>(level);
+    auto const width = static_cast<GLsizei>(mip.width);
+    auto const height = static_cast<GLsizei>(mip.height);
+    auto const compressed = data.format == TexelFormat::BC1;
+    if (is_array(target) and compressed) {
+        glCompressedTexSubImage3D(
+            target,
+            gl_level,
+            0,
+            0,
+            static_cast<GLint>(layer),
+            width,
+            height,
+            1,
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+            static_cast<GLsizei>(mip.size),
+            pixels
+        );
+    } else if (is_array(target)) {
+        glTexSubImage3D(
+            target,
+            gl_level,
+            0,
+            0,
+            static_cast<GLint>(layer),
+            width,
+            height,
+            1,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            pixels
+        );
+    } else if (compressed) {
+        glCompressedTexSubImage2D(
+            target,
+            gl_level,
+            0,
+            0,
+            width,
+            height,
+            GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+            static_cast<GLsizei>(mip.size),
+            pixels
+        );
+    } else {
+        glTexSubImage2D(
+            target,
+            gl_level,
+            0,
+            0,
+            width,
+            height,
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            pixels
+        );
+    }
+}
+
+// A single white texel, which every layer index clamps to.
+auto create_placeholder(GLenum const target) noexcept -> GpuHandle {
+    return create_gpu_texture(
+        GpuCategory::TEXTURES,
+        BYTES_PER_PIXEL,
+        [target](GLuint const texture) {
+            auto constexpr WHITE = std::array<u8, BYTES_PER_PIXEL>{
+                255, 255, 255, 255
+            };
+            bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            bind_texture(0, target, texture);
+            if (is_array(target)) {
+                glTexImage3D(
+                    target,
+                    0,
+                    GL_RGBA8,
+                    1,
+                    1,
+                    1,
+                    0,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    WHITE.data()
+                );
+            } else {
+                glTexImage2D(
+                    target,
+                    0,
+                    GL_RGBA8,
+                    1,
+                    1,
+                    0,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    WHITE.data()
+                );
+            }
+            glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+    );
+}
+
+// An empty texture for `array`, with no level allocated yet.
+auto create_array(Loader& l, TextureArray& array) noexcept -> void {
+    auto const target = l.target;
+    auto const& levels = array.layers.front().levels;
+    array.num_levels = static_cast<u32>(levels.size());
+    array.tail = array.num_levels - 1;
+    while (array.tail > 0) {
+        auto const& finer = levels[array.tail - 1];
+        if (std::max(finer.width, finer.height)
+            > config::TEXTURE_STREAMING_TAIL_SIZE
+        ) {
+            break;
+        }
+        array.tail -= 1;
+    }
+    array.base = array.num_levels;
+    array.next_layer = 0;
+    array.size = 0;
+
+    array.handle = create_gpu_texture(GpuCategory::TEXTURES, 0, {});
+    bind_texture(0, target, array.handle.get());
+    glTexParameteri(
+        target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(array.num_levels - 1)
+    );
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+// Groups the textures decoded since the last frame into new arrays of the
+// same format, size and number of levels, so each starts streaming in as
+// soon as it's ready instead of waiting for the slowest one.
+// Only those decoded together share an array, since a texture's size is
+// unknown until then and arrays can't grow once their storage exists.
+auto pack_textures(Loader& l) noexcept -> void {
+    auto max_layers = GLint{1};
+    if (is_array(l.target)) {
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    }
+
+    auto const shape = [](Image const& image) {
+        auto const& finest = image.data.levels.front();
+        return std::tuple {
+            image.data.format,
+            finest.width,
+            finest.height,
+            image.data.levels.size(),
+        };
+    };
+    std::ranges::sort(l.unpacked, {}, [&](Image const& image) {
+        return std::pair{shape(image), image.texture};
+    });
+
+    auto end = 0_uz;
+    for (auto begin = 0_uz; begin < l.unpacked.size(); begin = end) {
+        end = begin + 1;
+        while (end < l.unpacked.size()
+            and end - begin < static_cast<usize>(max_layers)
+            and shape(l.unpacked[end]) == shape(l.unpacked[begin])
+        ) {
+            end += 1;
+        }
+
+        auto const array = static_cast<u32>(l.arrays.size());
+        auto& packed = l.arrays.emplace_back();
+        for (auto index = begin; index < end; ++index) {
+            auto& image = l.unpacked[index];
+            auto const layer = static_cast<u32>(index - begin);
+            packed.textures.push_back(image.texture);
+            packed.layers.push_back(std::move(image.data));
+            l.states[image.texture] = TextureState::UPLOADING;
+            l.slots[image.texture].store(
+                array << LAYER_BITS | layer, std::memory_order_relaxed
+            );
+        }
+        create_array(l, packed);
+    }
+
+    l.num_packed += l.unpacked.size();
+    l.unpacked.clear();
+    if (l.num_packed + l.num_failed == l.states.size()) {
+        spdlog::info(
+            "packed {} textures into {} {}.",
+            l.num_packed,
+            l.arrays.size(),
+            is_array(l.target) ? "arrays" : "textures"
+        );
+    }
+}
+
+// Finest level worth having for something `pixels` tall on screen, never
+// past the tail.
+// A sphere shows about half of its texture's width across.
+auto wanted_level(TextureArray const& array, float const pixels) noexcept
+    -> u32
+{
+    auto const width = array.layers.front().levels.front().width;
+    auto const texels = 0.5f * static_cast<float>(width);
+    if (pixels <= 0.f) {
+        return array.tail;
+    }
+    if (texels <= pixels) {
+        return 0;
+    }
+    auto const level = static_cast<u32>(std::floor(std::log2(texels / pixels)));
+    return std::min(level, array.tail);
+}
+
+} // namespace
+
+auto load_textures(
+    std::span<std::string const> const files,
+    bool const use_arrays
+) -> void {
+    auto& l = loader();
+    if (l.threads.empty()) {
+        ilInit();
+        // Rows bottom to top, like OpenGL.
+        ilEnable(IL_ORIGIN_SET);
+        ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
+        for (auto thread = 0_uz; thread < config::TEXTURE_LOADER_THREADS;
+            ++thread
+        ) {
+            l.threads.emplace_back(run_loader_thread);
+        }
+    }
+
+    l.target = use_arrays ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+    l.unpacked.clear();
+    l.num_packed = 0;
+    l.num_failed = 0;
+    l.arrays.clear();
+    l.resident_size = 0;
+    l.states.assign(files.size(), TextureState::LOADING);
+    l.slots = std::vector<std::atomic<u32>>(files.size());
+    for (auto& slot : l.slots) {
+        slot.store(NO_SLOT, std::memory_order_relaxed);
+    }
+
+    auto const compress = config::ENABLE_TEXTURE_COMPRESSION
+        and GLEW_EXT_texture_compression_s3tc;
+    {
+        auto const lock = std::scoped_lock{l.mutex};
+        l.generation += 1;
+        l.requests.clear();
+        l.decoded.clear();
+        for (auto texture = 0_uz; texture < files.size(); ++texture) {
+            l.requests.push_back({
+                .texture = static_cast<u32>(texture),
+                .generation = l.generation,
+                .file = files[texture],
+                .compress = compress,
+            });
+        }
+    }
+    l.wake_up.notify_all();
+    spdlog::info("loading {} textures in the background.", files.size());
+}
+
+auto stream_textures(
+    std::span<float const> const array_sizes,
+    float const viewport_height
+) noexcept -> void {
+    auto& l = loader();
+    {
+        auto const lock = std::scoped_lock{l.mutex};
+        std::ranges::move(l.decoded, std::back_inserter(l.unpacked));
+        l.decoded.clear();
+    }
+    for (auto it = l.unpacked.begin(); it != l.unpacked.end();) {
+        if (it->failed) {
+            spdlog::warn("failed to load texture {}.", it->file);
+            l.states[it->texture] = TextureState::FAILED;
+            l.num_failed += 1;
+            it = l.unpacked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Storage is (re)allocated before the pixel buffer is bound, which would
+    // otherwise be read from.
+    bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (not l.unpacked.empty()) {
+        pack_textures(l);
+    }
+    if (l.arrays.empty()) {
+        return;
+    }
+
+    // One level of slack before dropping, so objects sitting right at a
+    // threshold don't keep streaming the same level in and out.
+    auto wanted = std::vector<u32>(l.arrays.size());
+    for (auto index = 0_uz; index < l.arrays.size(); ++index) {
+        auto& array = l.arrays[index];
+        auto const size = index < array_sizes.size() ? array_sizes[index] : 0.f;
+        wanted[index] = wanted_level(array, size * viewport_height);
+        // The base only moves once a level is either whole or gone.
+        if (array.next_layer != 0 and array.base - 1 < wanted[index]) {
+            abandon_level(l, array);
+        }
+        if (array.next_layer == 0
+            and array.base < array.tail
+            and array.base + 1 < wanted[index]
+        ) {
+            drop_level(l, array);
+        }
+    }
+
+    // Missing tails first, then whichever is furthest from what it needs.
+    auto order = std::vector<u32>{};
+    for (auto index = 0_u32; index < l.arrays.size(); ++index) {
+        if (l.arrays[index].base > wanted[index]) {
+            order.push_back(index);
+        }
+    }
+    if (order.empty()) {
+        return;
+    }
+    std::ranges::sort(order, std::greater{}, [&](u32 const index) {
+        auto const& array = l.arrays[index];
+        return std::pair{array.base > array.tail, array.base - wanted[index]};
+    });
+
+    if (not l.ring_ready) {
+        init_stream_ring(l.ring, config::TEXTURE_UPLOAD_BUDGET);
+        l.ring_ready = true;
+    }
+
+    // Whole layers of a level at a time, for as long as they fit, always at
+    // least one.
+    // Levels past the tail only start if they fit in the memory budget.
+    struct LayerUpload {
+        u32 array;
+        u32 level;
+        u32 layer;
+        usize offset; // into this frame's region.
+    };
+    auto uploads = std::vector<LayerUpload>{};
+    auto size = 0_uz;
+    auto full = false;
+    for (auto const index : order) {
+        auto& array = l.arrays[index];
+        auto level = array.base - 1;
+        while (not full and level + 1 > wanted[index]) {
+            auto const bytes = array.layers.front().levels[level].size;
+            if (size > 0 and size + bytes > config::TEXTURE_UPLOAD_BUDGET) {
+                full = true;
+                break;
+            }
+            if (array.next_layer == 0) {
+                if (level < array.tail
+                    and l.resident_size + level_size(array, level)
+                        > config::TEXTURE_MEMORY_BUDGET
+                ) {
+                    break;
+                }
+                allocate_level(l, array, level);
+            }
+
+            uploads.push_back({
+                .array = index,
+                .level = level,
+                .layer = array.next_layer,
+                .offset = size,
+            });
+            size += bytes;
+            array.next_layer += 1;
+            if (array.next_layer < array.layers.size()) {
+                continue;
+            }
+            array.next_layer = 0;
+            if (level == 0) {
+                break;
+            }
+            level -= 1;
+        }
+        if (full) {
+            break;
+        }
+    }
+    if (uploads.empty()) {
+        return;
+    }
+
+    auto const region = begin_stream_frame(l.ring, size);
+    for (auto const& upload : uploads) {
+        auto const& data = l.arrays[upload.array].layers[upload.layer];
+        auto const& mip = data.levels[upload.level];
+        stream_write(
+            l.ring, upload.offset, data.bytes().data() + mip.offset, mip.size
+        );
+    }
+
+    // A level is only sampled once every layer of it is in.
+    bind_buffer(GL_PIXEL_UNPACK_BUFFER, l.ring.buffer.get());
+    for (auto const& upload : uploads) {
+        auto& array = l.arrays[upload.array];
+        bind_texture(0, l.target, array.handle.get());
+        upload_level(
+            l.target,
+            array,
+            upload.level,
+            upload.layer,
+            reinterpret_cast<void const*>(region + upload.offset)
+        );
+        if (upload.layer + 1 < array.layers.size()) {
+            continue;
+        }
+        set_base_level(l.target, array, upload.level);
+        if (upload.level == array.tail) {
+            for (auto const texture : array.textures) {
+                l.states[texture] = TextureState::RESIDENT;
+            }
+        }
+    }
+    bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    end_stream_frame(l.ring);
+}
+
+auto measure_texture_arrays(
+    World const& world,
+    Scene const& scene,
+    std::span<TextureSlot const> const texture_slots,
+    std::span<Draw const> const draws,
+    glm::vec3 const& eye,
+    float const fov_y,
+    std::vector<float>& array_sizes
+) noexcept -> void {
+    auto const tan_half_fov = std::tan(0.5f * fov_y);
+    array_sizes.clear();
+    for (auto const& draw : draws) {
+        auto const array = find_texture_slot(
+            texture_slots, world.models[draw.model].texture
+        ).array;
+        if (array == NO_TEXTURE) {
+            continue;
+        }
+        if (array >= array_sizes.size()) {
+            array_sizes.resize(array + 1, 0.f);
+        }
+
+        // Anything the camera is inside of fills the screen.
+        auto const& bounds = scene.model_bounds[draw.model];
+        auto const distance = glm::distance(eye, bounds.center);
+        auto const size = distance > bounds.radius
+            ? bounds.radius / (distance * tan_half_fov)
+            : 1.f;
+        array_sizes[array] = std::max(array_sizes[array], size);
+    }
+}
+
+auto read_texture_slots(std::vector<TextureSlot>& slots) noexcept -> void {
+    auto const& l = loader();
+    slots.resize(l.slots.size());
+    for (auto texture = 0_uz; texture < slots.size(); ++texture) {
+        auto const slot = l.slots[texture].load(std::memory_order_relaxed);
+        slots[texture] = slot == NO_SLOT
+            ? TextureSlot{.array = NO_TEXTURE, .layer = 0}
+            : TextureSlot {
+                .array = slot >> LAYER_BITS,
+                .layer = slot & ((1_u32 << LAYER_BITS) - 1),
+            };
+    }
+}
+
+auto find_texture_slot(
+    std::span<TextureSlot const> const slots,
+    u32 const texture
+) noexcept -> TextureSlot {
+    return texture < slots.size()
+        ? slots[texture]
+        : TextureSlot{.array = NO_TEXTURE, .layer = 0};
+}
+
+auto texture_array_name(u32 const array) noexcept -> GLuint {
+    auto& l = loader();
+    if (array < l.arrays.size()
+        and l.arrays[array].base <= l.arrays[array].tail
+    ) {
+        return l.arrays[array].handle.get();
+    }
+
+    if (not l.placeholder or l.placeholder_target != l.target) {
+        l.placeholder = create_placeholder(l.target);
+        l.placeholder_target = l.target;
+    }
+    return l.placeholder.get();
+}
+
+auto texture_stats() noexcept -> TextureStats {
+    auto const& l = loader();
+    auto stats = TextureStats {
+        .requested = static_cast<u32>(l.states.size()),
+        .resident = 0,
+        .failed = 0,
+        .resident_size = l.resident_size,
+    };
+    for (auto const state : l.states) {
+        stats.resident += state == TextureState::RESIDENT ? 1 : 0;
+        stats.failed += state == TextureState::FAILED ? 1 : 0;
+    }
+    return stats;
+}
+
+auto stop_texture_loader() noexcept -> void {
+    auto& l = loader();
+    {
+        auto const lock = std::scoped_lock{l.mutex};
+        l.requests.clear();
+    }
+    // Stopping wakes them up, and joining waits for any image in flight.
+    for (auto& thread : l.threads) {
+        thread.request_stop();
+    }
+    l.threads.clear();
+}
+
+} // namespace engine::render
@@ -0,0 +1,328 @@
+#include "engine/render/vertex_format.hpp"
+
+#include "engine/config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/common.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+#include <spdlog/spdlog.h>
+
+namespace engine::render {
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+auto position_size(PositionFormat const format) noexcept -> u32 {
+    switch (format) {
+        case PositionFormat::FLOAT: return sizeof(glm::vec3);
+        case PositionFormat::HALF:  return 4 * sizeof(u16);
+    }
+    return 0;
+}
+
+auto texcoord_size(TexcoordFormat const format) noexcept -> u32 {
+    switch (format) {
+        case TexcoordFormat::FLOAT:   return sizeof(glm::vec2);
+        case TexcoordFormat::UNORM16: return 2 * sizeof(u16);
+    }
+    return 0;
+}
+
+auto constexpr NORMAL_SIZE = u32{sizeof(u32)}; // in either format.
+
+// Position relative to `bounds`, the inverse of `dequantization_matrix`.
+auto relative_position(Sphere const& bounds, glm::vec3 const& position)
+    noexcept -> glm::vec3
+{
+    return bounds.radius > 0.f
+        ? (position - bounds.center) / bounds.radius
+        : position;
+}
+
+auto quantize_position(PositionFormat const format, glm::vec3 const& position)
+    noexcept -> glm::vec3
+{
+    switch (format) {
+        case PositionFormat::FLOAT:
+            return position;
+        case PositionFormat::HALF:
+            return {
+                glm::unpackHalf1x16(glm::packHalf1x16(position.x)),
+                glm::unpackHalf1x16(glm::packHalf1x16(position.y)),
+                glm::unpackHalf1x16(glm::packHalf1x16(position.z)),
+            };
+    }
+    return position;
+}
+
+// Projects onto the octahedron, then folds its lower half over the upper one.
+auto encode_octahedral(glm::vec3 normal) noexcept -> u32 {
+    normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    auto encoded = glm::vec2{normal.x, normal.y};
+    if (normal.z < 0.f) {
+        encoded = (1.f - glm::abs(glm::vec2{encoded.y, encoded.x}))
+            * glm::vec2 {
+                encoded.x >= 0.f ? 1.f : -1.f,
+                encoded.y >= 0.f ? 1.f : -1.f,
+            };
+    }
+    return glm::packSnorm2x16(encoded);
+}
+
+auto decode_octahedral(u32 const packed) noexcept -> glm::vec3 {
+    auto const encoded = glm::unpackSnorm2x16(packed);
+    auto normal = glm::vec3 {
+        encoded.x,
+        encoded.y,
+        1.f - std::abs(encoded.x) - std::abs(encoded.y),
+    };
+    auto const fold = std::max(-normal.z, 0.f);
+    normal.x += normal.x >= 0.f ? -fold : fold;
+    normal.y += normal.y >= 0.f ? -fold : fold;
+    return glm::normalize(normal);
+}
+
+auto encode_normal(NormalFormat const format, glm::vec3 const& normal)
+    noexcept -> u32
+{
+    if (glm::dot(normal, normal) == 0.f) {
+        return 0;
+    }
+    switch (format) {
+        case NormalFormat::INT_2_10_10_10:
+            return glm::packSnorm3x10_1x2(
+                glm::vec4{glm::normalize(normal), 0.f}
+            );
+        case NormalFormat::OCTAHEDRAL:
+            return encode_octahedral(normal);
+    }
+    return 0;
+}
+
+auto decode_normal(NormalFormat const format, u32 const packed) noexcept
+    -> glm::vec3
+{
+    switch (format) {
+        case NormalFormat::INT_2_10_10_10:
+            return glm::normalize(glm::vec3{glm::unpackSnorm3x10_1x2(packed)});
+        case NormalFormat::OCTAHEDRAL:
+            return decode_octahedral(packed);
+    }
+    return {};
+}
+
+auto relative_texcoord(VertexLayout const& layout, glm::vec2 const& texcoord)
+    noexcept -> glm::vec2
+{
+    return (texcoord - layout.texcoord_min) / layout.texcoord_scale;
+}
+
+auto set_offsets(VertexLayout& layout) noexcept -> void {
+    layout.normal_offset = position_size(layout.position_format);
+    layout.texcoord_offset = layout.normal_offset
+        + (layout.has_normals ? NORMAL_SIZE : 0);
+    layout.stride = layout.texcoord_offset
+        + (layout.has_texcoords ? texcoord_size(layout.texcoord_format) : 0);
+}
+
+template <typename T>
+auto write(std::byte* const dst, T const& value) noexcept -> void {
+    std::memcpy(dst, &value, sizeof(T));
+}
+
+} // namespace
+
+auto dequantization_matrix(Sphere const& bounds) noexcept -> glm::mat4 {
+    if (bounds.radius <= 0.f) {
+        return glm::mat4{1.f};
+    }
+    return glm::scale(
+        glm::translate(glm::mat4{1.f}, bounds.center),
+        glm::vec3{bounds.radius}
+    );
+}
+
+auto choose_vertex_layout(
+    World const& world,
+    PositionFormat const position_format,
+    NormalFormat const normal_format,
+    TexcoordFormat const texcoord_format
+) -> VertexLayout {
+    auto layout = VertexLayout {
+        .position_format = position_format,
+        .normal_format = normal_format,
+        .texcoord_format = texcoord_format,
+        .has_normals = false,
+        .has_texcoords = false,
+        .stride = 0,
+        .normal_offset = 0,
+        .texcoord_offset = 0,
+        .texcoord_min = glm::vec2{0.f},
+        .texcoord_scale = glm::vec2{1.f},
+    };
+
+    auto texcoord_min = glm::vec2{std::numeric_limits<float>::max()};
+    auto texcoord_max = glm::vec2{std::numeric_limits<float>::lowest()};
+    for (auto const& mesh : world.meshes) {
+        layout.has_normals = layout.has_normals or not mesh.normals.empty();
+        layout.has_texcoords
+            = layout.has_texcoords or not mesh.texcoords.empty();
+        for (auto const& texcoord : mesh.texcoords) {
+            texcoord_min = glm::min(texcoord_min, texcoord);
+            texcoord_max = glm::max(texcoord_max, texcoord);
+        }
+    }
+    if (layout.has_texcoords) {
+        layout.texcoord_min = texcoord_min;
+        layout.texcoord_scale = glm::max(
+            texcoord_max - texcoord_min,
+            glm::vec2{std::numeric_limits<float>::min()}
+        );
+    }
+
+    auto const errors = quantization_errors(world, layout);
+    if (errors.position > config::VERTEX_MAX_POSITION_ERROR) {
+        spdlog::warn(
+            "position quantization error of {}, storing full floats.",
+            static_cast<double>(errors.position)
+        );
+        layout.position_format = PositionFormat::FLOAT;
+    }
+    if (errors.normal > config::VERTEX_MAX_NORMAL_ERROR) {
+        spdlog::warn(
+            "normal quantization error of {} degrees, storing octahedral.",
+            static_cast<double>(errors.normal)
+        );
+        layout.normal_format = NormalFormat::OCTAHEDRAL;
+    }
+    if (errors.texcoord > config::VERTEX_MAX_TEXCOORD_ERROR) {
+        spdlog::warn(
+            "texcoord quantization error of {}, storing full floats.",
+            static_cast<double>(errors.texcoord)
+        );
+        layout.texcoord_format = TexcoordFormat::FLOAT;
+    }
+    set_offsets(layout);
+
+    auto const final_errors = quantization_errors(world, layout);
+    spdlog::info(
+        "vertex layout: {} bytes per vertex,"
+            " max errors: position {}, normal {} degrees, texcoord {}.",
+        layout.stride,
+        static_cast<double>(final_errors.position),
+        static_cast<double>(final_errors.normal),
+        static_cast<double>(final_errors.texcoord)
+    );
+    return layout;
+}
+
+auto quantization_errors(World const& world, VertexLayout const& layout)
+    noexcept -> QuantizationErrors
+{
+    auto errors = QuantizationErrors{0.f, 0.f, 0.f};
+    for (auto const& mesh : world.meshes) {
+        for (auto const& vertex : mesh.vertices) {
+            auto const relative = relative_position(mesh.bounds, vertex);
+            auto const quantized
+                = quantize_position(layout.position_format, relative);
+            errors.position = std::max(
+                errors.position,
+                glm::length(quantized - relative)
+            );
+        }
+
+        for (auto const& normal : mesh.normals) {
+            if (glm::dot(normal, normal) == 0.f) {
+                continue;
+            }
+            auto const decoded = decode_normal(
+                layout.normal_format,
+                encode_normal(layout.normal_format, normal)
+            );
+            auto const cos_angle = std::clamp(
+                glm::dot(glm::normalize(normal), decoded), -1.f, 1.f
+            );
+            errors.normal = std::max(
+                errors.normal,
+                glm::degrees(std::acos(cos_angle))
+            );
+        }
+
+        if (layout.texcoord_format == TexcoordFormat::UNORM16) {
+            for (auto const& texcoord : mesh.texcoords) {
+                auto const relative = relative_texcoord(layout, texcoord);
+                auto const decoded
+                    = glm::unpackUnorm2x16(glm::packUnorm2x16(relative))
+                        * layout.texcoord_scale
+                    + layout.texcoord_min;
+                auto const diff = glm::abs(decoded - texcoord);
+                errors.texcoord
+                    = std::max({errors.texcoord, diff.x, diff.y});
+            }
+        }
+    }
+    return errors;
+}
+
+auto pack_vertices(
+    Mesh const& mesh,
+    VertexLayout const& layout,
+    std::vector<std::byte>& out
+) -> void {
+    auto const num_vertices = mesh.vertices.size();
+    auto const begin = out.size();
+    // Zeroed, so missing normals, texcoords and padding are all zero.
+    out.resize(begin + layout.stride * num_vertices);
+
+    for (auto vertex = 0_uz; vertex < num_vertices; ++vertex) {
+        auto* const dst = out.data() + begin + layout.stride * vertex;
+
+        auto const position
+            = relative_position(mesh.bounds, mesh.vertices[vertex]);
+        switch (layout.position_format) {
+            case PositionFormat::FLOAT:
+                write(dst, position);
+                break;
+            case PositionFormat::HALF:
+                write(dst, glm::packHalf1x16(position.x));
+                write(dst + sizeof(u16), glm::packHalf1x16(position.y));
+                write(dst + 2 * sizeof(u16), glm::packHalf1x16(position.z));
+                break;
+        }
+
+        if (layout.has_normals and vertex < mesh.normals.size()) {
+            write(
+                dst + layout.normal_offset,
+                encode_normal(layout.normal_format, mesh.normals[vertex])
+            );
+        }
+
+        if (layout.has_texcoords and vertex < mesh.texcoords.size()) {
+            auto const texcoord = mesh.texcoords[vertex];
+            switch (layout.texcoord_format) {
+                case TexcoordFormat::FLOAT:
+                    write(dst + layout.texcoord_offset, texcoord);
+                    break;
+                case TexcoordFormat::UNORM16:
+                    write(
+                        dst + layout.texcoord_offset,
+                        glm::packUnorm2x16(relative_texcoord(layout, texcoord))
+                    );
+                    break;
+            }
+        }
+    }
+}
+
+} // namespace engine::render
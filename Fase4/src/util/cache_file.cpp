@@ -0,0 +1,70 @@
+#include "util/cache_file.hpp"
+
+#include <cstring>
+#include <fmt/core.h>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+namespace util {
+
+auto matches_cache_header(
+    std::span<std::byte const> const bytes,
+    CacheHeader const& expected
+) noexcept -> bool {
+    auto header = CacheHeader{};
+    if (bytes.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return header.magic == expected.magic
+        and header.version == expected.version
+        and header.key == expected.key;
+}
+
+auto write_file_atomically(
+    std::filesystem::path const& path,
+    std::span<std::span<std::byte const> const> const chunks
+) noexcept -> bool
+try {
+    auto error = std::error_code{};
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+        if (error) {
+            return false;
+        }
+    }
+
+    // Threads writing the same file each get their own.
+    auto temp_path = path;
+    temp_path += fmt::format(
+        ".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id())
+    );
+    {
+        auto file = std::ofstream{temp_path, std::ios::binary};
+        for (auto const chunk : chunks) {
+            file.write(
+                reinterpret_cast<char const*>(chunk.data()),
+                static_cast<std::streamsize>(chunk.size())
+            );
+        }
+        if (not file) {
+            file.close();
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+
+} catch (...) {
+    return false;
+}
+
+} // namespace util
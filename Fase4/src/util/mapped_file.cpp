@@ -0,0 +1,107 @@
+#include "util/mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace util {
+
+MappedFile::MappedFile(std::byte const* const data, std::size_t const size)
+    noexcept : data{data}, size{size} {}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data{std::exchange(other.data, nullptr)},
+      size{std::exchange(other.size, 0)} {}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+    auto moved = std::move(other);
+    std::swap(data, moved.data);
+    std::swap(size, moved.size);
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<std::byte*>(data), size);
+#endif
+}
+
+auto MappedFile::open(std::string const& path) noexcept
+    -> std::optional<MappedFile>
+{
+#ifdef _WIN32
+    auto* const file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+    auto file_size = LARGE_INTEGER{};
+    if (not GetFileSizeEx(file, &file_size) or file_size.QuadPart <= 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+
+    auto* const mapping
+        = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return std::nullopt;
+    }
+    // The view keeps the mapping alive on its own.
+    auto const* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return std::nullopt;
+    }
+    return MappedFile {
+        static_cast<std::byte const*>(view),
+        static_cast<std::size_t>(file_size.QuadPart),
+    };
+#else
+    auto const file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return std::nullopt;
+    }
+    struct stat file_stat = {};
+    if (fstat(file, &file_stat) != 0 or file_stat.st_size <= 0) {
+        close(file);
+        return std::nullopt;
+    }
+
+    auto const size = static_cast<std::size_t>(file_stat.st_size);
+    auto* const view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps the file alive on its own.
+    close(file);
+    if (view == MAP_FAILED) {
+        return std::nullopt;
+    }
+    return MappedFile{static_cast<std::byte const*>(view), size};
+#endif
+}
+
+auto MappedFile::bytes() const noexcept -> std::span<std::byte const> {
+    return {data, size};
+}
+
+} // namespace util
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdio>
+
+namespace test {
+
+inline auto failures = 0;
+
+// Exit status of a test executable, failing if any check did.
+[[nodiscard]]
+inline auto exit_code() noexcept -> int {
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed.\n", failures);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace test
+
+// Reports a failed check and carries on, so a run lists every failure.
+#define CHECK(condition) \
+    do { \
+        if (not (condition)) { \
+            std::fprintf( \
+                stderr, "%s:%d: failed %s\n", __FILE__, __LINE__, #condition \
+            ); \
+            test::failures += 1; \
+        } \
+    } while (false)
@@ -0,0 +1,205 @@
+#include "engine/parse/xml/group/instances/instances.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <brief_int.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <glm/geometric.hpp>
+#include <rapidxml.hpp>
+#include <string>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::parse::xml;
+
+namespace {
+
+// Slack for float rounding.
+auto constexpr EPSILON = 1e-4f;
+
+// Parses the single <instances> element in `xml`.
+auto parse(std::string xml, AssetCache& cache)
+    -> cpp::result<Instances, ParseErr>
+{
+    auto doc = rapidxml::xml_document<>{};
+    doc.parse<0>(xml.data());
+    return parse_instances(doc.first_node(), cache);
+}
+
+auto translation(glm::mat4 const& matrix) -> glm::vec3 {
+    return glm::vec3{matrix[3]};
+}
+
+auto scale(glm::mat4 const& matrix) -> float {
+    return glm::length(glm::vec3{matrix[0]});
+}
+
+// Every instance lies within the distribution's shape and scale range.
+auto check_generated(AssetCache& cache) -> void {
+    auto const ring = parse(
+        R"(<instances model="tri.3d" texture="rock.jpg" count="200")"
+        R"( distribution="ring" seed="7" radius="5" inner="3" height="2")"
+        R"( min_scale="0.5" max_scale="2"/>)",
+        cache
+    );
+    CHECK(ring.has_value());
+    if (not ring.has_value()) {
+        return;
+    }
+    CHECK(ring->matrices.size() == 200);
+    CHECK(ring->mesh == 0);
+    CHECK(ring->texture == 0);
+    CHECK(cache.textures == std::vector<std::string>{"rock.jpg"});
+    auto within = true;
+    for (auto const& matrix : ring->matrices) {
+        auto const position = translation(matrix);
+        auto const r = std::hypot(position.x, position.z);
+        within = within
+            and r >= 3.f - EPSILON and r <= 5.f + EPSILON
+            and std::abs(position.y) <= 1.f + EPSILON
+            and scale(matrix) >= 0.5f - EPSILON
+            and scale(matrix) <= 2.f + EPSILON;
+    }
+    CHECK(within);
+
+    auto const sphere = parse(
+        R"(<instances model="tri.3d" count="100" distribution="sphere")"
+        R"( radius="4" inner="2"/>)",
+        cache
+    );
+    CHECK(sphere.has_value());
+    if (sphere.has_value()) {
+        // Shares the mesh, untextured.
+        CHECK(sphere->mesh == 0);
+        CHECK(sphere->texture == engine::render::NO_TEXTURE);
+        CHECK(cache.meshes.size() == 1);
+        CHECK(std::ranges::all_of(sphere->matrices, [](auto const& matrix) {
+            auto const r = glm::length(translation(matrix));
+            return r >= 2.f - EPSILON and r <= 4.f + EPSILON
+                and std::abs(scale(matrix) - 1.f) <= EPSILON;
+        }));
+    }
+
+    auto const box = parse(
+        R"(<instances model="tri.3d" count="100" distribution="box")"
+        R"( radius="3"/>)",
+        cache
+    );
+    CHECK(box.has_value());
+    if (box.has_value()) {
+        CHECK(std::ranges::all_of(box->matrices, [](auto const& matrix) {
+            auto const position = glm::abs(translation(matrix));
+            return std::max({position.x, position.y, position.z})
+                <= 3.f + EPSILON;
+        }));
+    }
+}
+
+// Same seed, same population.
+auto check_seed(AssetCache& cache) -> void {
+    auto const with_seed = [&](char const* const seed) {
+        return parse(
+            std::string{R"(<instances model="tri.3d" count="50")"}
+                + R"( distribution="ring" seed=")" + seed + R"("/>)",
+            cache
+        );
+    };
+    auto const a = with_seed("1");
+    auto const b = with_seed("1");
+    auto const c = with_seed("2");
+    CHECK(a.has_value() and b.has_value() and c.has_value());
+    if (a.has_value() and b.has_value() and c.has_value()) {
+        CHECK(a->matrices == b->matrices);
+        CHECK(a->matrices != c->matrices);
+    }
+}
+
+auto check_file(AssetCache& cache) -> void {
+    auto const matrices = std::array {
+        glm::mat4{1.f},
+        glm::mat4{2.f},
+        glm::mat4{
+            {1.f, 2.f, 3.f, 4.f},
+            {5.f, 6.f, 7.f, 8.f},
+            {9.f, 10.f, 11.f, 12.f},
+            {13.f, 14.f, 15.f, 16.f},
+        },
+    };
+    {
+        auto file = std::ofstream{"belt.bin", std::ios::binary};
+        file.write(
+            reinterpret_cast<char const*>(matrices.data()), sizeof(matrices)
+        );
+        auto truncated = std::ofstream{"truncated.bin", std::ios::binary};
+        truncated.write(
+            reinterpret_cast<char const*>(matrices.data()),
+            sizeof(matrices) - 1
+        );
+    }
+
+    auto const read = parse(
+        R"(<instances model="tri.3d" file="belt.bin"/>)", cache
+    );
+    CHECK(read.has_value());
+    if (read.has_value()) {
+        CHECK(std::ranges::equal(read->matrices, matrices));
+    }
+
+    auto const truncated = parse(
+        R"(<instances model="tri.3d" file="truncated.bin"/>)", cache
+    );
+    CHECK(truncated.has_error()
+        and truncated.error() == ParseErr::MALFORMED_INSTANCES_FILE);
+
+    auto const missing = parse(
+        R"(<instances model="tri.3d" file="missing.bin"/>)", cache
+    );
+    CHECK(missing.has_error()
+        and missing.error() == ParseErr::NO_INSTANCES_FILE);
+}
+
+auto check_errors(AssetCache& cache) -> void {
+    auto const unknown = parse(
+        R"(<instances model="tri.3d" count="5" distribution="cube"/>)", cache
+    );
+    CHECK(unknown.has_error()
+        and unknown.error() == ParseErr::UNKNOWN_INSTANCES_DISTRIBUTION);
+
+    auto const no_model = parse(
+        R"(<instances count="5" distribution="box"/>)", cache
+    );
+    CHECK(no_model.has_error()
+        and no_model.error() == ParseErr::NO_MODEL_FILENAME);
+
+    auto const no_count = parse(
+        R"(<instances model="tri.3d" distribution="box"/>)", cache
+    );
+    CHECK(no_count.has_error());
+}
+
+} // namespace
+
+auto main() -> int {
+    // Files are looked up from the working directory.
+    auto const dir = std::filesystem::temp_directory_path()
+        / "instances_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::current_path(dir);
+    std::ofstream{"tri.3d"} << "3\n0 0 0\n1 0 0\n0 1 0\n";
+
+    auto cache = AssetCache{};
+    check_generated(cache);
+    check_seed(cache);
+    check_file(cache);
+    check_errors(cache);
+
+    std::filesystem::current_path(dir.parent_path());
+    std::filesystem::remove_all(dir);
+    return test::exit_code();
+}
@@ -0,0 +1,194 @@
+#include "engine/render/bvh.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+auto constexpr INF = std::numeric_limits<float>::infinity();
+
+auto make_spheres(std::mt19937& random, usize const count)
+    -> std::vector<Sphere>
+{
+    auto coordinate = std::uniform_real_distribution{-50.f, 50.f};
+    auto radius = std::uniform_real_distribution{0.1f, 2.f};
+    auto spheres = std::vector<Sphere>(count);
+    for (auto& sphere : spheres) {
+        sphere = {
+            .center = {
+                coordinate(random), coordinate(random), coordinate(random)
+            },
+            .radius = radius(random),
+        };
+    }
+    return spheres;
+}
+
+// Distance along the ray to the sphere, 0 from inside it, by brute force.
+auto ray_distance(
+    Sphere const& sphere,
+    glm::vec3 const& origin,
+    glm::vec3 const& direction
+) -> float {
+    auto const offset = origin - sphere.center;
+    auto const a = glm::dot(direction, direction);
+    auto const b = glm::dot(offset, direction);
+    auto const c = glm::dot(offset, offset) - sphere.radius * sphere.radius;
+    if (c <= 0.f) {
+        return 0.f;
+    }
+    auto const discriminant = b * b - a * c;
+    if (b > 0.f or discriminant < 0.f) {
+        return INF;
+    }
+    return (-b - std::sqrt(discriminant)) / a;
+}
+
+auto point_distance(Sphere const& sphere, glm::vec3 const& point) -> float {
+    return std::max(glm::distance(point, sphere.center) - sphere.radius, 0.f);
+}
+
+// Rays from random points, half of them aimed at a sphere, against testing
+// every sphere.
+auto check_raycast(
+    Bvh const& bvh,
+    std::vector<Sphere> const& spheres,
+    std::mt19937& random
+) -> void {
+    auto coordinate = std::uniform_real_distribution{-60.f, 60.f};
+    auto pick = std::uniform_int_distribution<usize>{0, spheres.size() - 1};
+    auto matches = true;
+    for (auto ray = 0; ray < 500; ++ray) {
+        auto const origin = glm::vec3 {
+            coordinate(random), coordinate(random), coordinate(random)
+        };
+        auto const direction = ray % 2 == 0
+            ? spheres[pick(random)].center - origin
+            : glm::vec3 {
+                coordinate(random), coordinate(random), coordinate(random)
+            };
+
+        auto expected = INF;
+        for (auto const& sphere : spheres) {
+            expected = std::min(
+                expected, ray_distance(sphere, origin, direction)
+            );
+        }
+        auto const hit = raycast(bvh, spheres, origin, direction);
+        if (expected == INF) {
+            matches = matches and not hit.has_value();
+        } else {
+            matches = matches
+                and hit.has_value()
+                and hit->distance == expected
+                and ray_distance(spheres[hit->item], origin, direction)
+                    == expected;
+        }
+    }
+    CHECK(matches);
+}
+
+// Against sorting every sphere by its distance.
+auto check_k_nearest(
+    Bvh const& bvh,
+    std::vector<Sphere> const& spheres,
+    std::mt19937& random
+) -> void {
+    auto coordinate = std::uniform_real_distribution{-60.f, 60.f};
+    auto nearest = std::vector<u32>{};
+    auto matches = true;
+    for (auto query = 0; query < 100; ++query) {
+        auto const point = glm::vec3 {
+            coordinate(random), coordinate(random), coordinate(random)
+        };
+        auto distances = std::vector<float>{};
+        for (auto const& sphere : spheres) {
+            distances.push_back(point_distance(sphere, point));
+        }
+        std::ranges::sort(distances);
+
+        for (auto const k : {1_uz, 5_uz, 17_uz}) {
+            k_nearest(bvh, spheres, point, k, nearest);
+            matches = matches and nearest.size() == k;
+            for (auto i = 0_uz; i < std::min(k, nearest.size()); ++i) {
+                matches = matches
+                    and point_distance(spheres[nearest[i]], point)
+                        == distances[i];
+            }
+        }
+    }
+    CHECK(matches);
+}
+
+auto check_empty() -> void {
+    auto bvh = Bvh{};
+    build_bvh(bvh, {});
+    CHECK(not raycast(bvh, {}, glm::vec3{0.f}, {0.f, 0.f, 1.f}).has_value());
+    auto nearest = std::vector<u32>{1, 2, 3};
+    k_nearest(bvh, {}, glm::vec3{0.f}, 3, nearest);
+    CHECK(nearest.empty());
+}
+
+// Asking for more spheres than there are returns them all.
+auto check_few() -> void {
+    auto const spheres = std::vector<Sphere> {
+        {.center = {0.f, 0.f, 0.f}, .radius = 1.f},
+        {.center = {10.f, 0.f, 0.f}, .radius = 1.f},
+    };
+    auto bvh = Bvh{};
+    build_bvh(bvh, spheres);
+    auto nearest = std::vector<u32>{};
+    k_nearest(bvh, spheres, {8.f, 0.f, 0.f}, 5, nearest);
+    CHECK(nearest.size() == 2);
+    CHECK(nearest.size() == 2 and nearest[0] == 1 and nearest[1] == 0);
+
+    // From inside a sphere, it's hit right away.
+    auto const hit = raycast(bvh, spheres, {0.5f, 0.f, 0.f}, {1.f, 0.f, 0.f});
+    CHECK(hit.has_value() and hit->item == 0 and hit->distance == 0.f);
+}
+
+} // namespace
+
+auto main() -> int {
+    auto random = std::mt19937{1234};
+    auto spheres = make_spheres(random, 1000);
+    auto bvh = Bvh{};
+    build_bvh(bvh, spheres);
+    check_raycast(bvh, spheres, random);
+    check_k_nearest(bvh, spheres, random);
+
+    // Refitted after small moves, then rebuilt after large ones.
+    for (auto const step : {0.5f, 20.f}) {
+        auto offset = std::uniform_real_distribution{-step, step};
+        for (auto& sphere : spheres) {
+            sphere.center += glm::vec3 {
+                offset(random), offset(random), offset(random)
+            };
+        }
+        refit_bvh(bvh, spheres);
+        check_raycast(bvh, spheres, random);
+        check_k_nearest(bvh, spheres, random);
+    }
+
+    // A different number of spheres.
+    spheres.resize(300);
+    refit_bvh(bvh, spheres);
+    check_raycast(bvh, spheres, random);
+    check_k_nearest(bvh, spheres, random);
+
+    check_empty();
+    check_few();
+    return test::exit_code();
+}
@@ -0,0 +1,227 @@
+#include "engine/render/light_clusters.hpp"
+
+#include "check.hpp"
+#include "engine/config.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <cmath>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <random>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+namespace config = engine::render::config;
+
+auto constexpr FOV_Y = 1.0471976f; // 60 degrees.
+auto constexpr ASPECT = 16.f / 9.f;
+auto constexpr NEAR = 0.1f;
+auto constexpr FAR = 100.f;
+
+auto num_clusters() -> usize {
+    return usize{config::LIGHT_CLUSTERS_X}
+        * config::LIGHT_CLUSTERS_Y
+        * config::LIGHT_CLUSTERS_Z;
+}
+
+auto point_light(glm::vec3 const& position, float const range) -> Light {
+    return {
+        .type = LightType::POINT,
+        .position = position,
+        .direction = {0.f, 0.f, -1.f},
+        .color = glm::vec3{1.f},
+        .range = range,
+        .cutoff = 0.f,
+    };
+}
+
+// The cluster the fragment shader looks a view space point up in.
+auto cluster_at(LightClusters const& clusters, glm::vec3 const& point)
+    -> usize
+{
+    auto const tan_y = std::tan(FOV_Y * 0.5f);
+    auto const tan_x = tan_y * ASPECT;
+    auto const depth = -point.z;
+    auto const tile = [](float const ndc, u32 const count) {
+        auto const index = static_cast<int>(
+            (ndc + 1.f) * 0.5f * static_cast<float>(count)
+        );
+        return static_cast<usize>(
+            std::clamp(index, 0, static_cast<int>(count) - 1)
+        );
+    };
+    auto const x = tile(point.x / (depth * tan_x), config::LIGHT_CLUSTERS_X);
+    auto const y = tile(point.y / (depth * tan_y), config::LIGHT_CLUSTERS_Y);
+    auto const z = static_cast<usize>(std::clamp(
+        static_cast<int>(
+            std::log(depth) * clusters.slice_scale + clusters.slice_bias
+        ),
+        0,
+        static_cast<int>(config::LIGHT_CLUSTERS_Z) - 1
+    ));
+    return (z * config::LIGHT_CLUSTERS_Y + y) * config::LIGHT_CLUSTERS_X + x;
+}
+
+auto lists(LightClusters const& clusters, usize const cluster, u32 light)
+    -> bool
+{
+    auto const& range = clusters.ranges[cluster];
+    auto const begin = clusters.indices.begin() + range.x;
+    auto const end = begin + range.y;
+    return std::find(begin, end, light) != end;
+}
+
+// Ranges tile `indices` in order, without any gaps.
+auto check_ranges(LightClusters const& clusters) -> void {
+    CHECK(clusters.ranges.size() == num_clusters());
+    auto offset = 0_u32;
+    auto contiguous = true;
+    for (auto const& range : clusters.ranges) {
+        contiguous = contiguous and range.x == offset;
+        offset += range.y;
+    }
+    CHECK(contiguous);
+    CHECK(offset == clusters.indices.size());
+}
+
+// Every point within a light's range, in view, is in a cluster listing it.
+auto check_point_lights(glm::mat4 const& view) -> void {
+    auto random = std::mt19937{1234};
+    auto coordinate = std::uniform_real_distribution{-40.f, 40.f};
+    auto range = std::uniform_real_distribution{0.5f, 8.f};
+    auto unit = std::uniform_real_distribution{-1.f, 1.f};
+
+    auto lights = std::vector<Light>{};
+    for (auto light = 0; light < 200; ++light) {
+        lights.push_back(point_light(
+            {coordinate(random), coordinate(random), coordinate(random)},
+            range(random)
+        ));
+    }
+
+    auto grid = LightClusterGrid{};
+    auto clusters = LightClusters{};
+    auto stats = LightClusterStats{};
+    build_light_clusters(
+        grid, lights, view, FOV_Y, ASPECT, NEAR, FAR, clusters, stats
+    );
+    check_ranges(clusters);
+    CHECK(clusters.lights.size() == lights.size());
+    CHECK(stats.indices == clusters.indices.size());
+
+    auto const tan_y = std::tan(FOV_Y * 0.5f);
+    auto const tan_x = tan_y * ASPECT;
+    auto covered = true;
+    auto samples = 0;
+    for (auto light = 0_u32; light < lights.size(); ++light) {
+        auto const reach = lights[light].range;
+        auto const center
+            = glm::vec3{view * glm::vec4{lights[light].position, 1.f}};
+        for (auto sample = 0; sample < 200; ++sample) {
+            // Strictly within range, clear of rounding at the edge.
+            auto offset = glm::vec3{unit(random), unit(random), unit(random)};
+            if (glm::length(offset) > 0.99f) {
+                continue;
+            }
+            auto const point = center + offset * reach;
+            auto const depth = -point.z;
+            if (depth < NEAR
+                or depth > FAR
+                or std::abs(point.x) > depth * tan_x
+                or std::abs(point.y) > depth * tan_y
+            ) {
+                continue;
+            }
+            samples += 1;
+            covered = covered
+                and lists(clusters, cluster_at(clusters, point), light);
+        }
+    }
+    CHECK(samples > 1000);
+    CHECK(covered);
+}
+
+// Directional lights reach every cluster, lights out of view none.
+auto check_reach() -> void {
+    auto lights = std::vector<Light> {
+        {
+            .type = LightType::DIRECTIONAL,
+            .position = glm::vec3{0.f},
+            .direction = {0.f, 1.f, 0.f},
+            .color = glm::vec3{1.f},
+            .range = 0.f,
+            .cutoff = 0.f,
+        },
+        point_light({0.f, 0.f, 10.f}, 2.f), // behind the eye.
+        point_light({0.f, 0.f, -150.f}, 2.f), // past the far plane.
+        point_light({0.f, 0.f, -10.f}, 1.f),
+    };
+
+    auto grid = LightClusterGrid{};
+    auto clusters = LightClusters{};
+    auto stats = LightClusterStats{};
+    build_light_clusters(
+        grid,
+        lights,
+        glm::mat4{1.f},
+        FOV_Y,
+        ASPECT,
+        NEAR,
+        FAR,
+        clusters,
+        stats
+    );
+    check_ranges(clusters);
+    CHECK(stats.lights == 2);
+
+    auto everywhere = true;
+    auto nowhere = true;
+    auto reached = 0_uz;
+    for (auto cluster = 0_uz; cluster < num_clusters(); ++cluster) {
+        everywhere = everywhere and lists(clusters, cluster, 0);
+        nowhere = nowhere
+            and not lists(clusters, cluster, 1)
+            and not lists(clusters, cluster, 2);
+        reached += lists(clusters, cluster, 3) ? 1_uz : 0_uz;
+    }
+    CHECK(everywhere);
+    CHECK(nowhere);
+    // Only around the middle of the screen, in a few slices.
+    CHECK(reached > 0 and reached < num_clusters() / 10);
+    CHECK(lists(clusters, cluster_at(clusters, {0.f, 0.f, -10.f}), 3));
+
+    // Changing the projection moves the clusters along.
+    build_light_clusters(
+        grid,
+        lights,
+        glm::mat4{1.f},
+        FOV_Y,
+        ASPECT,
+        NEAR,
+        200.f,
+        clusters,
+        stats
+    );
+    check_ranges(clusters);
+    CHECK(stats.lights == 3);
+}
+
+} // namespace
+
+auto main() -> int {
+    check_point_lights(glm::mat4{1.f});
+    check_point_lights(glm::lookAt(
+        glm::vec3{5.f, 3.f, 20.f},
+        glm::vec3{-2.f, 0.f, 0.f},
+        glm::vec3{0.f, 1.f, 0.f}
+    ));
+    check_reach();
+    return test::exit_code();
+}
@@ -0,0 +1,154 @@
+#include "engine/render/mesh_attributes.hpp"
+
+#include "check.hpp"
+
+#include <array>
+#include <brief_int.hpp>
+#include <cmath>
+#include <filesystem>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <span>
+#include <string>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+auto constexpr EPSILON = 1e-5f;
+
+// Two triangles hinged 30 degrees apart along the y axis, within the crease
+// angle. The edge is at x = `left` on the left one and x = `right` on the
+// right one, both within the weld tolerance of 0.
+// Corners 0 and 2 of the right one, and 0 and 1 of the left one, are on the
+// edge.
+auto make_hinge(float const left, float const right) -> Mesh {
+    auto const c = std::cos(glm::radians(30.f));
+    auto const s = std::sin(glm::radians(30.f));
+    auto mesh = Mesh{};
+    mesh.vertices = {
+        {right, 0.f, 0.f}, {1.f, 0.f, 0.f}, {right, 1.f, 0.f},
+        {left, 0.f, 0.f}, {left, 1.f, 0.f}, {left - c, 0.f, s},
+    };
+    mesh.bounds = {.center = glm::vec3{0.f}, .radius = 1.f};
+    return mesh;
+}
+
+auto same(glm::vec3 const& a, glm::vec3 const& b) -> bool {
+    return glm::distance(a, b) <= EPSILON;
+}
+
+auto generate(Mesh& mesh, std::string const& file) -> void {
+    auto const files = std::array{file};
+    generate_mesh_attributes(std::span{&mesh, 1}, files);
+}
+
+// Edge corners average both faces, the others keep their own face's.
+auto check_smoothed(Mesh const& mesh) -> void {
+    auto const right = glm::vec3{0.f, 0.f, 1.f};
+    auto const left = glm::normalize(glm::vec3 {
+        std::sin(glm::radians(30.f)), 0.f, std::cos(glm::radians(30.f))
+    });
+    auto const edge = glm::normalize(right + left);
+    CHECK(mesh.normals.size() == mesh.vertices.size());
+    if (mesh.normals.size() != mesh.vertices.size()) {
+        return;
+    }
+    CHECK(same(mesh.normals[0], edge));
+    CHECK(same(mesh.normals[1], right));
+    CHECK(same(mesh.normals[2], edge));
+    CHECK(same(mesh.normals[3], edge));
+    CHECK(same(mesh.normals[4], edge));
+    CHECK(same(mesh.normals[5], left));
+}
+
+// The edges straddle a cell boundary of the weld grid, wherever its cells
+// start.
+auto check_weld(std::filesystem::path const& dir) -> void {
+    for (auto const offset : {0.f, 0.25e-5f, 0.5e-5f, 0.75e-5f}) {
+        auto mesh = make_hinge(offset - 0.2e-5f, offset + 0.2e-5f);
+        generate(mesh, (dir / "weld.obj").string());
+        check_smoothed(mesh);
+    }
+}
+
+// Only degenerate normals are filled in.
+auto check_authored(std::filesystem::path const& dir) -> void {
+    auto const authored = glm::vec3{0.f, 1.f, 0.f};
+    auto mesh = make_hinge(0.f, 0.f);
+    mesh.normals = {
+        authored, authored, authored,
+        glm::vec3{0.f}, glm::vec3{0.f}, glm::vec3{0.f},
+    };
+    generate(mesh, (dir / "authored.obj").string());
+    CHECK(mesh.normals[0] == authored);
+    CHECK(mesh.normals[1] == authored);
+    CHECK(mesh.normals[2] == authored);
+    CHECK(std::abs(glm::length(mesh.normals[3]) - 1.f) <= EPSILON);
+    CHECK(std::abs(glm::length(mesh.normals[4]) - 1.f) <= EPSILON);
+    CHECK(std::abs(glm::length(mesh.normals[5]) - 1.f) <= EPSILON);
+}
+
+// Tangents are unit length, orthogonal to the normals and follow u.
+auto check_tangents(Mesh const& mesh) -> void {
+    CHECK(mesh.tangents.size() == mesh.vertices.size());
+    if (mesh.tangents.size() != mesh.vertices.size()) {
+        return;
+    }
+    for (auto vertex = 0_uz; vertex < mesh.vertices.size(); ++vertex) {
+        auto const tangent = glm::vec3{mesh.tangents[vertex]};
+        CHECK(std::abs(glm::length(tangent) - 1.f) <= EPSILON);
+        CHECK(std::abs(glm::dot(tangent, mesh.normals[vertex])) <= EPSILON);
+        CHECK(mesh.tangents[vertex].w == 1.f);
+    }
+    // On the flat face, u runs along x.
+    CHECK(same(glm::vec3{mesh.tangents[1]}, {1.f, 0.f, 0.f}));
+}
+
+// A second load of the same geometry reads what the first one cached.
+auto check_cache(std::filesystem::path const& dir) -> void {
+    auto const file = (dir / "cached.obj").string();
+    auto const make_mesh = [] {
+        auto mesh = make_hinge(0.f, 0.f);
+        mesh.texcoords = {
+            {0.f, 0.f}, {1.f, 0.f}, {0.f, 1.f},
+            {0.f, 0.f}, {0.f, 1.f}, {-1.f, 0.f},
+        };
+        return mesh;
+    };
+
+    auto generated = make_mesh();
+    generate(generated, file);
+    check_smoothed(generated);
+    check_tangents(generated);
+    CHECK(std::filesystem::exists(file + ".mesh_cache"));
+
+    auto cached = make_mesh();
+    generate(cached, file);
+    CHECK(cached.normals == generated.normals);
+    CHECK(cached.tangents == generated.tangents);
+
+    // Other geometry doesn't pick up the stale file.
+    auto moved = make_mesh();
+    moved.vertices[1].z = 1.f;
+    generate(moved, file);
+    CHECK(same(moved.normals[1], glm::normalize(glm::vec3{-1.f, 0.f, 1.f})));
+}
+
+} // namespace
+
+auto main() -> int {
+    auto const dir = std::filesystem::temp_directory_path()
+        / "mesh_attributes_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    check_weld(dir);
+    check_authored(dir);
+    check_cache(dir);
+
+    std::filesystem::remove_all(dir);
+    return test::exit_code();
+}
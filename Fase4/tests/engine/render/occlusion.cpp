@@ -0,0 +1,191 @@
+#include "engine/render/occlusion.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/trigonometric.hpp>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+// Model 0 is the occluder, model 1 the tested one, with no triangles of its
+// own so it's never picked as an occluder.
+struct Setup {
+    World world;
+    std::vector<Sphere> model_bounds;
+};
+
+// Both windings, so it faces the camera from either side.
+auto add_quad(
+    Mesh& mesh,
+    glm::vec3 const& a,
+    glm::vec3 const& b,
+    glm::vec3 const& c,
+    glm::vec3 const& d
+) -> void {
+    for (auto const& vertex : {a, b, c, a, c, d, a, c, b, a, d, c}) {
+        mesh.vertices.push_back(vertex);
+    }
+}
+
+auto make_setup(Mesh occluder, Sphere const& tested) -> Setup {
+    auto setup = Setup{};
+    occluder.bounds = bounding_sphere(occluder.vertices);
+    setup.model_bounds = {occluder.bounds, tested};
+    setup.world.meshes.push_back(std::move(occluder));
+    setup.world.meshes.push_back({});
+    setup.world.models = {
+        {.mesh = 0, .matrix = NO_MATRIX, .texture = NO_TEXTURE},
+        {.mesh = 1, .matrix = NO_MATRIX, .texture = NO_TEXTURE},
+    };
+    return setup;
+}
+
+// Whether the tested model survives culling, seen from the origin down -z.
+// Leaves the depth pyramid in `buffer`.
+auto survives(Setup const& setup, OcclusionBuffer& buffer) -> bool {
+    auto const view = glm::lookAt(
+        glm::vec3{0.f}, glm::vec3{0.f, 0.f, -1.f}, glm::vec3{0.f, 1.f, 0.f}
+    );
+    auto const proj = glm::perspective(glm::radians(90.f), 2.f, 0.1f, 100.f);
+    auto draws = std::vector<Draw> {
+        {.matrix = glm::mat4{1.f}, .model = 0},
+        {.matrix = glm::mat4{1.f}, .model = 1},
+    };
+    auto stats = OcclusionStats{};
+    cull_occluded(
+        buffer,
+        setup.world,
+        setup.model_bounds,
+        view,
+        proj,
+        draws,
+        stats
+    );
+    CHECK(stats.occluders == 1);
+    return std::ranges::any_of(draws, [](Draw const& draw) {
+        return draw.model == 1;
+    });
+}
+
+auto survives(Setup const& setup) -> bool {
+    auto buffer = OcclusionBuffer{};
+    return survives(setup, buffer);
+}
+
+// A 4x4 wall 5 units ahead.
+auto make_wall() -> Mesh {
+    auto wall = Mesh{};
+    add_quad(
+        wall,
+        {-2.f, -2.f, -5.f},
+        {2.f, -2.f, -5.f},
+        {2.f, 2.f, -5.f},
+        {-2.f, 2.f, -5.f}
+    );
+    return wall;
+}
+
+auto check_wall() -> void {
+    // Right behind it.
+    CHECK(not survives(make_setup(
+        make_wall(), {.center = {0.f, 0.f, -20.f}, .radius = 1.f}
+    )));
+    // In front of it.
+    CHECK(survives(make_setup(
+        make_wall(), {.center = {0.f, 0.f, -3.f}, .radius = 0.5f}
+    )));
+    // Behind it, but off to the side.
+    CHECK(survives(make_setup(
+        make_wall(), {.center = {20.f, 0.f, -20.f}, .radius = 1.f}
+    )));
+    // Behind it, but poking out past its edge.
+    CHECK(survives(make_setup(
+        make_wall(), {.center = {8.f, 0.f, -20.f}, .radius = 1.f}
+    )));
+}
+
+// Each texel of every level is at least as far as every texel of level 0
+// under it, and the wall is nearer than the cleared background.
+auto check_pyramid() -> void {
+    auto buffer = OcclusionBuffer{};
+    (void) survives(
+        make_setup(make_wall(), {.center = {0.f, 0.f, -20.f}, .radius = 1.f}),
+        buffer
+    );
+    CHECK(buffer.levels.size() > 1);
+    if (buffer.levels.size() <= 1) {
+        return;
+    }
+    auto const& finest = buffer.levels.front();
+    auto const [nearest, farthest] = std::ranges::minmax(finest);
+    CHECK(nearest < farthest);
+
+    auto conservative = true;
+    for (auto y = 0_u32; y < buffer.level_heights.front(); ++y) {
+        for (auto x = 0_u32; x < buffer.level_widths.front(); ++x) {
+            auto const depth
+                = finest[usize{y} * buffer.level_widths.front() + x];
+            auto level_x = x;
+            auto level_y = y;
+            for (auto level = 1_uz; level < buffer.levels.size(); ++level) {
+                auto const width = buffer.level_widths[level];
+                auto const height = buffer.level_heights[level];
+                level_x = std::min(level_x / 2, width - 1);
+                level_y = std::min(level_y / 2, height - 1);
+                conservative = conservative and depth
+                    <= buffer.levels[level][usize{level_y} * width + level_x];
+            }
+        }
+    }
+    CHECK(conservative);
+
+    // The coarsest level holds the farthest depth of all.
+    auto const& coarsest = buffer.levels.back();
+    CHECK(std::ranges::max(coarsest) == farthest);
+}
+
+// A box around the eye lies entirely within the near plane, so it hides
+// nothing.
+auto check_camera_inside() -> void {
+    auto constexpr H = 0.05f;
+    auto box = Mesh{};
+    add_quad(box, {-H, -H, -H}, {H, -H, -H}, {H, H, -H}, {-H, H, -H});
+    add_quad(box, {-H, -H, H}, {H, -H, H}, {H, H, H}, {-H, H, H});
+    add_quad(box, {-H, -H, -H}, {-H, H, -H}, {-H, H, H}, {-H, -H, H});
+    add_quad(box, {H, -H, -H}, {H, H, -H}, {H, H, H}, {H, -H, H});
+    add_quad(box, {-H, -H, -H}, {H, -H, -H}, {H, -H, H}, {-H, -H, H});
+    add_quad(box, {-H, H, -H}, {H, H, -H}, {H, H, H}, {-H, H, H});
+    CHECK(survives(make_setup(
+        box, {.center = {0.f, 0.f, -20.f}, .radius = 1.f}
+    )));
+
+    // Nor does a wall in front of the eye but nearer than the near plane.
+    auto near_wall = Mesh{};
+    add_quad(
+        near_wall,
+        {-1.f, -1.f, -0.05f},
+        {1.f, -1.f, -0.05f},
+        {1.f, 1.f, -0.05f},
+        {-1.f, 1.f, -0.05f}
+    );
+    CHECK(survives(make_setup(
+        near_wall, {.center = {0.f, 0.f, -20.f}, .radius = 1.f}
+    )));
+}
+
+} // namespace
+
+auto main() -> int {
+    check_wall();
+    check_pyramid();
+    check_camera_inside();
+    return test::exit_code();
+}
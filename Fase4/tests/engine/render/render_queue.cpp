@@ -0,0 +1,171 @@
+#include "engine/render/render_queue.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+auto constexpr FIELDS = RenderKeyFields {
+    .pass = RenderPass::SOLID,
+    .program = 3,
+    .texture = 100,
+    .material = 7,
+    .mesh = 1000,
+    .depth = 0.5f,
+};
+
+// Each field outweighs every less significant one at its maximum.
+auto check_key_order() -> void {
+    auto const key = make_render_key(FIELDS);
+
+    auto program = FIELDS;
+    program.program += 1;
+    program.texture = 0;
+    program.material = 0;
+    program.mesh = 0;
+    program.depth = 0.f;
+    CHECK(make_render_key(program) > key);
+
+    auto texture = FIELDS;
+    texture.texture += 1;
+    texture.material = 0;
+    texture.mesh = 0;
+    texture.depth = 0.f;
+    CHECK(make_render_key(texture) > key);
+
+    auto material = FIELDS;
+    material.material += 1;
+    material.mesh = 0;
+    material.depth = 0.f;
+    CHECK(make_render_key(material) > key);
+
+    auto mesh = FIELDS;
+    mesh.mesh += 1;
+    mesh.depth = 0.f;
+    CHECK(make_render_key(mesh) > key);
+
+    auto nearer = FIELDS;
+    nearer.depth = 0.25f;
+    CHECK(make_render_key(nearer) < key);
+
+    auto lower = FIELDS;
+    lower.program = 2;
+    lower.texture = 4095;
+    lower.material = 1023;
+    lower.mesh = 65535;
+    lower.depth = 1.f;
+    CHECK(make_render_key(lower) < key);
+}
+
+// Only the depth is left out of the state.
+auto check_render_state() -> void {
+    auto near = FIELDS;
+    near.depth = 0.f;
+    auto far = FIELDS;
+    far.depth = 1.f;
+    CHECK(render_state(make_render_key(near))
+        == render_state(make_render_key(far)));
+
+    auto other_mesh = FIELDS;
+    other_mesh.mesh += 1;
+    CHECK(render_state(make_render_key(other_mesh))
+        != render_state(make_render_key(FIELDS)));
+}
+
+// Out of range depths clamp, out of range fields wrap around their bits.
+auto check_key_limits() -> void {
+    auto behind = FIELDS;
+    behind.depth = -1.f;
+    auto nearest = FIELDS;
+    nearest.depth = 0.f;
+    CHECK(make_render_key(behind) == make_render_key(nearest));
+
+    auto beyond = FIELDS;
+    beyond.depth = 2.f;
+    auto farthest = FIELDS;
+    farthest.depth = 1.f;
+    CHECK(make_render_key(beyond) == make_render_key(farthest));
+
+    auto wrapped = FIELDS;
+    wrapped.texture += 1_u32 << 12;
+    CHECK(make_render_key(wrapped) == make_render_key(FIELDS));
+}
+
+// Against std::stable_sort, on `keys` with their index as payload.
+auto check_sort(std::vector<u64> const& keys) -> void {
+    auto queue = RenderQueue{};
+    queue.keys = keys;
+    for (auto entry = 0_u32; entry < keys.size(); ++entry) {
+        queue.payloads.push_back(entry);
+    }
+
+    auto expected = std::vector<std::pair<u64, u32>>{};
+    for (auto entry = 0_u32; entry < keys.size(); ++entry) {
+        expected.emplace_back(keys[entry], entry);
+    }
+    std::ranges::stable_sort(expected, {}, [](auto const& entry) {
+        return entry.first;
+    });
+
+    sort_render_queue(queue);
+    CHECK(queue.keys.size() == keys.size());
+    CHECK(queue.payloads.size() == keys.size());
+    auto matches = true;
+    for (auto entry = 0_uz; entry < expected.size(); ++entry) {
+        matches = matches
+            and queue.keys[entry] == expected[entry].first
+            and queue.payloads[entry] == expected[entry].second;
+    }
+    CHECK(matches);
+}
+
+auto check_radix_sort() -> void {
+    check_sort({});
+    check_sort({42});
+
+    auto random = std::mt19937_64{1234};
+    auto keys = std::vector<u64>(4096);
+    for (auto& key : keys) {
+        key = random();
+    }
+    check_sort(keys);
+
+    // Few distinct values, so equal keys must keep their order.
+    for (auto& key : keys) {
+        key = random() % 8 << 60 | random() % 4;
+    }
+    check_sort(keys);
+
+    // Only the depth differs, the shared digits are skipped.
+    for (auto& key : keys) {
+        auto fields = FIELDS;
+        fields.depth = static_cast<float>(random() % 1000) / 1000.f;
+        key = make_render_key(fields);
+    }
+    check_sort(keys);
+
+    // Already sorted, and reversed.
+    std::ranges::sort(keys);
+    check_sort(keys);
+    std::ranges::reverse(keys);
+    check_sort(keys);
+}
+
+} // namespace
+
+auto main() -> int {
+    check_key_order();
+    check_render_state();
+    check_key_limits();
+    check_radix_sort();
+    return test::exit_code();
+}
@@ -0,0 +1,189 @@
+#include "engine/render/static_batching.hpp"
+
+#include "check.hpp"
+#include "engine/render/scene.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <tuple>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+// Every coordinate stays a small integer, so transforms are exact.
+auto make_mesh(float const offset) -> Mesh {
+    auto mesh = Mesh{};
+    mesh.vertices = {
+        {offset, 0.f, 0.f}, {offset + 1.f, 0.f, 0.f}, {offset, 1.f, 0.f},
+    };
+    mesh.bounds = bounding_sphere(mesh.vertices);
+    return mesh;
+}
+
+auto translate(glm::vec3 const& xyz) -> Transform {
+    return Translate{StaticTranslate{.xyz = xyz}};
+}
+
+auto spin() -> Transform {
+    return Rotate {
+        .kind = Rotate::Kind::Time,
+        .rotate = {1000.f, 0.f, 1.f, 0.f},
+    };
+}
+
+auto add_group(
+    World& world,
+    u32 const parent,
+    std::vector<Transform> const& transforms,
+    std::vector<Model> const& models
+) -> void {
+    world.group_parents.push_back(parent);
+    world.group_transforms.push_back({
+        .begin = static_cast<u32>(world.transforms.size()),
+        .end = static_cast<u32>(world.transforms.size() + transforms.size()),
+    });
+    world.transforms.insert(
+        world.transforms.end(), transforms.begin(), transforms.end()
+    );
+    world.group_models.push_back({
+        .begin = static_cast<u32>(world.models.size()),
+        .end = static_cast<u32>(world.models.size() + models.size()),
+    });
+    world.models.insert(world.models.end(), models.begin(), models.end());
+}
+
+auto model(u32 const mesh, u32 const texture) -> Model {
+    return {.mesh = mesh, .matrix = NO_MATRIX, .texture = texture};
+}
+
+using Vertex = std::tuple<u32, float, float, float>; // texture first.
+
+// Every vertex drawn, in world space, with time based transforms left
+// out, as batching keeps them the same.
+auto drawn_vertices(World const& world) -> std::vector<Vertex> {
+    auto const num_groups = world.group_parents.size();
+    auto group_matrices = std::vector<glm::mat4>(num_groups);
+    auto vertices = std::vector<Vertex>{};
+    for (auto group = 0_uz; group < num_groups; ++group) {
+        auto const parent = world.group_parents[group];
+        auto matrix = parent == NO_PARENT
+            ? glm::mat4{1.f}
+            : group_matrices[parent];
+        auto const [begin, end] = world.group_transforms[group];
+        for (auto transform = begin; transform < end; ++transform) {
+            if (not is_time_based(world.transforms[transform])) {
+                matrix *= static_transform_matrix(world.transforms[transform]);
+            }
+        }
+        group_matrices[group] = matrix;
+
+        auto const [models_begin, models_end] = world.group_models[group];
+        for (auto index = models_begin; index < models_end; ++index) {
+            auto const& model = world.models[index];
+            auto const model_matrix = model.matrix == NO_MATRIX
+                ? matrix
+                : matrix * world.model_matrices[model.matrix];
+            for (auto const& vertex : world.meshes[model.mesh].vertices) {
+                auto const position = model_matrix * glm::vec4{vertex, 1.f};
+                vertices.emplace_back(
+                    model.texture, position.x, position.y, position.z
+                );
+            }
+        }
+    }
+    std::ranges::sort(vertices);
+    return vertices;
+}
+
+auto num_models(World const& world, u32 const group) -> u32 {
+    return world.group_models[group].end - world.group_models[group].begin;
+}
+
+// A fully static tree is merged into its root, a mesh per texture, except
+// for instanced models, which are only moved into the root's space.
+auto check_static_tree() -> void {
+    auto world = World{};
+    world.meshes = {make_mesh(0.f), make_mesh(2.f)};
+    world.model_matrices = {
+        glm::translate(glm::mat4{1.f}, glm::vec3{0.f, 0.f, 3.f}),
+    };
+    add_group(
+        world,
+        NO_PARENT,
+        {translate({10.f, 0.f, 0.f})},
+        {model(0, 0), model(1, 0), model(0, 1)}
+    );
+    add_group(
+        world,
+        0,
+        {translate({0.f, 5.f, 0.f})},
+        {model(1, 0), {.mesh = 0, .matrix = 0, .texture = 0}}
+    );
+    auto const before = drawn_vertices(world);
+
+    batch_static_models(world);
+    CHECK(drawn_vertices(world) == before);
+    // The instanced model, and a merged one per texture.
+    CHECK(num_models(world, 0) == 3);
+    CHECK(num_models(world, 1) == 0);
+    CHECK(world.model_matrices.size() == 1);
+    // Mesh 1 was only used by merged models.
+    CHECK(world.meshes.size() == 3);
+}
+
+// Time based transforms split the tree: their ancestors only merge their
+// own models, and everything moving with them is left apart.
+auto check_dynamic_tree() -> void {
+    auto world = World{};
+    world.meshes = {make_mesh(0.f), make_mesh(2.f)};
+    add_group(
+        world,
+        NO_PARENT,
+        {translate({1.f, 0.f, 0.f})},
+        {model(0, NO_TEXTURE), model(1, NO_TEXTURE)}
+    );
+    add_group(
+        world,
+        0,
+        {spin(), translate({0.f, 2.f, 0.f})},
+        {model(0, NO_TEXTURE), model(1, NO_TEXTURE)}
+    );
+    add_group(
+        world,
+        1,
+        {translate({0.f, 0.f, 4.f})},
+        {model(0, NO_TEXTURE), model(1, NO_TEXTURE)}
+    );
+    add_group(world, 1, {}, {model(1, NO_TEXTURE)});
+    auto const before = drawn_vertices(world);
+
+    batch_static_models(world);
+    CHECK(drawn_vertices(world) == before);
+    CHECK(num_models(world, 0) == 1);
+    CHECK(num_models(world, 1) == 2);
+    CHECK(num_models(world, 2) == 2);
+    CHECK(num_models(world, 3) == 1);
+
+    // A lone static model has nothing to merge with.
+    auto lone = World{};
+    lone.meshes = {make_mesh(0.f)};
+    add_group(lone, NO_PARENT, {}, {model(0, NO_TEXTURE)});
+    add_group(lone, 0, {spin()}, {model(0, NO_TEXTURE)});
+    batch_static_models(lone);
+    CHECK(num_models(lone, 0) == 1);
+    CHECK(lone.models[0].mesh == 0);
+    CHECK(lone.meshes.size() == 1);
+}
+
+} // namespace
+
+auto main() -> int {
+    check_static_tree();
+    check_dynamic_tree();
+    return test::exit_code();
+}
@@ -0,0 +1,251 @@
+#include "engine/render/texture_cache.hpp"
+
+#include "check.hpp"
+#include "engine/config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <brief_int.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+using Color = std::array<int, 3>;
+
+// RGBA8 levels of `width` by `height` texels and halving down to 1x1.
+auto make_texture(u32 width, u32 height, auto const& color) -> TextureData {
+    auto data = TextureData {
+        .format = TexelFormat::RGBA8,
+        .levels = {},
+        .pixels = {},
+        .mapping = {},
+    };
+    while (true) {
+        data.levels.push_back({
+            .width = width,
+            .height = height,
+            .offset = data.pixels.size(),
+            .size = 4_uz * width * height,
+        });
+        for (auto y = 0_u32; y < height; ++y) {
+            for (auto x = 0_u32; x < width; ++x) {
+                auto const [r, g, b, a] = color(x, y, width, height);
+                for (auto const channel : {r, g, b, a}) {
+                    data.pixels.push_back(static_cast<std::byte>(channel));
+                }
+            }
+        }
+        if (width == 1 and height == 1) {
+            return data;
+        }
+        width = std::max(width / 2, 1_u32);
+        height = std::max(height / 2, 1_u32);
+    }
+}
+
+// Diagonal, along a single line of colors as BC1 blocks can hold.
+auto gradient(u32 const x, u32 const y, u32 const width, u32 const height)
+    -> std::array<int, 4>
+{
+    auto const t = static_cast<int>(x + y);
+    auto const steps = static_cast<int>(width + height);
+    return {255 * t / steps, 128 * t / steps + 64, 96, 255};
+}
+
+auto from_rgb565(u16 const packed) -> Color {
+    auto const r = packed >> 11 & 31;
+    auto const g = packed >> 5 & 63;
+    auto const b = packed & 31;
+    return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+}
+
+// Texel `x`, `y` of a BC1 level, as a GPU decodes it.
+auto decode_bc1(
+    std::span<std::byte const> const level,
+    u32 const width,
+    u32 const x,
+    u32 const y
+) -> Color {
+    auto const blocks_x = (width + 3) / 4;
+    auto const* const block
+        = level.data() + 8 * ((y / 4) * blocks_x + x / 4);
+    auto color0 = u16{};
+    auto color1 = u16{};
+    auto indices = u32{};
+    std::memcpy(&color0, block, sizeof(color0));
+    std::memcpy(&color1, block + 2, sizeof(color1));
+    std::memcpy(&indices, block + 4, sizeof(indices));
+
+    auto const c0 = from_rgb565(color0);
+    auto const c1 = from_rgb565(color1);
+    auto palette = std::array<Color, 4>{c0, c1, Color{}, Color{}};
+    for (auto channel = 0_uz; channel < 3; ++channel) {
+        if (color0 > color1) {
+            palette[2][channel] = (2 * c0[channel] + c1[channel]) / 3;
+            palette[3][channel] = (c0[channel] + 2 * c1[channel]) / 3;
+        } else {
+            palette[2][channel] = (c0[channel] + c1[channel]) / 2;
+        }
+    }
+    return palette[indices >> (2 * (y % 4 * 4 + x % 4)) & 3];
+}
+
+// The largest difference in any channel of any texel of any level.
+auto max_bc1_error(TextureData const& original, TextureData const& encoded)
+    -> int
+{
+    auto error = 0;
+    for (auto index = 0_uz; index < original.levels.size(); ++index) {
+        auto const& level = original.levels[index];
+        auto const& bc1_level = encoded.levels[index];
+        auto const bc1 = encoded.bytes().subspan(
+            bc1_level.offset, bc1_level.size
+        );
+        for (auto y = 0_u32; y < level.height; ++y) {
+            for (auto x = 0_u32; x < level.width; ++x) {
+                auto const* const rgba = original.bytes().data()
+                    + level.offset
+                    + 4 * (static_cast<usize>(y) * level.width + x);
+                auto const decoded = decode_bc1(bc1, level.width, x, y);
+                for (auto channel = 0_uz; channel < 3; ++channel) {
+                    error = std::max(
+                        error,
+                        std::abs(static_cast<int>(rgba[channel])
+                            - decoded[channel])
+                    );
+                }
+            }
+        }
+    }
+    return error;
+}
+
+auto check_bc1() -> void {
+    // Not a multiple of the block size, so edge blocks are partial.
+    auto const original = make_texture(18, 10, gradient);
+    auto encoded = make_texture(18, 10, gradient);
+    CHECK(compress_bc1(encoded));
+    CHECK(encoded.format == TexelFormat::BC1);
+    CHECK(encoded.levels.size() == original.levels.size());
+    CHECK(encoded.levels[0].size == 8_uz * 5 * 3);
+    CHECK(encoded.levels.back().size == 8);
+    auto contiguous = true;
+    auto end = 0_uz;
+    for (auto const& level : encoded.levels) {
+        contiguous = contiguous and level.offset == end;
+        end += level.size;
+    }
+    CHECK(contiguous);
+    CHECK(end == encoded.bytes().size());
+    // A smooth gradient stays within about half a step of the 4 colors of
+    // each block, steepest on the smallest levels.
+    CHECK(max_bc1_error(original, encoded) <= 32);
+
+    // A flat color only loses what RGB565 can't hold.
+    auto const magenta = [](u32, u32, u32, u32) {
+        return std::array{255, 0, 255, 255};
+    };
+    auto const flat = make_texture(8, 8, magenta);
+    auto flat_encoded = make_texture(8, 8, magenta);
+    CHECK(compress_bc1(flat_encoded));
+    CHECK(max_bc1_error(flat, flat_encoded) == 0);
+
+    // Anything translucent is left alone.
+    auto translucent = make_texture(8, 8, [](u32 x, u32, u32, u32) {
+        return std::array{255, 255, 255, x == 3 ? 128 : 255};
+    });
+    auto const pixels = translucent.pixels;
+    CHECK(not compress_bc1(translucent));
+    CHECK(translucent.format == TexelFormat::RGBA8);
+    CHECK(translucent.pixels == pixels);
+}
+
+auto same_bytes(
+    std::span<std::byte const> const a,
+    std::span<std::byte const> const b
+) -> bool {
+    return std::ranges::equal(a, b);
+}
+
+// Levels and texels come back the same, mapped from the file.
+auto check_round_trip(TextureData const& data, u64 const key) -> void {
+    write_cached_texture(key, data);
+    auto const cached = read_cached_texture(key);
+    CHECK(cached.has_value());
+    if (not cached.has_value()) {
+        return;
+    }
+    CHECK(cached->format == data.format);
+    CHECK(cached->pixels.empty());
+    CHECK(cached->levels.size() == data.levels.size());
+    auto matches = cached->levels.size() == data.levels.size();
+    for (auto index = 0_uz; matches and index < data.levels.size(); ++index) {
+        auto const& level = data.levels[index];
+        auto const& cached_level = cached->levels[index];
+        auto const cached_bytes = cached->bytes().subspan(
+            cached_level.offset, cached_level.size
+        );
+        matches = cached_level.width == level.width
+            and cached_level.height == level.height
+            and same_bytes(
+                cached_bytes, data.bytes().subspan(level.offset, level.size)
+            );
+    }
+    CHECK(matches);
+}
+
+auto check_cache() -> void {
+    auto const rgba = make_texture(18, 10, gradient);
+    auto const rgba_key = texture_cache_key(
+        std::span{"rgba source"}, false
+    );
+    check_round_trip(rgba, rgba_key);
+
+    auto bc1 = make_texture(18, 10, gradient);
+    CHECK(compress_bc1(bc1));
+    auto const bc1_key = texture_cache_key(std::span{"rgba source"}, true);
+    CHECK(bc1_key != rgba_key);
+    check_round_trip(bc1, bc1_key);
+
+    // Nothing under another key.
+    CHECK(not read_cached_texture(bc1_key + 1).has_value());
+
+    // Nor in a truncated file.
+    auto const dir = std::filesystem::path{
+        engine::render::config::TEXTURE_CACHE_DIR
+    };
+    for (auto const& entry : std::filesystem::directory_iterator{dir}) {
+        std::filesystem::resize_file(
+            entry.path(), std::filesystem::file_size(entry.path()) - 1
+        );
+    }
+    CHECK(not read_cached_texture(rgba_key).has_value());
+    CHECK(not read_cached_texture(bc1_key).has_value());
+}
+
+} // namespace
+
+auto main() -> int {
+    // The cache lives in the working directory.
+    auto const dir = std::filesystem::temp_directory_path()
+        / "texture_cache_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::filesystem::current_path(dir);
+
+    check_bc1();
+    check_cache();
+
+    std::filesystem::current_path(dir.parent_path());
+    std::filesystem::remove_all(dir);
+    return test::exit_code();
+}
@@ -0,0 +1,210 @@
+#include "engine/render/vertex_format.hpp"
+
+#include "check.hpp"
+#include "engine/config.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/packing.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec4.hpp>
+#include <iterator>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+using namespace engine::render;
+
+namespace {
+
+// Slack for float rounding on top of the reported errors.
+auto constexpr EPSILON = 1e-5f;
+
+// A sphere of radius 3 away from the origin, with texcoords past [0, 1].
+auto make_world() -> World {
+    auto mesh = Mesh{};
+    auto constexpr STACKS = 24_u32;
+    auto constexpr SLICES = 48_u32;
+    auto constexpr PI = 3.14159265f;
+    for (auto stack = 0_u32; stack <= STACKS; ++stack) {
+        for (auto slice = 0_u32; slice < SLICES; ++slice) {
+            auto const u = static_cast<float>(slice) / SLICES;
+            auto const v = static_cast<float>(stack) / STACKS;
+            auto const theta = 2.f * PI * u;
+            auto const phi = PI * v;
+            auto const normal = glm::vec3 {
+                std::sin(phi) * std::cos(theta),
+                std::cos(phi),
+                std::sin(phi) * std::sin(theta),
+            };
+            mesh.vertices.push_back(glm::vec3{10.f, -4.f, 2.f} + 3.f * normal);
+            mesh.normals.push_back(normal);
+            mesh.texcoords.push_back({3.f * u - 1.f, 2.f * v});
+        }
+    }
+    mesh.bounds = {.center = {10.f, -4.f, 2.f}, .radius = 3.f};
+
+    auto world = World{};
+    world.meshes.push_back(std::move(mesh));
+    return world;
+}
+
+template <typename T>
+auto read(std::byte const* const src) -> T {
+    auto value = T{};
+    std::memcpy(&value, src, sizeof(T));
+    return value;
+}
+
+// What the vertex shader reads back from a packed vertex.
+auto decode_position(
+    VertexLayout const& layout,
+    Sphere const& bounds,
+    std::byte const* const vertex
+) -> glm::vec3 {
+    auto relative = glm::vec3{};
+    switch (layout.position_format) {
+        case PositionFormat::FLOAT:
+            relative = read<glm::vec3>(vertex);
+            break;
+        case PositionFormat::HALF:
+            relative = {
+                glm::unpackHalf1x16(read<u16>(vertex)),
+                glm::unpackHalf1x16(read<u16>(vertex + sizeof(u16))),
+                glm::unpackHalf1x16(read<u16>(vertex + 2 * sizeof(u16))),
+            };
+            break;
+    }
+    return glm::vec3{dequantization_matrix(bounds) * glm::vec4{relative, 1.f}};
+}
+
+auto decode_normal(VertexLayout const& layout, std::byte const* const vertex)
+    -> glm::vec3
+{
+    auto const packed = read<u32>(vertex + layout.normal_offset);
+    if (layout.normal_format == NormalFormat::INT_2_10_10_10) {
+        return glm::normalize(glm::vec3{glm::unpackSnorm3x10_1x2(packed)});
+    }
+    auto const encoded = glm::unpackSnorm2x16(packed);
+    auto normal = glm::vec3 {
+        encoded.x,
+        encoded.y,
+        1.f - std::abs(encoded.x) - std::abs(encoded.y),
+    };
+    auto const fold = std::max(-normal.z, 0.f);
+    normal.x += normal.x >= 0.f ? -fold : fold;
+    normal.y += normal.y >= 0.f ? -fold : fold;
+    return glm::normalize(normal);
+}
+
+auto decode_texcoord(VertexLayout const& layout, std::byte const* const vertex)
+    -> glm::vec2
+{
+    auto const* const src = vertex + layout.texcoord_offset;
+    if (layout.texcoord_format == TexcoordFormat::FLOAT) {
+        return read<glm::vec2>(src);
+    }
+    return glm::unpackUnorm2x16(read<u32>(src)) * layout.texcoord_scale
+        + layout.texcoord_min;
+}
+
+// Every attribute survives packing within the errors the layout reports,
+// which stay within the configured tolerances.
+auto check_round_trip(
+    World const& world,
+    PositionFormat const position_format,
+    NormalFormat const normal_format,
+    TexcoordFormat const texcoord_format
+) -> void {
+    namespace config = engine::render::config;
+
+    auto const layout = choose_vertex_layout(
+        world, position_format, normal_format, texcoord_format
+    );
+    auto const errors = quantization_errors(world, layout);
+    CHECK(errors.position <= config::VERTEX_MAX_POSITION_ERROR);
+    CHECK(errors.normal <= config::VERTEX_MAX_NORMAL_ERROR);
+    CHECK(errors.texcoord <= config::VERTEX_MAX_TEXCOORD_ERROR);
+
+    auto const& mesh = world.meshes.front();
+    auto packed = std::vector<std::byte>{};
+    pack_vertices(mesh, layout, packed);
+    CHECK(packed.size() == layout.stride * mesh.vertices.size());
+
+    auto position_error = 0.f;
+    auto normal_error = 0.f;
+    auto texcoord_error = 0.f;
+    for (auto vertex = 0_uz; vertex < mesh.vertices.size(); ++vertex) {
+        auto const* const src = packed.data() + layout.stride * vertex;
+
+        auto const position = decode_position(layout, mesh.bounds, src);
+        position_error = std::max(
+            position_error,
+            glm::distance(position, mesh.vertices[vertex]) / mesh.bounds.radius
+        );
+
+        auto const cos_angle = std::clamp(
+            glm::dot(decode_normal(layout, src), mesh.normals[vertex]),
+            -1.f,
+            1.f
+        );
+        normal_error = std::max(
+            normal_error, glm::degrees(std::acos(cos_angle))
+        );
+
+        auto const diff
+            = glm::abs(decode_texcoord(layout, src) - mesh.texcoords[vertex]);
+        texcoord_error = std::max({texcoord_error, diff.x, diff.y});
+    }
+    CHECK(position_error <= errors.position + EPSILON);
+    CHECK(normal_error <= errors.normal + EPSILON);
+    CHECK(texcoord_error <= errors.texcoord + EPSILON);
+}
+
+// Packing the same mesh twice only appends.
+auto check_append(World const& world) -> void {
+    auto const layout = choose_vertex_layout(
+        world,
+        PositionFormat::HALF,
+        NormalFormat::OCTAHEDRAL,
+        TexcoordFormat::UNORM16
+    );
+    auto const& mesh = world.meshes.front();
+    auto once = std::vector<std::byte>{};
+    pack_vertices(mesh, layout, once);
+    auto twice = once;
+    pack_vertices(mesh, layout, twice);
+    CHECK(twice.size() == 2 * once.size());
+    CHECK(std::equal(
+        once.begin(), once.end(), twice.begin() + std::ssize(once)
+    ));
+}
+
+} // namespace
+
+auto main() -> int {
+    auto const world = make_world();
+    for (auto const position_format
+        : {PositionFormat::FLOAT, PositionFormat::HALF}
+    ) {
+        for (auto const normal_format
+            : {NormalFormat::INT_2_10_10_10, NormalFormat::OCTAHEDRAL}
+        ) {
+            for (auto const texcoord_format
+                : {TexcoordFormat::FLOAT, TexcoordFormat::UNORM16}
+            ) {
+                check_round_trip(
+                    world, position_format, normal_format, texcoord_format
+                );
+            }
+        }
+    }
+    check_append(world);
+    return test::exit_code();
+}
@@ -0,0 +1,65 @@
+#include "util/cache_file.hpp"
+
+#include "check.hpp"
+#include "util/mapped_file.hpp"
+
+#include <array>
+#include <brief_int.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+auto main() -> int {
+    auto const dir = std::filesystem::temp_directory_path()
+        / "cache_file_test";
+    std::filesystem::remove_all(dir);
+    // Its directory is created along the way.
+    auto const path = dir / "nested" / "entry.bin";
+
+    auto const header = util::CacheHeader {
+        .magic = 0x54534554,
+        .version = 3,
+        .key = 0x0123456789abcdef,
+    };
+    auto constexpr PAYLOAD = std::array<std::byte, 3> {
+        std::byte{1}, std::byte{2}, std::byte{3}
+    };
+    auto const chunks = std::array {
+        std::as_bytes(std::span{&header, 1}),
+        std::span<std::byte const>{},
+        std::span<std::byte const>{PAYLOAD},
+    };
+    CHECK(util::write_file_atomically(path, chunks));
+
+    auto const mapping = util::MappedFile::open(path.string());
+    CHECK(mapping.has_value());
+    if (mapping.has_value()) {
+        auto const bytes = mapping->bytes();
+        CHECK(bytes.size() == sizeof(header) + PAYLOAD.size());
+        CHECK(util::matches_cache_header(bytes, header));
+        CHECK(bytes.back() == std::byte{3});
+
+        auto other_key = header;
+        other_key.key += 1;
+        CHECK(not util::matches_cache_header(bytes, other_key));
+        auto other_version = header;
+        other_version.version += 1;
+        CHECK(not util::matches_cache_header(bytes, other_version));
+        CHECK(not util::matches_cache_header(bytes.first(8), header));
+    }
+
+    // Nothing but the file itself is left behind.
+    auto entries = 0_uz;
+    for ([[maybe_unused]] auto const& entry
+        : std::filesystem::directory_iterator{path.parent_path()}
+    ) {
+        entries += 1;
+    }
+    CHECK(entries == 1);
+
+    std::filesystem::remove_all(dir);
+    return test::exit_code();
+}
@@ -0,0 +1,46 @@
+#include "util/downsample.hpp"
+
+#include "check.hpp"
+
+#include <algorithm>
+#include <brief_int.hpp>
+#include <utility>
+#include <vector>
+
+using namespace brief_int;
+using namespace brief_int::literals;
+
+namespace {
+
+// Every texel of the finer level lands under exactly one coarser texel.
+auto check_cover(u32 const fine) -> void {
+    auto const coarse = std::max(fine / 2, 1_u32);
+    auto hits = std::vector<u32>(fine);
+    for (auto index = 0_u32; index < coarse; ++index) {
+        auto const [begin, end]
+            = util::downsample_footprint(index, coarse, fine);
+        CHECK(begin < end);
+        CHECK(end - begin <= 3);
+        for (auto texel = begin; texel < end; ++texel) {
+            hits[texel] += 1;
+        }
+    }
+    CHECK(std::ranges::all_of(hits, [](u32 const hit) { return hit == 1; }));
+}
+
+} // namespace
+
+auto main() -> int {
+    for (auto fine = 1_u32; fine <= 64; ++fine) {
+        check_cover(fine);
+    }
+    // Two texels, then three for the last one of an odd sized level.
+    auto const even = util::downsample_footprint(1, 2, 4);
+    CHECK(even.first == 2 and even.second == 4);
+    auto const odd = util::downsample_footprint(1, 2, 5);
+    CHECK(odd.first == 2 and odd.second == 5);
+    // A single texel covers itself.
+    auto const single = util::downsample_footprint(0, 1, 1);
+    CHECK(single.first == 0 and single.second == 1);
+    return test::exit_code();
+}